@@ -0,0 +1,109 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "BenchAllocations.h"
+
+#if defined(VISIONARY_ENABLE_ALLOCATION_TRACKING)
+
+#include "AllocationTracker.h"
+
+namespace visionary {
+namespace bench {
+
+std::uint64_t getAllocationCount()
+{
+  return AllocationTracker::getAllocationCount();
+}
+
+std::uint64_t getAllocatedBytes()
+{
+  return AllocationTracker::getAllocatedBytes();
+}
+
+} // namespace bench
+} // namespace visionary
+
+#else
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<std::uint64_t> g_allocationCount(0u);
+std::atomic<std::uint64_t> g_allocatedBytes(0u);
+
+void* allocate(std::size_t size)
+{
+  g_allocationCount.fetch_add(1u, std::memory_order_relaxed);
+  g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+  return std::malloc((size == 0u) ? 1u : size);
+}
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+  void* p = allocate(size);
+  if (p == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void* operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+  return allocate(size);
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+  std::free(p);
+}
+
+namespace visionary {
+namespace bench {
+
+std::uint64_t getAllocationCount()
+{
+  return g_allocationCount.load(std::memory_order_relaxed);
+}
+
+std::uint64_t getAllocatedBytes()
+{
+  return g_allocatedBytes.load(std::memory_order_relaxed);
+}
+
+} // namespace bench
+} // namespace visionary
+
+#endif
@@ -0,0 +1,24 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstdint>
+
+namespace visionary {
+namespace bench {
+
+// Heap allocations of the whole process, counted by the replacement operator new in BenchAllocations.cpp. Only
+// benchmarks linking BenchAllocations.cpp count; the counters are shared by all threads. In builds with the
+// allocation tracking of the sample helpers (AllocationTracker.h) its operator new is used instead.
+
+/// Number of operator new calls since program start
+std::uint64_t getAllocationCount();
+
+/// Bytes requested by operator new since program start
+std::uint64_t getAllocatedBytes();
+
+} // namespace bench
+} // namespace visionary
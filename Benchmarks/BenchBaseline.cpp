@@ -0,0 +1,261 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "BenchBaseline.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+namespace visionary {
+namespace bench {
+
+namespace {
+
+const char   kAllocationSuffix[]  = "allocs_per_op";
+const double kAllocationTolerance = 0.5; // allocations per operation
+
+bool isAllocationMetric(const std::string& metric)
+{
+  const std::string suffix(kAllocationSuffix);
+  return (metric.size() >= suffix.size())
+         && (metric.compare(metric.size() - suffix.size(), suffix.size(), suffix) == 0);
+}
+
+/// Minimal reader for the JSON written by writeBaseline()
+class JsonReader
+{
+public:
+  explicit JsonReader(const std::string& text) : m_text(text), m_pos(0u)
+  {
+  }
+
+  /// Consumes c if it is the next character after white space
+  bool expect(char c)
+  {
+    skipSpace();
+    if ((m_pos < m_text.size()) && (m_text[m_pos] == c))
+    {
+      ++m_pos;
+      return true;
+    }
+    return false;
+  }
+
+  bool readString(std::string& value)
+  {
+    if (!expect('"'))
+    {
+      return false;
+    }
+    value.clear();
+    while (m_pos < m_text.size())
+    {
+      char c = m_text[m_pos++];
+      if (c == '"')
+      {
+        return true;
+      }
+      if ((c == '\\') && (m_pos < m_text.size()))
+      {
+        c = m_text[m_pos++];
+      }
+      value += c;
+    }
+    return false;
+  }
+
+  /// Reads a number or null (as NaN)
+  bool readNumber(double& value)
+  {
+    skipSpace();
+    if (m_text.compare(m_pos, 4u, "null") == 0)
+    {
+      m_pos += 4u;
+      value = std::numeric_limits<double>::quiet_NaN();
+      return true;
+    }
+    const char* pBegin = m_text.c_str() + m_pos;
+    char*       pEnd   = nullptr;
+    value              = std::strtod(pBegin, &pEnd);
+    if (pEnd == pBegin)
+    {
+      return false;
+    }
+    m_pos += static_cast<std::size_t>(pEnd - pBegin);
+    return true;
+  }
+
+private:
+  void skipSpace()
+  {
+    while ((m_pos < m_text.size()) && (std::isspace(static_cast<unsigned char>(m_text[m_pos])) != 0))
+    {
+      ++m_pos;
+    }
+  }
+
+  const std::string& m_text;
+  std::size_t        m_pos;
+};
+
+bool readMetrics(JsonReader& reader, std::map<std::string, double>& metrics)
+{
+  if (!reader.expect('{'))
+  {
+    return false;
+  }
+  if (reader.expect('}'))
+  {
+    return true;
+  }
+  do
+  {
+    std::string name;
+    double      value = 0.;
+    if (!reader.readString(name) || !reader.expect(':') || !reader.readNumber(value))
+    {
+      return false;
+    }
+    metrics[name] = value;
+  } while (reader.expect(','));
+  return reader.expect('}');
+}
+
+bool readCases(JsonReader& reader, BenchMetrics& metrics)
+{
+  if (!reader.expect('{'))
+  {
+    return false;
+  }
+  if (reader.expect('}'))
+  {
+    return true;
+  }
+  do
+  {
+    std::string name;
+    if (!reader.readString(name) || !reader.expect(':') || !readMetrics(reader, metrics[name]))
+    {
+      return false;
+    }
+  } while (reader.expect(','));
+  return reader.expect('}');
+}
+
+std::string escapeJson(const std::string& text)
+{
+  std::string escaped;
+  for (const char c : text)
+  {
+    if ((c == '"') || (c == '\\'))
+    {
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped;
+}
+
+} // namespace
+
+bool writeBaseline(const std::string& filename, const BenchMetrics& metrics)
+{
+  std::FILE* pFile = std::fopen(filename.c_str(), "w");
+  if (pFile == nullptr)
+  {
+    return false;
+  }
+  std::fprintf(pFile, "{\n  \"cases\": {");
+  const char* caseSeparator = "\n";
+  for (const auto& benchCase : metrics)
+  {
+    std::fprintf(pFile, "%s    \"%s\": {", caseSeparator, escapeJson(benchCase.first).c_str());
+    const char* metricSeparator = "";
+    for (const auto& metric : benchCase.second)
+    {
+      if (std::isnan(metric.second))
+      {
+        std::fprintf(pFile, "%s\"%s\": null", metricSeparator, escapeJson(metric.first).c_str());
+      }
+      else
+      {
+        std::fprintf(pFile, "%s\"%s\": %.6g", metricSeparator, escapeJson(metric.first).c_str(), metric.second);
+      }
+      metricSeparator = ", ";
+    }
+    std::fprintf(pFile, "}");
+    caseSeparator = ",\n";
+  }
+  std::fprintf(pFile, "\n  }\n}\n");
+  return std::fclose(pFile) == 0;
+}
+
+bool readBaseline(const std::string& filename, BenchMetrics& metrics)
+{
+  std::ifstream file(filename.c_str());
+  if (!file)
+  {
+    return false;
+  }
+  const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+  JsonReader  reader(text);
+  std::string key;
+  metrics.clear();
+  return reader.expect('{') && reader.readString(key) && (key == "cases") && reader.expect(':')
+         && readCases(reader, metrics) && reader.expect('}');
+}
+
+std::size_t compareWithBaseline(const BenchMetrics& baseline,
+                                const BenchMetrics& current,
+                                double              tolerance,
+                                bool                allocationsOnly)
+{
+  std::size_t failures = 0u;
+  for (const auto& benchCase : current)
+  {
+    const BenchMetrics::const_iterator itBaseline = baseline.find(benchCase.first);
+    for (const auto& metric : benchCase.second)
+    {
+      const bool isAllocation = isAllocationMetric(metric.first);
+      if (allocationsOnly && !isAllocation)
+      {
+        continue;
+      }
+      if ((itBaseline == baseline.end()) || (itBaseline->second.count(metric.first) == 0u))
+      {
+        std::printf("%-28s %-16s MISSING in the baseline\n", benchCase.first.c_str(), metric.first.c_str());
+        ++failures;
+        continue;
+      }
+      const double baselineValue = itBaseline->second.at(metric.first);
+      if (std::isnan(baselineValue))
+      {
+        std::printf("%-28s %-16s not compared (null in the baseline)\n", benchCase.first.c_str(), metric.first.c_str());
+        continue;
+      }
+      const double limit = isAllocation ? (baselineValue + kAllocationTolerance) : (baselineValue * (1. + tolerance));
+      if (metric.second > limit)
+      {
+        std::printf("%-28s %-16s REGRESSION %.6g > %.6g (baseline %.6g)\n",
+                    benchCase.first.c_str(),
+                    metric.first.c_str(),
+                    metric.second,
+                    limit,
+                    baselineValue);
+        ++failures;
+      }
+    }
+  }
+  return failures;
+}
+
+} // namespace bench
+} // namespace visionary
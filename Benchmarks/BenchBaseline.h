@@ -0,0 +1,56 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+namespace visionary {
+namespace bench {
+
+/// Tracked metrics of benchmark cases: case name -> metric name -> value
+///
+/// Metric names ending in "allocs_per_op" are allocation counts, all others are times (lower is better). A baseline
+/// value of NaN (null in the file) explicitly excludes the metric from the comparison, e.g. while it is not recorded.
+typedef std::map<std::string, std::map<std::string, double>> BenchMetrics;
+
+/// Writes the metrics as JSON: {"cases": {"<case>": {"<metric>": <value or null>, ...}, ...}}
+///
+/// \retval true  the file was written
+/// \retval false the file could not be written
+bool writeBaseline(const std::string& filename, const BenchMetrics& metrics);
+
+/// Reads a file written by writeBaseline()
+///
+/// Only the subset of JSON written by writeBaseline() is understood (objects, strings without escapes other than
+/// \" and \\, numbers and null).
+///
+/// \retval true  the file was read
+/// \retval false the file could not be opened or has an unexpected format
+bool readBaseline(const std::string& filename, BenchMetrics& metrics);
+
+/// Compares measured metrics with a baseline and prints every metric which regressed
+///
+/// A time regresses when it exceeds the baseline by more than the relative tolerance. An allocation count regresses
+/// when it exceeds the baseline by more than half an allocation per operation. A compared case or metric missing in
+/// the baseline fails as well, so a gate can't pass by not knowing the values; metrics excluded with null are
+/// reported only.
+///
+/// \param[in] baseline        recorded metrics
+/// \param[in] current         measured metrics
+/// \param[in] tolerance       allowed relative increase of times, e.g. 0.3 for 30%
+/// \param[in] allocationsOnly compare only the allocation counts (times depend on the machine the baseline was
+///                            recorded on)
+///
+/// \return number of regressed or missing metrics
+std::size_t compareWithBaseline(const BenchMetrics& baseline,
+                                const BenchMetrics& current,
+                                double              tolerance,
+                                bool                allocationsOnly);
+
+} // namespace bench
+} // namespace visionary
@@ -0,0 +1,265 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+// Brings up a fleet of simulated Visionary-T Mini devices with FleetBringUp, once serially (one worker) and once
+// with a worker pool, and reports the wall time and the per-phase timings.
+// Every simulated device listens on its own loopback address (127.0.0.10, 127.0.0.11, ...) on the default ports,
+// since VisionaryControl always connects to the default control port.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BenchUtils.h"
+#include "CoLaParameterWriter.h"
+#include "FleetBringUp.h"
+#include "SimBlobServer.h"
+#include "SimControlServer.h"
+#include "VisionaryControl.h"
+#include "VisionaryDataStream.h"
+#include "VisionaryTMiniData.h"
+
+namespace {
+
+using namespace visionary;
+
+/// Control channel and data stream of one simulated device
+struct SimulatedDevice
+{
+  SimControlServer control{VisionaryControl::ProtocolType::COLA_2};
+  SimBlobServer    blob;
+};
+
+std::unique_ptr<SimulatedDevice> startDevice(const std::string& address, std::chrono::microseconds responseDelay)
+{
+  std::unique_ptr<SimulatedDevice> pDevice(new SimulatedDevice);
+  pDevice->control.setVariable("DeviceIdent",
+                               SimControlServer::parametersOf(CoLaParameterWriter(CoLaCommandType::READ_VARIABLE, "x")
+                                                                .parameterFlexString("Visionary-T Mini CX (simulated)")
+                                                                .parameterFlexString("0.0.0")
+                                                                .build()));
+  pDevice->control.setVariable("frontendMode", std::vector<std::uint8_t>(1u, 0u));
+  pDevice->control.setVariable("DIO1Fnc", std::vector<std::uint8_t>(1u, 0u));
+  pDevice->control.setVariable("DIO2Fnc", std::vector<std::uint8_t>(1u, 0u));
+  for (const char* method : {"PLAYSTART", "PLAYSTOP", "PLAYNEXT"})
+  {
+    pDevice->control.setMethod(method, [](const std::vector<std::uint8_t>&, std::vector<std::uint8_t>& result) {
+      result.clear();
+      return true;
+    });
+  }
+  pDevice->control.setResponseDelay(responseDelay);
+  if (!pDevice->control.start(address) || !pDevice->blob.start(address))
+  {
+    return nullptr;
+  }
+  return pDevice;
+}
+
+bool configure(VisionaryControl& control, const std::string&)
+{
+  // the configuration of SampleVisionaryTMiniFrameGrabber's trigger part: one write per variable
+  bool ok = true;
+  for (const char* name : {"frontendMode", "DIO1Fnc", "DIO2Fnc"})
+  {
+    CoLaCommand response =
+      control.sendCommand(CoLaParameterWriter(CoLaCommandType::WRITE_VARIABLE, name).parameterUSInt(1u).build());
+    ok = (response.getError() == CoLaError::OK) && ok;
+  }
+  return ok;
+}
+
+void report(const char* name, const std::vector<FleetBringUp::DeviceReport>& reports, std::chrono::microseconds wall)
+{
+  std::vector<double> completionMs;
+  double              sumMs    = 0.;
+  unsigned            failures = 0u;
+  for (const FleetBringUp::DeviceReport& device : reports)
+  {
+    double deviceMs = 0.;
+    for (const std::chrono::microseconds phaseTime : device.phaseTimes)
+    {
+      deviceMs += static_cast<double>(phaseTime.count()) / 1000.;
+    }
+    sumMs += deviceMs;
+    completionMs.push_back(static_cast<double>(device.completionTime.count()) / 1000.);
+    if (!device.success)
+    {
+      ++failures;
+      std::printf("  %s failed in phase %s\n",
+                  device.hostname.c_str(),
+                  FleetBringUp::getPhaseName(device.failedPhase));
+    }
+  }
+
+  std::printf("%s: wall time %.1f ms, sum of device times %.1f ms, %u of %zu failed\n",
+              name,
+              static_cast<double>(wall.count()) / 1000.,
+              sumMs,
+              failures,
+              reports.size());
+  bench::printSummary("  device ready after", bench::summarize(completionMs), "ms");
+  for (std::size_t phase = 0u; phase < FleetBringUp::kNumPhases; ++phase)
+  {
+    std::vector<double> phaseMs;
+    for (const FleetBringUp::DeviceReport& device : reports)
+    {
+      phaseMs.push_back(static_cast<double>(device.phaseTimes[phase].count()) / 1000.);
+    }
+    const std::string label = std::string("  ") + FleetBringUp::getPhaseName(static_cast<FleetBringUp::Phase>(phase));
+    bench::printSummary(label.c_str(), bench::summarize(phaseMs), "ms");
+  }
+}
+
+std::vector<FleetBringUp::DeviceReport> runBringUp(const std::vector<FleetBringUp::Device>& devices,
+                                                   std::size_t                              maxWorkers,
+                                                   std::chrono::microseconds&               wall)
+{
+  std::mutex                                        streamsMutex;
+  std::vector<std::unique_ptr<VisionaryDataStream>> streams;
+
+  FleetBringUp::Options options;
+  options.maxWorkers = maxWorkers;
+  options.configure  = configure;
+  options.openStream = [&](const std::string& hostname) {
+    std::unique_ptr<VisionaryDataStream> pStream(new VisionaryDataStream(std::make_shared<VisionaryTMiniData>()));
+    if (!pStream->open(hostname, 2114u))
+    {
+      return false;
+    }
+    std::lock_guard<std::mutex> lock(streamsMutex);
+    streams.push_back(std::move(pStream));
+    return true;
+  };
+
+  const auto                              start   = FleetBringUp::Clock::now();
+  std::vector<FleetBringUp::DeviceReport> reports = FleetBringUp(options).run(devices);
+  wall = std::chrono::duration_cast<std::chrono::microseconds>(FleetBringUp::Clock::now() - start);
+
+  for (FleetBringUp::DeviceReport& device : reports)
+  {
+    if (device.pControl)
+    {
+      device.pControl->close();
+    }
+  }
+  for (const std::unique_ptr<VisionaryDataStream>& pStream : streams)
+  {
+    pStream->close();
+  }
+  return reports;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  unsigned numDevices      = 16u;
+  unsigned numWorkers      = 8u;
+  unsigned responseDelayUs = 2000u;
+  unsigned jitterUs        = 2000u;
+
+  bool showHelpAndExit = false;
+  int  exitCode        = 0;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::istringstream argstream(argv[i]);
+
+    if (argstream.get() != '-')
+    {
+      showHelpAndExit = true;
+      exitCode        = 1;
+      break;
+    }
+    switch (argstream.get())
+    {
+      case 'h':
+        showHelpAndExit = true;
+        break;
+      case 'n':
+        argstream >> numDevices;
+        break;
+      case 'w':
+        argstream >> numWorkers;
+        break;
+      case 'd':
+        argstream >> responseDelayUs;
+        break;
+      case 'j':
+        argstream >> jitterUs;
+        break;
+      default:
+        showHelpAndExit = true;
+        exitCode        = 1;
+        break;
+    }
+  }
+
+  if ((numDevices == 0u) || (numDevices > 200u))
+  {
+    showHelpAndExit = true;
+    exitCode        = 1;
+  }
+
+  if (showHelpAndExit)
+  {
+    std::cout << argv[0] << " [option]*" << std::endl;
+    std::cout << "where option is one of" << std::endl;
+    std::cout << "-h          show this help and exit" << std::endl;
+    std::cout << "-n<cnt>     number of simulated devices (1..200); default is 16" << std::endl;
+    std::cout << "-w<cnt>     number of workers of the parallel run; default is 8" << std::endl;
+    std::cout << "-d<us>      simulated processing time per control command; default is 2000" << std::endl;
+    std::cout << "-j<us>      additional random processing time per device (0..jitter); default is 2000" << std::endl;
+    std::cout << "The simulated devices listen on 127.0.0.10, 127.0.0.11, ... (ports 2122 and 2114)." << std::endl;
+    return exitCode;
+  }
+
+  TcpConnection::initSocketLibrary();
+
+  std::mt19937                                  rng(42u);
+  std::uniform_int_distribution<unsigned>       jitter(0u, jitterUs);
+  std::vector<std::unique_ptr<SimulatedDevice>> simulatedDevices;
+  std::vector<FleetBringUp::Device>             devices;
+  for (unsigned i = 0u; i < numDevices; ++i)
+  {
+    const std::string address = "127.0.0." + std::to_string(10u + i);
+    simulatedDevices.push_back(startDevice(address, std::chrono::microseconds(responseDelayUs + jitter(rng))));
+    if (!simulatedDevices.back())
+    {
+      std::printf("Failed to start the simulated device on %s (ports 2122 and 2114 in use?)\n", address.c_str());
+      return 1;
+    }
+    devices.push_back(FleetBringUp::Device{address, VisionaryControl::ProtocolType::COLA_2});
+  }
+
+  std::printf("%u devices, command processing %u us + 0..%u us\n", numDevices, responseDelayUs, jitterUs);
+
+  std::chrono::microseconds                     serialWall;
+  std::chrono::microseconds                     parallelWall;
+  const std::vector<FleetBringUp::DeviceReport> serial   = runBringUp(devices, 1u, serialWall);
+  const std::vector<FleetBringUp::DeviceReport> parallel = runBringUp(devices, numWorkers, parallelWall);
+
+  report("serial (1 worker)", serial, serialWall);
+  const std::string parallelName = "parallel (" + std::to_string(numWorkers) + " workers)";
+  report(parallelName.c_str(), parallel, parallelWall);
+
+  for (const FleetBringUp::DeviceReport& device : parallel)
+  {
+    if (!device.success)
+    {
+      return 2;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,217 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+// Traces frames of a simulated camera through the acquisition pipeline (TracedDataStream) and prints where the time
+// goes: device timestamp to first byte, receiving the BLOB, decoding, point cloud generation and pickup. Device
+// and host share the clock here, so the transfer delay is exact up to the millisecond resolution of the timestamp.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AllocationTracker.h"
+#include "BlobEncoder.h"
+#include "ChromeTrace.h"
+#include "PointXYZ.h"
+#include "SimBlobServer.h"
+#include "SimCameraStream.h"
+#include "SimFrameSequence.h"
+#include "TcpConnection.h"
+#include "TracedDataStream.h"
+#include "VisionarySData.h"
+#include "VisionaryTMiniData.h"
+
+using namespace visionary;
+
+namespace {
+
+const char kHost[] = "127.0.0.1";
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  unsigned       numFrames  = 300u;
+  double         fps        = 30.;
+  std::string    deviceType = "tmini";
+  unsigned       width      = 0u;
+  unsigned       height     = 0u;
+  unsigned short blobPort   = 2114u;
+  bool           pointCloud = false;
+  std::string    traceFile;
+
+  bool showHelpAndExit = false;
+  int  exitCode        = 0;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::istringstream argstream(argv[i]);
+
+    if (argstream.get() != '-')
+    {
+      showHelpAndExit = true;
+      exitCode        = 1;
+      break;
+    }
+    switch (argstream.get())
+    {
+      case 'h':
+        showHelpAndExit = true;
+        break;
+      case 'n':
+        argstream >> numFrames;
+        break;
+      case 'f':
+        argstream >> fps;
+        break;
+      case 't':
+        argstream >> deviceType;
+        break;
+      case 'r':
+        argstream >> width;
+        argstream.get();
+        argstream >> height;
+        break;
+      case 'c':
+        argstream >> blobPort;
+        break;
+      case 'p':
+        pointCloud = true;
+        break;
+      case 'T':
+        argstream >> traceFile;
+        break;
+      default:
+        showHelpAndExit = true;
+        exitCode        = 1;
+        break;
+    }
+  }
+
+  if ((fps <= 0.) || ((deviceType != "s") && (deviceType != "tmini")))
+  {
+    showHelpAndExit = true;
+    exitCode        = 1;
+  }
+
+  if (showHelpAndExit)
+  {
+    std::cout << argv[0] << " [option]*" << std::endl;
+    std::cout << "where option is one of" << std::endl;
+    std::cout << "-h          show this help and exit" << std::endl;
+    std::cout << "-n<cnt>     number of frames; default is 300" << std::endl;
+    std::cout << "-f<fps>     frame rate of the simulated camera; default is 30" << std::endl;
+    std::cout << "-t<type>    device type: s (Visionary-S) or tmini (Visionary-T Mini); default is tmini" << std::endl;
+    std::cout << "-r<w>x<h>   map resolution; default is 640x512 (s) or 512x424 (tmini)" << std::endl;
+    std::cout << "-c<port>    BLOB port of the simulated camera; default is 2114" << std::endl;
+    std::cout << "-p          generate point clouds" << std::endl;
+    std::cout << "-T<file>    write a Chrome trace of the pipeline stages to <file> (chrome://tracing, ui.perfetto.dev)"
+              << std::endl;
+    return exitCode;
+  }
+
+  TcpConnection::initSocketLibrary();
+
+  const bool isS = (deviceType == "s");
+  if (width == 0u)
+  {
+    width  = isS ? 640u : 512u;
+    height = isS ? 512u : 424u;
+  }
+
+  SimFrameSequence sequence;
+  sequence.generate(isS ? BlobEncoder::DeviceType::VISIONARY_S : BlobEncoder::DeviceType::VISIONARY_T_MINI,
+                    static_cast<std::uint16_t>(width),
+                    static_cast<std::uint16_t>(height),
+                    30u);
+  SimBlobServer blob;
+  if (!blob.start(kHost, blobPort))
+  {
+    std::printf("Failed to start the simulated camera (port %u in use?)\n", static_cast<unsigned>(blobPort));
+    return 1;
+  }
+  SimCameraStream camera(blob, sequence);
+  camera.setFrameRate(fps);
+
+  std::shared_ptr<VisionaryData> pDataHandler;
+  if (isS)
+  {
+    pDataHandler = std::make_shared<VisionarySData>();
+  }
+  else
+  {
+    pDataHandler = std::make_shared<VisionaryTMiniData>();
+  }
+  TracedDataStream stream(pDataHandler);
+  if (!stream.open(kHost, blobPort))
+  {
+    std::printf("Failed to connect to the simulated camera.\n");
+    return 2;
+  }
+  while (blob.getClientCount() == 0u)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  std::printf("%u frames, %ux%u at %.1f fps%s\n", numFrames, width, height, fps, pointCloud ? ", point clouds" : "");
+
+  if (!traceFile.empty())
+  {
+    ChromeTrace::enable();
+    ChromeTrace::setThreadName("receiver");
+  }
+
+  camera.start();
+  std::vector<PointXYZ> points;
+  unsigned              timeouts = 0u;
+  for (unsigned i = 0u; i < numFrames; ++i)
+  {
+    if (!stream.getNextFrame(2000u))
+    {
+      ++timeouts;
+      continue;
+    }
+    if (pointCloud)
+    {
+      stream.generatePointCloud(points);
+    }
+    {
+      AllocationScope allocationScope(FrameStage::PICKUP);
+      stream.pickUp();
+    }
+    AllocationTracker::endFrame();
+  }
+  camera.stop();
+
+  std::printf("%s", FrameLatencyReport::format(stream.getReport().snapshot()).c_str());
+  std::printf("timeouts: %u, invalid telegrams: %llu\n",
+              timeouts,
+              static_cast<unsigned long long>(stream.getInvalidCount()));
+  if (AllocationTracker::isAvailable())
+  {
+    std::printf("%s", AllocationTracker::format(AllocationTracker::getReport()).c_str());
+  }
+  stream.close();
+
+  if (!traceFile.empty())
+  {
+    ChromeTrace::disable();
+    if (!ChromeTrace::write(traceFile))
+    {
+      std::printf("Failed to write the trace to %s\n", traceFile.c_str());
+      return 4;
+    }
+    std::printf("trace written to %s (%llu events dropped)\n",
+                traceFile.c_str(),
+                static_cast<unsigned long long>(ChromeTrace::getDroppedCount()));
+  }
+  return (timeouts == 0u) ? 0 : 3;
+}
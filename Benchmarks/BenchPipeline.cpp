@@ -0,0 +1,484 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+// Microbenchmarks of the per-frame processing steps, without network:
+//  - parse:       BLOB telegram into the data handler (steady state, the XML is only parsed for the first frame)
+//  - point cloud: generatePointCloud() and transformPointCloud()
+//  - statistics:  computeDepthStatistics() of the depth and state maps, DepthIntegralImage::build()
+//  - zones:       ZoneMonitor::evaluate() of 64 boxes tiling the field of view
+//  - ply:         PointCloudPlyWriter::WriteFormatPLY() in ASCII and binary format
+//  - cola:        encoding and decoding the CoLa B and CoLa 2 framing of a command
+// The frames are synthetic (SimFrameSequence) or recorded from port 2114 of a device (-l). Every case reports the
+// median time per operation and per pixel and the heap allocations per operation.
+//
+// With -b the results are compared with a baseline (see BenchBaseline.h) and the exit code signals regressions or
+// metrics missing in the baseline; the ctest targets perf_gate_* run it that way against
+// Benchmarks/perf_baseline.json. With -a only the allocation counts are compared, which unlike the times don't depend
+// on the machine. The build target update_perf_baseline records a new baseline on the current machine.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BenchAllocations.h"
+#include "BenchBaseline.h"
+#include "BenchUtils.h"
+#include "BlobEncoder.h"
+#include "BlobParser.h"
+#include "CoLaFrame.h"
+#include "CoLaParameterWriter.h"
+#include "DepthIntegralImage.h"
+#include "DepthStatistics.h"
+#include "MapView.h"
+#include "PointCloudPlyWriter.h"
+#include "PointXYZ.h"
+#include "SimFrameSequence.h"
+#include "VisionarySData.h"
+#include "VisionaryTMiniData.h"
+#include "ZoneMonitor.h"
+
+namespace {
+
+using namespace visionary;
+
+typedef std::chrono::steady_clock Clock;
+
+const std::size_t kTelegramHeaderSize = 4u + 4u; // magic and package length
+const unsigned    kCoLaOpsPerSample   = 1000u;   // the codec is too fast to time single operations
+const char        kPlyFile[]          = "BenchPipeline.ply";
+
+/// Result of one benchmark case
+struct CaseResult
+{
+  std::string           name;
+  std::size_t           numPixels   = 0u; ///< pixels processed per operation, 0 if not frame based
+  bench::LatencySummary ns;               ///< time per operation in ns
+  double                allocations = 0.; ///< heap allocations per operation
+  double                bytes       = 0.; ///< bytes allocated per operation
+};
+
+/// Runs op samples times (opsPerSample calls each) after one warm-up call
+template <typename TOperation>
+CaseResult measure(const std::string& name,
+                   std::size_t        numPixels,
+                   unsigned           samples,
+                   unsigned           opsPerSample,
+                   TOperation         op)
+{
+  op();
+
+  std::vector<double> sampleNs;
+  sampleNs.reserve(samples);
+  const std::uint64_t allocationsBefore = bench::getAllocationCount();
+  const std::uint64_t bytesBefore       = bench::getAllocatedBytes();
+  for (unsigned i = 0u; i < samples; ++i)
+  {
+    const Clock::time_point start = Clock::now();
+    for (unsigned j = 0u; j < opsPerSample; ++j)
+    {
+      op();
+    }
+    const Clock::duration elapsed = Clock::now() - start;
+    sampleNs.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count())
+                       / opsPerSample);
+  }
+  const std::uint64_t allocations = bench::getAllocationCount() - allocationsBefore;
+  const std::uint64_t bytes       = bench::getAllocatedBytes() - bytesBefore;
+  const double        numOps      = static_cast<double>(samples) * opsPerSample;
+
+  CaseResult result;
+  result.name        = name;
+  result.numPixels   = numPixels;
+  result.ns          = bench::summarize(sampleNs);
+  result.allocations = static_cast<double>(allocations) / numOps;
+  result.bytes       = static_cast<double>(bytes) / numOps;
+  return result;
+}
+
+void printHeader()
+{
+  std::printf("%-28s %12s %12s %10s %12s\n", "case", "ns/op (p50)", "ns/px (p50)", "allocs/op", "bytes/op");
+}
+
+/// Prints the result and adds its metrics
+void report(const CaseResult& result, bench::BenchMetrics& metrics)
+{
+  std::map<std::string, double>& caseMetrics = metrics[result.name];
+  caseMetrics["ns_per_op"]                   = result.ns.p50;
+  caseMetrics["allocs_per_op"]               = result.allocations;
+  if (result.numPixels > 0u)
+  {
+    caseMetrics["ns_per_pixel"] = result.ns.p50 / static_cast<double>(result.numPixels);
+    std::printf("%-28s %12.0f %12.2f %10.1f %12.0f\n",
+                result.name.c_str(),
+                result.ns.p50,
+                result.ns.p50 / static_cast<double>(result.numPixels),
+                result.allocations,
+                result.bytes);
+  }
+  else
+  {
+    std::printf("%-28s %12.1f %12s %10.1f %12.0f\n",
+                result.name.c_str(),
+                result.ns.p50,
+                "-",
+                result.allocations,
+                result.bytes);
+  }
+}
+
+bool writePly(const std::vector<PointXYZ>& points, const VisionaryTMiniData& data, bool useBinary)
+{
+  return PointCloudPlyWriter::WriteFormatPLY(kPlyFile, points, data.getIntensityMap(), useBinary);
+}
+
+bool writePly(const std::vector<PointXYZ>& points, const VisionarySData& data, bool useBinary)
+{
+  return PointCloudPlyWriter::WriteFormatPLY(kPlyFile, points, data.getRGBAMap(), useBinary);
+}
+
+MapView<std::uint16_t> getDepthView(const VisionaryTMiniData& data)
+{
+  return getDistanceView(data);
+}
+
+MapView<std::uint16_t> getDepthView(const VisionarySData& data)
+{
+  return getZView(data);
+}
+
+/// Frame based cases of one device type; the PLY writer is skipped if plySamples is 0
+///
+/// \retval false the telegrams could not be parsed
+template <typename TData>
+bool benchFrames(const char*             deviceName,
+                 const SimFrameSequence& sequence,
+                 unsigned                samples,
+                 unsigned                plySamples,
+                 bench::BenchMetrics&    metrics)
+{
+  // the parser reads the telegram without magic and length
+  std::vector<std::vector<std::uint8_t>> packages;
+  for (std::size_t i = 0u; i < sequence.size(); ++i)
+  {
+    const std::vector<std::uint8_t>& telegram = sequence.getTelegram(i);
+    packages.emplace_back(telegram.begin() + static_cast<std::ptrdiff_t>(kTelegramHeaderSize), telegram.end());
+  }
+
+  TData      data;
+  BlobParser parser;
+  if (!parser.parse(data, packages.front()))
+  {
+    std::printf("%s: the telegram could not be parsed\n", deviceName);
+    return false;
+  }
+  const std::size_t numPixels = static_cast<std::size_t>(data.getWidth()) * static_cast<std::size_t>(data.getHeight());
+  const std::string prefix    = std::string(deviceName) + " ";
+
+  std::size_t index = 0u;
+  bool        ok    = true;
+  report(measure(prefix + "parse",
+                 numPixels,
+                 samples,
+                 1u,
+                 [&]() {
+                   index = (index + 1u) % packages.size();
+                   ok    = parser.parse(data, packages[index]) && ok;
+                 }),
+         metrics);
+
+  std::vector<PointXYZ> points;
+  report(measure(prefix + "generatePointCloud", numPixels, samples, 1u, [&]() { data.generatePointCloud(points); }),
+         metrics);
+
+  // transforms the same cloud again and again; the values don't matter for the timing
+  report(measure(prefix + "transformPointCloud", numPixels, samples, 1u, [&]() { data.transformPointCloud(points); }),
+         metrics);
+
+  std::size_t validCount = 0u;
+  report(measure(prefix + "computeDepthStatistics",
+                 numPixels,
+                 samples,
+                 1u,
+                 [&]() { validCount += computeDepthStatistics(data).validCount; }),
+         metrics);
+
+  DepthIntegralImage integralImage;
+  report(measure(prefix + "DepthIntegralImage",
+                 numPixels,
+                 samples,
+                 1u,
+                 [&]() { integralImage.build(getDepthView(data)); }),
+         metrics);
+
+  ZoneMonitor                zoneMonitor;
+  std::vector<std::uint32_t> occupiedCounts;
+  if (zoneMonitor.setCamera(data))
+  {
+    // 8 x 8 boxes of 0.4 m x 0.3 m, reaching 10 m deep
+    for (unsigned i = 0u; i < ZoneMonitor::kMaxZones; ++i)
+    {
+      const float x = -1.6f + 0.4f * static_cast<float>(i % 8u);
+      const float y = -1.2f + 0.3f * static_cast<float>(i / 8u);
+      zoneMonitor.addZone(MonitoringZone::box({x, y, 0.f}, {x + 0.4f, y + 0.3f, 10.f}));
+    }
+    report(measure(prefix + "ZoneMonitor 64 zones",
+                   numPixels,
+                   samples,
+                   1u,
+                   [&]() { ok = zoneMonitor.evaluate(getDepthView(data), occupiedCounts) && ok; }),
+           metrics);
+  }
+
+  if (plySamples > 0u)
+  {
+    data.generatePointCloud(points);
+    report(measure(prefix + "WriteFormatPLY ascii",
+                   numPixels,
+                   plySamples,
+                   1u,
+                   [&]() { ok = writePly(points, data, false) && ok; }),
+           metrics);
+    report(measure(prefix + "WriteFormatPLY binary",
+                   numPixels,
+                   plySamples,
+                   1u,
+                   [&]() { ok = writePly(points, data, true) && ok; }),
+           metrics);
+    std::remove(kPlyFile);
+  }
+
+  if (!ok)
+  {
+    std::printf("%s: parsing or writing failed\n", deviceName);
+  }
+  return ok;
+}
+
+void benchCoLa(unsigned samples, bench::BenchMetrics& metrics)
+{
+  const struct
+  {
+    const char*                    name;
+    VisionaryControl::ProtocolType type;
+  } protocols[] = {{"CoLa B", VisionaryControl::ProtocolType::COLA_B},
+                   {"CoLa 2", VisionaryControl::ProtocolType::COLA_2}};
+
+  CoLaCommand command = CoLaParameterWriter(CoLaCommandType::READ_VARIABLE, "DeviceIdent").build();
+  CoLaFrame   request;
+  request.sessionId = 0x12345678u;
+  request.requestId = 1u;
+  request.payload   = command.getBuffer();
+
+  for (const auto& protocol : protocols)
+  {
+    const std::string prefix = std::string(protocol.name) + " ";
+
+    std::size_t encodedSize = 0u;
+    report(measure(prefix + "encode",
+                   0u,
+                   samples,
+                   kCoLaOpsPerSample,
+                   [&]() { encodedSize += encodeCoLaFrame(protocol.type, request).size(); }),
+           metrics);
+
+    const std::vector<std::uint8_t> encoded = encodeCoLaFrame(protocol.type, request);
+    CoLaFrameDecoder                decoder(protocol.type);
+    CoLaFrame                       decoded;
+    report(measure(prefix + "decode",
+                   0u,
+                   samples,
+                   kCoLaOpsPerSample,
+                   [&]() {
+                     decoder.push(encoded.data(), encoded.size());
+                     decoder.pop(decoded);
+                   }),
+           metrics);
+  }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  unsigned    samples    = 50u;
+  unsigned    plySamples = 5u;
+  std::string deviceType = "all";
+  unsigned    width      = 0u;
+  unsigned    height     = 0u;
+  std::string recordFile;
+  std::string baselineFile;
+  std::string resultFile;
+  double      tolerance       = 0.3;
+  bool        allocationsOnly = false;
+
+  bool showHelpAndExit = false;
+  int  exitCode        = 0;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::istringstream argstream(argv[i]);
+
+    if (argstream.get() != '-')
+    {
+      showHelpAndExit = true;
+      exitCode        = 1;
+      break;
+    }
+    switch (argstream.get())
+    {
+      case 'h':
+        showHelpAndExit = true;
+        break;
+      case 'n':
+        argstream >> samples;
+        break;
+      case 'w':
+        argstream >> plySamples;
+        break;
+      case 't':
+        argstream >> deviceType;
+        break;
+      case 'r':
+        argstream >> width;
+        argstream.get();
+        argstream >> height;
+        break;
+      case 'l':
+        argstream >> recordFile;
+        break;
+      case 'b':
+        argstream >> baselineFile;
+        break;
+      case 'x':
+        argstream >> tolerance;
+        break;
+      case 'a':
+        allocationsOnly = true;
+        break;
+      case 'j':
+        argstream >> resultFile;
+        break;
+      default:
+        showHelpAndExit = true;
+        exitCode        = 1;
+        break;
+    }
+  }
+
+  const bool isS    = (deviceType == "s") || (deviceType == "all");
+  const bool isTMini = (deviceType == "tmini") || (deviceType == "all");
+  const bool isCoLa  = (deviceType == "cola") || (deviceType == "all");
+  if ((samples == 0u) || (tolerance < 0.) || (!isS && !isTMini && !isCoLa)
+      || (!recordFile.empty() && (deviceType != "s") && (deviceType != "tmini")))
+  {
+    showHelpAndExit = true;
+    exitCode        = 1;
+  }
+
+  if (showHelpAndExit)
+  {
+    std::cout << argv[0] << " [option]*" << std::endl;
+    std::cout << "where option is one of" << std::endl;
+    std::cout << "-h          show this help and exit" << std::endl;
+    std::cout << "-n<cnt>     samples per case; default is 50" << std::endl;
+    std::cout << "-w<cnt>     samples of the PLY writer cases, 0 skips them; default is 5" << std::endl;
+    std::cout << "-t<group>   cases to run: s (Visionary-S), tmini (Visionary-T Mini), cola or all; default is all"
+              << std::endl;
+    std::cout << "-r<w>x<h>   map resolution of the synthetic frames; default is 640x512 (s) or 512x424 (tmini)"
+              << std::endl;
+    std::cout << "-l<file>    use the frames recorded in <file> (raw capture of port 2114, needs -ts or -ttmini)"
+              << std::endl;
+    std::cout << "-j<file>    write the results as JSON to <file>, e.g. to record a new baseline" << std::endl;
+    std::cout << "-b<file>    compare the results with the baseline in <file>; exit code 4 on regressions or metrics"
+              << " missing in the baseline" << std::endl;
+    std::cout << "-a          compare only the allocation counts with the baseline" << std::endl;
+    std::cout << "-x<ratio>   tolerated relative increase of the times over the baseline; default is 0.3" << std::endl;
+    return exitCode;
+  }
+
+  bench::BenchMetrics baseline;
+  if (!baselineFile.empty() && !bench::readBaseline(baselineFile, baseline))
+  {
+    std::printf("Failed to read the baseline %s\n", baselineFile.c_str());
+    return 2;
+  }
+
+  printHeader();
+  bench::BenchMetrics metrics;
+  bool                ok = true;
+  if (isS)
+  {
+    SimFrameSequence sequence;
+    if (recordFile.empty())
+    {
+      sequence.generate(BlobEncoder::DeviceType::VISIONARY_S,
+                        static_cast<std::uint16_t>((width != 0u) ? width : 640u),
+                        static_cast<std::uint16_t>((height != 0u) ? height : 512u),
+                        10u);
+    }
+    else if (!sequence.load(recordFile) || sequence.empty())
+    {
+      std::printf("No frames in %s\n", recordFile.c_str());
+      return 2;
+    }
+    ok = benchFrames<VisionarySData>("S", sequence, samples, plySamples, metrics) && ok;
+  }
+  if (isTMini)
+  {
+    SimFrameSequence sequence;
+    if (recordFile.empty())
+    {
+      sequence.generate(BlobEncoder::DeviceType::VISIONARY_T_MINI,
+                        static_cast<std::uint16_t>((width != 0u) ? width : 512u),
+                        static_cast<std::uint16_t>((height != 0u) ? height : 424u),
+                        10u);
+    }
+    else if (!sequence.load(recordFile) || sequence.empty())
+    {
+      std::printf("No frames in %s\n", recordFile.c_str());
+      return 2;
+    }
+    ok = benchFrames<VisionaryTMiniData>("T Mini", sequence, samples, plySamples, metrics) && ok;
+  }
+  if (isCoLa)
+  {
+    benchCoLa(samples, metrics);
+  }
+  if (!ok)
+  {
+    return 3;
+  }
+
+  if (!resultFile.empty() && !bench::writeBaseline(resultFile, metrics))
+  {
+    std::printf("Failed to write the results to %s\n", resultFile.c_str());
+    return 2;
+  }
+  if (!baselineFile.empty())
+  {
+    if (allocationsOnly)
+    {
+      std::printf("\ncomparison of the allocation counts with %s\n", baselineFile.c_str());
+    }
+    else
+    {
+      std::printf("\ncomparison with %s (tolerance %.0f%%)\n", baselineFile.c_str(), tolerance * 100.);
+    }
+    const std::size_t failures = bench::compareWithBaseline(baseline, metrics, tolerance, allocationsOnly);
+    std::printf("%zu regressed or missing metric(s)\n", failures);
+    if (failures > 0u)
+    {
+      return 4;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,380 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+// Compares the CoLa B and CoLa 2 protocol handlers with identical workloads (variable read, variable write and
+// method invocation):
+//  - codec:      CPU time to add the transport framing to a telegram and to split it off again
+//  - sequential: round trip latency of one command at a time against a simulated device, through the synchronous
+//                VisionaryControl of the shared library and through AsyncControl
+//  - pipelined:  commands per second with several commands in flight (CoLa B serializes them on the connection)
+// The simulated devices listen on 127.0.0.1 on the default ports of the protocols (2112 and 2122).
+//
+// CPU times are measured per thread where one thread does all the work (codec, VisionaryControl). The process CPU
+// time of the sequential runs includes the simulator and, for AsyncControl, its I/O thread.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#  include <winsock2.h>
+#else
+#  include <time.h>
+#endif
+
+#include "AsyncControl.h"
+#include "BenchUtils.h"
+#include "CoLaFrame.h"
+#include "CoLaParameterWriter.h"
+#include "SimControlServer.h"
+#include "VisionaryControl.h"
+
+namespace {
+
+using namespace visionary;
+
+typedef std::chrono::steady_clock Clock;
+
+struct Workload
+{
+  const char* name;
+  CoLaCommand command;
+};
+
+struct Protocol
+{
+  const char*                    name;
+  VisionaryControl::ProtocolType type;
+};
+
+const Protocol kProtocols[] = {{"CoLa B", VisionaryControl::ProtocolType::COLA_B},
+                               {"CoLa 2", VisionaryControl::ProtocolType::COLA_2}};
+
+std::vector<Workload> makeWorkloads()
+{
+  std::vector<Workload> workloads;
+  workloads.push_back(Workload{"read", CoLaParameterWriter(CoLaCommandType::READ_VARIABLE, "benchValue").build()});
+  workloads.push_back(Workload{
+    "write", CoLaParameterWriter(CoLaCommandType::WRITE_VARIABLE, "frontendMode").parameterUSInt(1u).build()});
+  workloads.push_back(Workload{
+    "method", CoLaParameterWriter(CoLaCommandType::METHOD_INVOCATION, "PLAYNEXT").build()});
+  return workloads;
+}
+
+bool startDevice(SimControlServer& device, std::size_t valueSize, std::chrono::microseconds responseDelay)
+{
+  device.setVariable("benchValue", std::vector<std::uint8_t>(valueSize, 0x5Au));
+  device.setVariable("frontendMode", std::vector<std::uint8_t>(1u, 0u));
+  device.setMethod("PLAYNEXT", [](const std::vector<std::uint8_t>&, std::vector<std::uint8_t>& result) {
+    result.clear();
+    return true;
+  });
+  device.setResponseDelay(responseDelay);
+  return device.start("127.0.0.1");
+}
+
+#ifdef _WIN32
+double toSeconds(const FILETIME& time)
+{
+  // 100 ns units
+  return static_cast<double>((static_cast<std::uint64_t>(time.dwHighDateTime) << 32u) | time.dwLowDateTime) * 1e-7;
+}
+#else
+double toSeconds(const timespec& time)
+{
+  return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_nsec) * 1e-9;
+}
+#endif
+
+/// CPU time of the calling thread
+double threadCpuSeconds()
+{
+#ifdef _WIN32
+  FILETIME creationTime, exitTime, kernelTime, userTime;
+  ::GetThreadTimes(::GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime);
+  return toSeconds(kernelTime) + toSeconds(userTime);
+#else
+  timespec time;
+  ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return toSeconds(time);
+#endif
+}
+
+/// CPU time of all threads of the process (client, I/O and simulator threads)
+double processCpuSeconds()
+{
+#ifdef _WIN32
+  FILETIME creationTime, exitTime, kernelTime, userTime;
+  ::GetProcessTimes(::GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime);
+  return toSeconds(kernelTime) + toSeconds(userTime);
+#else
+  timespec time;
+  ::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+  return toSeconds(time);
+#endif
+}
+
+/// CPU time per telegram in ns to encode the framing and to decode it again
+void benchCodec(const Protocol& protocol, const Workload& workload, unsigned iterations)
+{
+  CoLaCommand command = workload.command;
+  CoLaFrame   request;
+  request.sessionId = 0x12345678u;
+  request.requestId = 1u;
+  request.payload   = command.getBuffer();
+
+  std::size_t frameSize = 0u;
+  double      start     = threadCpuSeconds();
+  for (unsigned i = 0u; i < iterations; ++i)
+  {
+    request.requestId = static_cast<std::uint16_t>(i);
+    frameSize += encodeCoLaFrame(protocol.type, request).size();
+  }
+  const double encodeNs = (threadCpuSeconds() - start) * 1e9 / iterations;
+
+  const std::vector<std::uint8_t> encoded = encodeCoLaFrame(protocol.type, request);
+  CoLaFrameDecoder                decoder(protocol.type);
+  CoLaFrame                       decoded;
+  std::size_t                     payloadSize = 0u;
+
+  start = threadCpuSeconds();
+  for (unsigned i = 0u; i < iterations; ++i)
+  {
+    decoder.push(encoded.data(), encoded.size());
+    if (decoder.pop(decoded))
+    {
+      payloadSize += decoded.payload.size();
+    }
+  }
+  const double decodeNs = (threadCpuSeconds() - start) * 1e9 / iterations;
+
+  std::printf("  %-8s %-7s frame %4zu bytes (payload %4zu)  encode %8.1f ns  decode %8.1f ns\n",
+              protocol.name,
+              workload.name,
+              frameSize / iterations,
+              payloadSize / iterations,
+              encodeNs,
+              decodeNs);
+}
+
+/// Round trip latency in us of one command at a time
+///
+/// \tparam Control VisionaryControl or AsyncControl
+template <typename Control>
+bool benchSequential(Control& control, const Protocol& protocol, const Workload& workload, unsigned iterations)
+{
+  std::vector<double> latenciesUs;
+  latenciesUs.reserve(iterations);
+  CoLaCommand  command         = workload.command;
+  const double threadCpuStart  = threadCpuSeconds();
+  const double processCpuStart = processCpuSeconds();
+  const auto   wallStart       = Clock::now();
+  for (unsigned i = 0u; i < iterations; ++i)
+  {
+    const auto  t0       = Clock::now();
+    CoLaCommand response = control.sendCommand(command);
+    const auto  t1       = Clock::now();
+    if (response.getError() != CoLaError::OK)
+    {
+      std::printf("  %s %s: command failed\n", protocol.name, workload.name);
+      return false;
+    }
+    latenciesUs.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count())
+                          / 1000.);
+  }
+  const double wallSec      = std::chrono::duration<double>(Clock::now() - wallStart).count();
+  const double threadCpuUs  = (threadCpuSeconds() - threadCpuStart) * 1e6 / iterations;
+  const double processCpuUs = (processCpuSeconds() - processCpuStart) * 1e6 / iterations;
+
+  const std::string label = std::string("  ") + protocol.name + " " + workload.name;
+  bench::printSummary(label.c_str(), bench::summarize(latenciesUs), "us");
+  std::printf("  %-22s %10.0f commands/s, CPU per command: calling thread %.1f us, process %.1f us\n",
+              "",
+              iterations / wallSec,
+              threadCpuUs,
+              processCpuUs);
+  return true;
+}
+
+/// Commands per second with up to depth commands in flight
+bool benchPipelined(AsyncControl&   control,
+                    const Protocol& protocol,
+                    const Workload& workload,
+                    unsigned        iterations,
+                    unsigned        depth)
+{
+  std::deque<std::future<CoLaCommand>> inFlight;
+  bool                                 ok    = true;
+  const auto                           start = Clock::now();
+  for (unsigned i = 0u; i < iterations; ++i)
+  {
+    if (inFlight.size() >= depth)
+    {
+      ok = (inFlight.front().get().getError() == CoLaError::OK) && ok;
+      inFlight.pop_front();
+    }
+    inFlight.push_back(control.sendCommandAsync(workload.command));
+  }
+  while (!inFlight.empty())
+  {
+    ok = (inFlight.front().get().getError() == CoLaError::OK) && ok;
+    inFlight.pop_front();
+  }
+  const double wallSec = std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::printf("  %-8s %-7s %10.0f commands/s%s\n",
+              protocol.name,
+              workload.name,
+              iterations / wallSec,
+              ok ? "" : " (some commands failed)");
+  return ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  unsigned iterations      = 2000u;
+  unsigned depth           = 8u;
+  unsigned responseDelayUs = 0u;
+  unsigned valueSize       = 64u;
+
+  bool showHelpAndExit = false;
+  int  exitCode        = 0;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::istringstream argstream(argv[i]);
+
+    if (argstream.get() != '-')
+    {
+      showHelpAndExit = true;
+      exitCode        = 1;
+      break;
+    }
+    switch (argstream.get())
+    {
+      case 'h':
+        showHelpAndExit = true;
+        break;
+      case 'n':
+        argstream >> iterations;
+        break;
+      case 'p':
+        argstream >> depth;
+        break;
+      case 'd':
+        argstream >> responseDelayUs;
+        break;
+      case 's':
+        argstream >> valueSize;
+        break;
+      default:
+        showHelpAndExit = true;
+        exitCode        = 1;
+        break;
+    }
+  }
+
+  if ((iterations == 0u) || (depth == 0u))
+  {
+    showHelpAndExit = true;
+    exitCode        = 1;
+  }
+
+  if (showHelpAndExit)
+  {
+    std::cout << argv[0] << " [option]*" << std::endl;
+    std::cout << "where option is one of" << std::endl;
+    std::cout << "-h          show this help and exit" << std::endl;
+    std::cout << "-n<cnt>     commands per workload and protocol; default is 2000" << std::endl;
+    std::cout << "-p<cnt>     commands in flight in the pipelined run; default is 8" << std::endl;
+    std::cout << "-d<us>      simulated processing time per command; default is 0" << std::endl;
+    std::cout << "-s<bytes>   size of the variable read by the read workload; default is 64" << std::endl;
+    std::cout << "The simulated devices listen on 127.0.0.1 (ports 2112 and 2122)." << std::endl;
+    return exitCode;
+  }
+
+  TcpConnection::initSocketLibrary();
+
+  const std::vector<Workload> workloads = makeWorkloads();
+
+  std::printf("codec (thread CPU time per telegram)\n");
+  for (const Protocol& protocol : kProtocols)
+  {
+    for (const Workload& workload : workloads)
+    {
+      benchCodec(protocol, workload, iterations * 100u);
+    }
+  }
+
+  std::vector<std::unique_ptr<SimControlServer>> devices;
+  std::vector<std::unique_ptr<VisionaryControl>> visionaryControls;
+  std::vector<std::unique_ptr<AsyncControl>>     controls;
+  for (const Protocol& protocol : kProtocols)
+  {
+    devices.emplace_back(new SimControlServer(protocol.type));
+    visionaryControls.emplace_back(new VisionaryControl());
+    controls.emplace_back(new AsyncControl());
+    if (!startDevice(*devices.back(), valueSize, std::chrono::microseconds(responseDelayUs)))
+    {
+      std::printf("Failed to start the simulated %s device (port %u in use?)\n",
+                  protocol.name,
+                  static_cast<unsigned>(defaultCoLaPort(protocol.type)));
+      return 1;
+    }
+    if (!visionaryControls.back()->open(protocol.type, "127.0.0.1")
+        || !controls.back()->open(protocol.type, "127.0.0.1"))
+    {
+      std::printf("Failed to connect to the simulated %s device\n", protocol.name);
+      return 1;
+    }
+    controls.back()->setMaxInFlight(depth);
+  }
+
+  bool ok = true;
+  std::printf(
+    "sequential round trips, VisionaryControl (%u commands, processing %u us)\n", iterations, responseDelayUs);
+  for (std::size_t i = 0u; i < devices.size(); ++i)
+  {
+    for (const Workload& workload : workloads)
+    {
+      ok = benchSequential(*visionaryControls[i], kProtocols[i], workload, iterations) && ok;
+    }
+  }
+
+  std::printf("sequential round trips, AsyncControl (%u commands, processing %u us)\n", iterations, responseDelayUs);
+  for (std::size_t i = 0u; i < devices.size(); ++i)
+  {
+    for (const Workload& workload : workloads)
+    {
+      ok = benchSequential(*controls[i], kProtocols[i], workload, iterations) && ok;
+    }
+  }
+
+  std::printf("pipelined (%u commands, up to %u in flight)\n", iterations, depth);
+  for (std::size_t i = 0u; i < devices.size(); ++i)
+  {
+    for (const Workload& workload : workloads)
+    {
+      ok = benchPipelined(*controls[i], kProtocols[i], workload, iterations, depth) && ok;
+    }
+  }
+
+  for (std::size_t i = 0u; i < devices.size(); ++i)
+  {
+    visionaryControls[i]->close();
+    controls[i]->close();
+    devices[i]->stop();
+  }
+  return ok ? 0 : 2;
+}
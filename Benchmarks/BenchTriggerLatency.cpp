@@ -0,0 +1,385 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+// Compares two ways of capturing frames on an external (IO) trigger against a simulated Visionary-T Mini:
+//  - polling: read TriggerBusy via "IOValue" on the control channel until the acquisition has finished, then fetch
+//    the frame (the approach formerly used by SampleVisionaryTMiniFrameGrabber)
+//  - stream:  TriggeredCapture, which only waits for the frame on the data stream
+// For both the latency from trigger to frame and the number of control commands are reported.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "BenchUtils.h"
+#include "BlobEncoder.h"
+#include "CoLaParameterReader.h"
+#include "CoLaParameterWriter.h"
+#include "FrameGrabber.h"
+#include "SimBlobServer.h"
+#include "SimControlServer.h"
+#include "TriggeredCapture.h"
+#include "VisionaryControl.h"
+#include "VisionaryTMiniData.h"
+
+namespace {
+
+using namespace visionary;
+
+typedef std::chrono::steady_clock Clock;
+
+const char kHost[] = "127.0.0.1";
+
+std::vector<std::uint8_t> ioValue(std::int8_t triggerBusy)
+{
+  // V3SIOsState: one SInt per IO, IO2 carries TriggerBusy
+  CoLaParameterWriter writer(CoLaCommandType::READ_VARIABLE, "IOValue");
+  writer.parameterSInt(0).parameterSInt(triggerBusy);
+  for (int i = 2; i < 6; ++i)
+  {
+    writer.parameterSInt(0);
+  }
+  return SimControlServer::parametersOf(writer.build());
+}
+
+/// Simulated device: control channel, data stream and a trigger source on IO1
+class SimulatedDevice
+{
+public:
+  SimulatedDevice(std::uint16_t width, std::uint16_t height, std::chrono::microseconds exposure)
+    : m_control(VisionaryControl::ProtocolType::COLA_2)
+    , m_encoder(BlobEncoder::DeviceType::VISIONARY_T_MINI, width, height)
+    , m_exposure(exposure)
+    , m_frameNumber(0u)
+    , m_running(false)
+  {
+    m_control.setVariable("DeviceIdent",
+                          SimControlServer::parametersOf(CoLaParameterWriter(CoLaCommandType::READ_VARIABLE, "x")
+                                                           .parameterFlexString("Visionary-T Mini CX (simulated)")
+                                                           .parameterFlexString("0.0.0")
+                                                           .build()));
+    m_control.setVariable("IOValue", ioValue(0));
+    m_control.setVariable("frontendMode", std::vector<std::uint8_t>(1u, 0u));
+    m_control.setVariable("DIO1Fnc", std::vector<std::uint8_t>(1u, 0u));
+    m_control.setVariable("DIO2Fnc", std::vector<std::uint8_t>(1u, 0u));
+    m_encoder.prepareFrame(m_frame);
+  }
+
+  ~SimulatedDevice()
+  {
+    stopTriggers();
+    m_blob.stop();
+    m_control.stop();
+  }
+
+  bool start(std::uint16_t blobPort, std::chrono::microseconds responseDelay)
+  {
+    m_control.setResponseDelay(responseDelay);
+    return m_control.start(kHost) && m_blob.start(kHost, blobPort);
+  }
+
+  std::size_t getBlobClientCount() const
+  {
+    return m_blob.getClientCount();
+  }
+
+  std::uint64_t getCommandCount() const
+  {
+    return m_control.getCommandCount();
+  }
+
+  /// Starts generating hardware triggers with a random period in [minPeriod, maxPeriod]
+  void startTriggers(std::chrono::microseconds minPeriod, std::chrono::microseconds maxPeriod)
+  {
+    stopTriggers();
+    m_running = true;
+    m_thread  = std::thread(&SimulatedDevice::triggerLoop, this, minPeriod, maxPeriod);
+  }
+
+  void stopTriggers()
+  {
+    m_running = false;
+    if (m_thread.joinable())
+    {
+      m_thread.join();
+    }
+  }
+
+  /// Time the trigger of a frame occurred
+  bool getTriggerTime(std::uint32_t frameNumber, Clock::time_point& triggerTime) const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if ((frameNumber == 0u) || (frameNumber > m_triggerTimes.size()))
+    {
+      return false;
+    }
+    triggerTime = m_triggerTimes[frameNumber - 1u];
+    return true;
+  }
+
+private:
+  void triggerLoop(std::chrono::microseconds minPeriod, std::chrono::microseconds maxPeriod)
+  {
+    std::mt19937                                rng(42u);
+    std::uniform_int_distribution<std::int64_t> period(minPeriod.count(), maxPeriod.count());
+    const std::vector<std::uint8_t>             busy = ioValue(1);
+    const std::vector<std::uint8_t>             idle = ioValue(0);
+    const std::chrono::system_clock::time_point epoch;
+    std::vector<std::uint8_t>                   telegram;
+
+    while (m_running)
+    {
+      std::this_thread::sleep_for(std::chrono::microseconds(period(rng)));
+
+      // prepare the telegram outside of the measured path, the encoding cost is the same for both methods
+      m_frame.frameNumber = m_frameNumber + 1u;
+      m_frame.timestampMs = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - epoch).count());
+      m_encoder.encode(m_frame, telegram);
+
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_triggerTimes.push_back(Clock::now());
+      }
+      m_control.setVariable("IOValue", busy);
+      std::this_thread::sleep_for(m_exposure);
+      ++m_frameNumber;
+      m_blob.publish(telegram);
+      m_control.setVariable("IOValue", idle);
+    }
+  }
+
+  SimControlServer                m_control;
+  SimBlobServer                   m_blob;
+  BlobEncoder                     m_encoder;
+  SimFrame                        m_frame;
+  const std::chrono::microseconds m_exposure;
+  std::uint32_t                   m_frameNumber;
+
+  std::atomic<bool> m_running;
+  std::thread       m_thread;
+
+  mutable std::mutex             m_mutex;
+  std::vector<Clock::time_point> m_triggerTimes;
+};
+
+struct RunResult
+{
+  std::vector<double> latenciesUs;
+  std::uint64_t       commands = 0u;
+  unsigned            timeouts = 0u;
+};
+
+void addLatency(const SimulatedDevice&                     device,
+                const std::shared_ptr<VisionaryTMiniData>& pFrame,
+                Clock::time_point                          receivedTime,
+                RunResult&                                 run)
+{
+  Clock::time_point triggerTime;
+  if (device.getTriggerTime(pFrame->getFrameNum(), triggerTime))
+  {
+    run.latenciesUs.push_back(
+      static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(receivedTime - triggerTime).count()));
+  }
+}
+
+RunResult runPolling(SimulatedDevice&                  device,
+                     VisionaryControl&                 control,
+                     FrameGrabber<VisionaryTMiniData>& frameGrabber,
+                     unsigned                          numFrames)
+{
+  RunResult                           run;
+  std::shared_ptr<VisionaryTMiniData> pFrame;
+  const std::uint64_t                 commandsBefore = device.getCommandCount();
+
+  const CoLaCommand getIOValue = CoLaParameterWriter(CoLaCommandType::READ_VARIABLE, "IOValue").build();
+
+  while (run.latenciesUs.size() + run.timeouts < numFrames)
+  {
+    // wait for a falling edge of TriggerBusy (acquisition finished)
+    bool busySeen = false;
+    for (;;)
+    {
+      CoLaCommand         response = control.sendCommand(getIOValue);
+      CoLaParameterReader reader(response);
+      reader.readSInt();
+      const std::int8_t triggerBusy = reader.readSInt();
+      if (triggerBusy != 0)
+      {
+        busySeen = true;
+      }
+      else if (busySeen)
+      {
+        break;
+      }
+    }
+
+    if (frameGrabber.getNextFrame(pFrame, 2000u))
+    {
+      addLatency(device, pFrame, Clock::now(), run);
+    }
+    else
+    {
+      ++run.timeouts;
+    }
+  }
+  run.commands = device.getCommandCount() - commandsBefore;
+  return run;
+}
+
+RunResult runStream(SimulatedDevice&                      device,
+                    TriggeredCapture<VisionaryTMiniData>& capture,
+                    unsigned                              numFrames)
+{
+  RunResult                                    run;
+  TriggeredCapture<VisionaryTMiniData>::Result result;
+  const std::uint64_t                          commandsBefore = device.getCommandCount();
+
+  while (run.latenciesUs.size() + run.timeouts < numFrames)
+  {
+    if (capture.waitForFrame(result, 2000u))
+    {
+      addLatency(device, result.pFrame, result.receivedTime, run);
+    }
+    else
+    {
+      ++run.timeouts;
+    }
+  }
+  run.commands = device.getCommandCount() - commandsBefore;
+  return run;
+}
+
+void report(const char* name, const RunResult& run)
+{
+  bench::printSummary(name, bench::summarize(run.latenciesUs), "us");
+  std::printf("%-24s control commands: %llu, timeouts: %u\n",
+              "",
+              static_cast<unsigned long long>(run.commands),
+              run.timeouts);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  unsigned       numFrames       = 500u;
+  unsigned       responseDelayUs = 500u;
+  unsigned       exposureUs      = 2000u;
+  unsigned short blobPort        = 2114u;
+  unsigned       width           = 512u;
+  unsigned       height          = 424u;
+
+  bool showHelpAndExit = false;
+  int  exitCode        = 0;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::istringstream argstream(argv[i]);
+
+    if (argstream.get() != '-')
+    {
+      showHelpAndExit = true;
+      exitCode        = 1;
+      break;
+    }
+    switch (argstream.get())
+    {
+      case 'h':
+        showHelpAndExit = true;
+        break;
+      case 'n':
+        argstream >> numFrames;
+        break;
+      case 'd':
+        argstream >> responseDelayUs;
+        break;
+      case 'e':
+        argstream >> exposureUs;
+        break;
+      case 'c':
+        argstream >> blobPort;
+        break;
+      case 'r':
+        argstream >> width;
+        argstream.get();
+        argstream >> height;
+        break;
+      default:
+        showHelpAndExit = true;
+        exitCode        = 1;
+        break;
+    }
+  }
+
+  if (showHelpAndExit)
+  {
+    std::cout << argv[0] << " [option]*" << std::endl;
+    std::cout << "where option is one of" << std::endl;
+    std::cout << "-h          show this help and exit" << std::endl;
+    std::cout << "-n<cnt>     frames per method; default is 500" << std::endl;
+    std::cout << "-d<us>      simulated processing time per control command; default is 500" << std::endl;
+    std::cout << "-e<us>      simulated exposure time (TriggerBusy high); default is 2000" << std::endl;
+    std::cout << "-c<port>    BLOB port of the simulated device; default is 2114" << std::endl;
+    std::cout << "-r<w>x<h>   map resolution; default is 512x424" << std::endl;
+    std::cout << "The simulated device listens on " << kHost << ":2122 (CoLa 2)." << std::endl;
+    return exitCode;
+  }
+
+  TcpConnection::initSocketLibrary();
+
+  SimulatedDevice device(static_cast<std::uint16_t>(width),
+                         static_cast<std::uint16_t>(height),
+                         std::chrono::microseconds(exposureUs));
+  if (!device.start(blobPort, std::chrono::microseconds(responseDelayUs)))
+  {
+    std::printf("Failed to start the simulated device (ports 2122 and %u in use?)\n", static_cast<unsigned>(blobPort));
+    return 1;
+  }
+
+  VisionaryControl control;
+  if (!control.open(VisionaryControl::ProtocolType::COLA_2, kHost, 5000u))
+  {
+    std::printf("Failed to open control connection to the simulated device.\n");
+    return 2;
+  }
+  FrameGrabber<VisionaryTMiniData>     frameGrabber(kHost, blobPort, 5000u);
+  TriggeredCapture<VisionaryTMiniData> capture(control, frameGrabber);
+  if (!capture.armHardwareTrigger())
+  {
+    std::printf("Failed to configure the simulated device for IO trigger.\n");
+    return 3;
+  }
+  while (device.getBlobClientCount() == 0u)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  std::printf("%u frames per method, %ux%u, command processing %u us, exposure %u us\n",
+              numFrames,
+              width,
+              height,
+              responseDelayUs,
+              exposureUs);
+
+  device.startTriggers(std::chrono::milliseconds(5), std::chrono::milliseconds(15));
+  const RunResult polling = runPolling(device, control, frameGrabber, numFrames);
+  const RunResult stream  = runStream(device, capture, numFrames);
+  device.stopTriggers();
+
+  report("IOValue polling", polling);
+  report("TriggeredCapture", stream);
+
+  control.close();
+  return ((polling.timeouts == 0u) && (stream.timeouts == 0u)) ? 0 : 4;
+}
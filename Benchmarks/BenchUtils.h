@@ -0,0 +1,75 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+namespace visionary {
+namespace bench {
+
+/// Latency distribution of a benchmark run
+struct LatencySummary
+{
+  std::size_t count = 0u;
+  double      p50   = 0.;
+  double      p90   = 0.;
+  double      p99   = 0.;
+  double      max   = 0.;
+  double      mean  = 0.;
+};
+
+/// Nearest-rank percentile of sorted samples
+///
+/// \param[in] sorted samples in ascending order, must not be empty
+/// \param[in] p      percentile in [0, 100]
+inline double percentile(const std::vector<double>& sorted, double p)
+{
+  const double rank  = p / 100. * static_cast<double>(sorted.size() - 1u);
+  const auto   index = static_cast<std::size_t>(rank + 0.5);
+  return sorted[std::min(index, sorted.size() - 1u)];
+}
+
+inline LatencySummary summarize(std::vector<double> samples)
+{
+  LatencySummary summary;
+  if (samples.empty())
+  {
+    return summary;
+  }
+  std::sort(samples.begin(), samples.end());
+  double sum = 0.;
+  for (double sample : samples)
+  {
+    sum += sample;
+  }
+  summary.count = samples.size();
+  summary.p50   = percentile(samples, 50.);
+  summary.p90   = percentile(samples, 90.);
+  summary.p99   = percentile(samples, 99.);
+  summary.max   = samples.back();
+  summary.mean  = sum / static_cast<double>(samples.size());
+  return summary;
+}
+
+/// Prints one table row: name, sample count and the distribution in the given unit
+inline void printSummary(const char* name, const LatencySummary& summary, const char* unit)
+{
+  std::printf("%-24s n=%-6zu p50=%9.1f p90=%9.1f p99=%9.1f max=%9.1f mean=%9.1f [%s]\n",
+              name,
+              summary.count,
+              summary.p50,
+              summary.p90,
+              summary.p99,
+              summary.max,
+              summary.mean,
+              unit);
+}
+
+} // namespace bench
+} // namespace visionary
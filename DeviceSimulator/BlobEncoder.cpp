@@ -0,0 +1,282 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "BlobEncoder.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace visionary {
+
+namespace {
+
+const std::uint16_t kProtocolVersion    = 0x0001u;
+const std::uint8_t  kPacketTypeBlob     = 0x62u;
+const std::uint16_t kNumSegments        = 3u;
+const std::size_t   kTelegramHeaderSize = 4u + 4u + 2u + 1u;            // magic, length, protocol version, type
+const std::size_t   kBlobHeaderSize     = 2u + 2u + kNumSegments * 8u; // blob id, segment count, segment table
+const std::uint16_t kBinaryVersion      = 2u;                          // version 2 carries the frame number
+const std::size_t   kBinaryHeaderSize   = 4u + 8u + 2u + 4u + 1u + 1u; // length, time, version, frame, quality, status
+const std::size_t   kBinaryTrailerSize  = 4u + 4u;                     // CRC (unused) and copy of the length
+
+void putBigEndian(std::uint8_t*& pDst, std::uint64_t value, std::size_t numBytes)
+{
+  for (std::size_t i = numBytes; i > 0u; --i)
+  {
+    *pDst++ = static_cast<std::uint8_t>(value >> (8u * (i - 1u)));
+  }
+}
+
+void putLittleEndian(std::uint8_t*& pDst, std::uint64_t value, std::size_t numBytes)
+{
+  for (std::size_t i = 0u; i < numBytes; ++i)
+  {
+    *pDst++ = static_cast<std::uint8_t>(value >> (8u * i));
+  }
+}
+
+void putMap(std::uint8_t*& pDst, const std::vector<std::uint16_t>& map)
+{
+  for (std::uint16_t value : map)
+  {
+    *pDst++ = static_cast<std::uint8_t>(value);
+    *pDst++ = static_cast<std::uint8_t>(value >> 8u);
+  }
+}
+
+void putMap(std::uint8_t*& pDst, const std::vector<std::uint32_t>& map)
+{
+  for (std::uint32_t value : map)
+  {
+    putLittleEndian(pDst, value, 4u);
+  }
+}
+
+std::uint32_t getBigEndian32(const std::uint8_t* pSrc)
+{
+  return (static_cast<std::uint32_t>(pSrc[0]) << 24u) | (static_cast<std::uint32_t>(pSrc[1]) << 16u)
+         | (static_cast<std::uint32_t>(pSrc[2]) << 8u) | static_cast<std::uint32_t>(pSrc[3]);
+}
+
+std::string makeXml(BlobEncoder::DeviceType deviceType, std::uint16_t width, std::uint16_t height)
+{
+  const bool isS = (deviceType == BlobEncoder::DeviceType::VISIONARY_S);
+
+  // pinhole model of the device optics scaled to the configured resolution
+  const double fx = isS ? 460.0 * width / 640.0 : 366.0 * width / 512.0;
+  const double fy = isS ? 460.0 * height / 512.0 : 366.0 * height / 424.0;
+
+  const char* dataSet = isS ? "DataSetStereo" : "DataSetDepthMap";
+
+  std::ostringstream xml;
+  xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+      << "<SickRecord>"
+      << "<Revision>SICK V1.10 in work</Revision>"
+      << "<DataSets>"
+      << "<" << dataSet << " datacount=\"1\">"
+      << "<FormatDescriptionDepthMap>"
+      << "<TimestampUTC/>"
+      << "<Version>uint16</Version>"
+      << "<DataStream>"
+      << "<Interleaved>false</Interleaved>"
+      << "<Width>" << width << "</Width>"
+      << "<Height>" << height << "</Height>"
+      << "<CameraToWorldTransform>";
+  for (int i = 0; i < 16; ++i)
+  {
+    xml << "<value>" << (((i % 5) == 0) ? "1.0" : "0.0") << "</value>";
+  }
+  xml << "</CameraToWorldTransform>"
+      << "<CameraMatrix>"
+      << "<FX>" << fx << "</FX>"
+      << "<FY>" << fy << "</FY>"
+      << "<CX>" << (width / 2.0) << "</CX>"
+      << "<CY>" << (height / 2.0) << "</CY>"
+      << "</CameraMatrix>"
+      << "<CameraDistortionParams>"
+      << "<K1>0.0</K1><K2>0.0</K2><P1>0.0</P1><P2>0.0</P2><K3>0.0</K3>"
+      << "</CameraDistortionParams>"
+      << "<FocalToRayCross>0.0</FocalToRayCross>"
+      << "<FrameNumber>uint32</FrameNumber>"
+      << "<Quality>uint8</Quality>"
+      << "<Status>uint8</Status>";
+  if (isS)
+  {
+    xml << "<Z>uint16</Z>"
+        << "<Intensity>uint32</Intensity>"
+        << "<Confidence>uint16</Confidence>";
+  }
+  else
+  {
+    xml << "<Distance>uint16</Distance>"
+        << "<Intensity>uint16</Intensity>"
+        << "<Confidence>uint16</Confidence>";
+  }
+  xml << "</DataStream>"
+      << "</FormatDescriptionDepthMap>"
+      << "</" << dataSet << ">"
+      << "</DataSets>"
+      << "</SickRecord>";
+  return xml.str();
+}
+
+// days since 1970-01-01 to civil date (proleptic Gregorian calendar)
+void civilFromDays(std::int64_t days, std::uint32_t& year, std::uint32_t& month, std::uint32_t& day)
+{
+  days += 719468;
+  const std::int64_t  era = (days >= 0 ? days : days - 146096) / 146097;
+  const std::uint64_t doe = static_cast<std::uint64_t>(days - era * 146097);
+  const std::uint64_t yoe = (doe - doe / 1460u + doe / 36524u - doe / 146096u) / 365u;
+  const std::uint64_t doy = doe - (365u * yoe + yoe / 4u - yoe / 100u);
+  const std::uint64_t mp  = (5u * doy + 2u) / 153u;
+  day                     = static_cast<std::uint32_t>(doy - (153u * mp + 2u) / 5u + 1u);
+  month                   = static_cast<std::uint32_t>(mp < 10u ? mp + 3u : mp - 9u);
+  year = static_cast<std::uint32_t>(static_cast<std::int64_t>(yoe) + era * 400 + (month <= 2u ? 1 : 0));
+}
+
+} // namespace
+
+BlobEncoder::BlobEncoder(DeviceType deviceType, std::uint16_t width, std::uint16_t height)
+  : m_deviceType(deviceType), m_width(width), m_height(height), m_xml(makeXml(deviceType, width, height))
+{
+}
+
+BlobEncoder::DeviceType BlobEncoder::getDeviceType() const
+{
+  return m_deviceType;
+}
+
+std::uint16_t BlobEncoder::getWidth() const
+{
+  return m_width;
+}
+
+std::uint16_t BlobEncoder::getHeight() const
+{
+  return m_height;
+}
+
+std::size_t BlobEncoder::getNumPixels() const
+{
+  return static_cast<std::size_t>(m_width) * m_height;
+}
+
+void BlobEncoder::prepareFrame(SimFrame& frame) const
+{
+  const bool isS = (m_deviceType == DeviceType::VISIONARY_S);
+  frame.distance.resize(getNumPixels());
+  frame.intensity.resize(isS ? 0u : getNumPixels());
+  frame.rgba.resize(isS ? getNumPixels() : 0u);
+  frame.state.resize(getNumPixels());
+}
+
+std::size_t BlobEncoder::binarySegmentSize() const
+{
+  // Visionary-S: uint16 Z, uint32 RGBA, uint16 confidence; Visionary-T Mini: three uint16 maps
+  const std::size_t bytesPerPixel = (m_deviceType == DeviceType::VISIONARY_S) ? 8u : 6u;
+  return kBinaryHeaderSize + bytesPerPixel * getNumPixels() + kBinaryTrailerSize;
+}
+
+void BlobEncoder::encode(const SimFrame& frame, std::vector<std::uint8_t>& packet) const
+{
+  const std::size_t binarySize  = binarySegmentSize();
+  const std::size_t blobSize    = kBlobHeaderSize + m_xml.size() + binarySize;
+  const std::size_t packageSize = 2u + 1u + blobSize; // protocol version, packet type, blob
+
+  packet.resize(4u + 4u + packageSize);
+  std::uint8_t* pDst = packet.data();
+
+  // telegram header
+  putBigEndian(pDst, 0x02020202u, 4u);
+  putBigEndian(pDst, packageSize, 4u);
+  putBigEndian(pDst, kProtocolVersion, 2u);
+  putBigEndian(pDst, kPacketTypeBlob, 1u);
+
+  // BLOB header, the segment offsets are relative to the blob id
+  const std::size_t xmlOffset    = kBlobHeaderSize;
+  const std::size_t binaryOffset = xmlOffset + m_xml.size();
+  putBigEndian(pDst, 0u, 2u); // blob id
+  putBigEndian(pDst, kNumSegments, 2u);
+  putBigEndian(pDst, xmlOffset, 4u);
+  putBigEndian(pDst, 1u, 4u); // change counter of the meta data, constant as the format never changes
+  putBigEndian(pDst, binaryOffset, 4u);
+  putBigEndian(pDst, frame.frameNumber, 4u);
+  putBigEndian(pDst, binaryOffset + binarySize, 4u);
+  putBigEndian(pDst, 0u, 4u);
+
+  // XML segment
+  pDst = std::copy(m_xml.begin(), m_xml.end(), pDst);
+
+  // binary segment (little endian)
+  const std::size_t length = binarySize - kBinaryTrailerSize;
+  putLittleEndian(pDst, length, 4u);
+  putLittleEndian(pDst, encodeTimestamp(frame.timestampMs), 8u);
+  putLittleEndian(pDst, kBinaryVersion, 2u);
+  putLittleEndian(pDst, frame.frameNumber, 4u);
+  putLittleEndian(pDst, 0u, 1u); // data quality
+  putLittleEndian(pDst, 0u, 1u); // device status
+  putMap(pDst, frame.distance);
+  if (m_deviceType == DeviceType::VISIONARY_S)
+  {
+    putMap(pDst, frame.rgba);
+  }
+  else
+  {
+    putMap(pDst, frame.intensity);
+  }
+  putMap(pDst, frame.state);
+  putLittleEndian(pDst, 0u, 4u); // CRC, not evaluated by the receiver
+  putLittleEndian(pDst, length, 4u);
+}
+
+bool BlobEncoder::restamp(std::vector<std::uint8_t>& packet, std::uint32_t frameNumber, std::uint64_t timestampMs)
+{
+  if ((packet.size() < kTelegramHeaderSize + kBlobHeaderSize) || (getBigEndian32(packet.data()) != 0x02020202u)
+      || (packet[10] != kPacketTypeBlob))
+  {
+    return false;
+  }
+
+  // the second segment table entry holds the offset of the binary segment and its change counter (frame number)
+  std::uint8_t*     pEntry       = packet.data() + kTelegramHeaderSize + 4u + 8u;
+  const std::size_t binaryOffset = kTelegramHeaderSize + getBigEndian32(pEntry);
+  if (binaryOffset + kBinaryHeaderSize > packet.size())
+  {
+    return false;
+  }
+  pEntry += 4u;
+  putBigEndian(pEntry, frameNumber, 4u);
+
+  std::uint8_t*       pBinary = packet.data() + binaryOffset + 4u;
+  putLittleEndian(pBinary, encodeTimestamp(timestampMs), 8u);
+  const std::uint16_t version = static_cast<std::uint16_t>(pBinary[0] | (pBinary[1] << 8u));
+  if (version >= 2u)
+  {
+    pBinary += 2u;
+    putLittleEndian(pBinary, frameNumber, 4u);
+  }
+  return true;
+}
+
+std::uint64_t BlobEncoder::encodeTimestamp(std::uint64_t timestampMs)
+{
+  // bit layout (msb first): 5 unused, 12 year, 4 month, 5 day, 11 timezone, 5 hour, 6 minute, 6 second, 10 ms
+  const std::uint64_t msPerDay = 24u * 60u * 60u * 1000u;
+  std::uint32_t       year;
+  std::uint32_t       month;
+  std::uint32_t       day;
+  civilFromDays(static_cast<std::int64_t>(timestampMs / msPerDay), year, month, day);
+
+  const std::uint64_t msOfDay = timestampMs % msPerDay;
+  const std::uint64_t hour    = msOfDay / 3600000u;
+  const std::uint64_t minute  = (msOfDay / 60000u) % 60u;
+  const std::uint64_t second  = (msOfDay / 1000u) % 60u;
+  const std::uint64_t ms      = msOfDay % 1000u;
+
+  return (static_cast<std::uint64_t>(year & 0xfffu) << 47u) | (static_cast<std::uint64_t>(month & 0xfu) << 43u)
+         | (static_cast<std::uint64_t>(day & 0x1fu) << 38u) | (hour << 22u) | (minute << 16u) | (second << 10u) | ms;
+}
+
+} // namespace visionary
@@ -0,0 +1,83 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace visionary {
+
+/// Image content of one simulated frame
+struct SimFrame
+{
+  std::uint32_t              frameNumber = 0u;
+  std::uint64_t              timestampMs = 0u; ///< acquisition time in ms since 1970-01-01 (UTC)
+  std::vector<std::uint16_t> distance;         ///< radial distance (Visionary-T Mini) or Z (Visionary-S)
+  std::vector<std::uint16_t> intensity;        ///< intensity (Visionary-T Mini only)
+  std::vector<std::uint32_t> rgba;             ///< color image (Visionary-S only)
+  std::vector<std::uint16_t> state;            ///< pixel state (Visionary-T Mini) or confidence (Visionary-S)
+};
+
+/// Encodes frames in the BLOB format sent by the devices on the data stream port (2114)
+///
+/// A telegram consists of the CoLa magic, the package length and the BLOB header with a segment table. The first
+/// segment holds the XML meta data describing the maps and camera parameters, the second the binary map data. A
+/// third, empty segment terminates the table since receivers take the end of a segment from the start of the next.
+class BlobEncoder
+{
+public:
+  enum class DeviceType
+  {
+    VISIONARY_S,     ///< Z, RGBA and confidence map
+    VISIONARY_T_MINI ///< distance, intensity and state map
+  };
+
+  /// \param[in] deviceType device whose data format is generated
+  /// \param[in] width      map width in pixels
+  /// \param[in] height     map height in pixels
+  BlobEncoder(DeviceType deviceType, std::uint16_t width, std::uint16_t height);
+
+  DeviceType    getDeviceType() const;
+  std::uint16_t getWidth() const;
+  std::uint16_t getHeight() const;
+  std::size_t   getNumPixels() const;
+
+  /// Resizes the maps of frame to the configured format (contents are left unchanged where possible)
+  void prepareFrame(SimFrame& frame) const;
+
+  /// Encodes a frame into a complete data stream telegram
+  ///
+  /// \param[in]  frame  frame to encode; the maps must have getNumPixels() entries (see prepareFrame())
+  /// \param[out] packet receives the telegram; its capacity is reused
+  void encode(const SimFrame& frame, std::vector<std::uint8_t>& packet) const;
+
+  /// Replaces frame number and timestamp of an encoded telegram in place
+  ///
+  /// Allows sending pre-encoded (or recorded) frames repeatedly without encoding the maps again.
+  ///
+  /// \param[in,out] packet      complete data stream telegram
+  /// \param[in]     frameNumber new frame number
+  /// \param[in]     timestampMs new acquisition time in ms since 1970-01-01 (UTC)
+  ///
+  /// \retval true  the telegram was updated
+  /// \retval false the telegram is not a BLOB telegram with a binary segment
+  static bool restamp(std::vector<std::uint8_t>& packet, std::uint32_t frameNumber, std::uint64_t timestampMs);
+
+  /// Encodes a time in the 64 bit timestamp format of the BLOB binary segment
+  static std::uint64_t encodeTimestamp(std::uint64_t timestampMs);
+
+private:
+  std::size_t binarySegmentSize() const;
+
+  DeviceType    m_deviceType;
+  std::uint16_t m_width;
+  std::uint16_t m_height;
+  std::string   m_xml;
+};
+
+} // namespace visionary
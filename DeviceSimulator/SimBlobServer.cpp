@@ -0,0 +1,96 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "SimBlobServer.h"
+
+namespace visionary {
+
+namespace {
+
+const std::uint32_t kPollMs = 100u;
+
+} // namespace
+
+SimBlobServer::SimBlobServer() : m_stop(true)
+{
+}
+
+SimBlobServer::~SimBlobServer()
+{
+  stop();
+}
+
+bool SimBlobServer::start(const std::string& address, std::uint16_t port)
+{
+  stop();
+  if (!m_listener.listen(address, port))
+  {
+    return false;
+  }
+  m_stop         = false;
+  m_acceptThread = std::thread(&SimBlobServer::acceptLoop, this);
+  return true;
+}
+
+void SimBlobServer::stop()
+{
+  m_stop = true;
+  if (m_acceptThread.joinable())
+  {
+    m_acceptThread.join();
+  }
+  m_listener.close();
+
+  std::lock_guard<std::mutex> lock(m_clientsMutex);
+  m_clients.clear();
+}
+
+std::uint16_t SimBlobServer::getPort() const
+{
+  return m_listener.getPort();
+}
+
+std::size_t SimBlobServer::getClientCount() const
+{
+  std::lock_guard<std::mutex> lock(m_clientsMutex);
+  return m_clients.size();
+}
+
+std::size_t SimBlobServer::publish(const std::vector<std::uint8_t>& telegram)
+{
+  std::lock_guard<std::mutex> lock(m_clientsMutex);
+  for (auto it = m_clients.begin(); it != m_clients.end();)
+  {
+    if ((*it)->send(telegram.data(), telegram.size()))
+    {
+      ++it;
+    }
+    else
+    {
+      it = m_clients.erase(it);
+    }
+  }
+  return m_clients.size();
+}
+
+void SimBlobServer::acceptLoop()
+{
+  while (!m_stop)
+  {
+    std::unique_ptr<TcpConnection> pConnection(new TcpConnection);
+    const int                      ret = m_listener.accept(*pConnection, kPollMs);
+    if (ret < 0)
+    {
+      break;
+    }
+    if (ret > 0)
+    {
+      std::lock_guard<std::mutex> lock(m_clientsMutex);
+      m_clients.push_back(std::move(pConnection));
+    }
+  }
+}
+
+} // namespace visionary
@@ -0,0 +1,64 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TcpConnection.h"
+
+namespace visionary {
+
+/// Data stream port of a simulated device
+///
+/// Accepts any number of receivers and sends every published BLOB telegram (see BlobEncoder) to all of them.
+class SimBlobServer
+{
+public:
+  SimBlobServer();
+  ~SimBlobServer();
+
+  SimBlobServer(const SimBlobServer&)            = delete;
+  SimBlobServer& operator=(const SimBlobServer&) = delete;
+
+  /// Starts listening
+  ///
+  /// \param[in] address local address, e.g. "127.0.0.1"
+  /// \param[in] port    local port; 0 lets the system choose a free port (see getPort())
+  bool start(const std::string& address, std::uint16_t port = 2114u);
+
+  /// Closes all connections and stops the accept thread
+  void stop();
+
+  std::uint16_t getPort() const;
+
+  /// Number of connected receivers
+  std::size_t getClientCount() const;
+
+  /// Sends a telegram to all connected receivers; receivers whose connection broke are dropped
+  ///
+  /// \return number of receivers the telegram was sent to
+  std::size_t publish(const std::vector<std::uint8_t>& telegram);
+
+private:
+  void acceptLoop();
+
+  TcpListener       m_listener;
+  std::thread       m_acceptThread;
+  std::atomic<bool> m_stop;
+
+  mutable std::mutex                        m_clientsMutex;
+  std::list<std::unique_ptr<TcpConnection>> m_clients;
+};
+
+} // namespace visionary
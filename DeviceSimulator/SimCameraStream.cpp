@@ -0,0 +1,175 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "SimCameraStream.h"
+
+#include <random>
+
+#include "BlobEncoder.h"
+
+namespace visionary {
+
+SimCameraStream::SimCameraStream(SimBlobServer& server, const SimFrameSequence& sequence)
+  : m_server(server)
+  , m_sequence(sequence)
+  , m_nextIndex(0u)
+  , m_frameNumber(0u)
+  , m_frameCount(0u)
+  , m_droppedCount(0u)
+  , m_stop(true)
+  , m_fps(30.0)
+  , m_burstSize(1u)
+  , m_jitter(0)
+{
+}
+
+SimCameraStream::~SimCameraStream()
+{
+  stop();
+}
+
+void SimCameraStream::setFrameRate(double fps)
+{
+  std::lock_guard<std::mutex> lock(m_stateMutex);
+  m_fps = fps;
+}
+
+void SimCameraStream::setBurstSize(unsigned burstSize)
+{
+  std::lock_guard<std::mutex> lock(m_stateMutex);
+  m_burstSize = (burstSize > 0u) ? burstSize : 1u;
+}
+
+void SimCameraStream::setJitter(std::chrono::microseconds jitter)
+{
+  std::lock_guard<std::mutex> lock(m_stateMutex);
+  m_jitter = jitter;
+}
+
+void SimCameraStream::start()
+{
+  std::lock_guard<std::mutex> controlLock(m_controlMutex);
+  if (m_thread.joinable())
+  {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    m_stop = false;
+  }
+  m_thread = std::thread(&SimCameraStream::run, this);
+}
+
+void SimCameraStream::stop()
+{
+  std::lock_guard<std::mutex> controlLock(m_controlMutex);
+  {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    m_stop = true;
+  }
+  m_stopCondition.notify_all();
+  if (m_thread.joinable())
+  {
+    m_thread.join();
+  }
+}
+
+bool SimCameraStream::isRunning() const
+{
+  std::lock_guard<std::mutex> lock(m_stateMutex);
+  return !m_stop;
+}
+
+std::size_t SimCameraStream::step()
+{
+  return publishNext();
+}
+
+std::uint64_t SimCameraStream::getFrameCount() const
+{
+  return m_frameCount;
+}
+
+std::uint64_t SimCameraStream::getDroppedCount() const
+{
+  return m_droppedCount;
+}
+
+void SimCameraStream::bindAcquisitionMethods(SimControlServer& control)
+{
+  control.setMethod("PLAYSTART", [this](const std::vector<std::uint8_t>&, std::vector<std::uint8_t>& result) {
+    start();
+    result.clear();
+    return true;
+  });
+  control.setMethod("PLAYSTOP", [this](const std::vector<std::uint8_t>&, std::vector<std::uint8_t>& result) {
+    stop();
+    result.clear();
+    return true;
+  });
+  control.setMethod("PLAYNEXT", [this](const std::vector<std::uint8_t>&, std::vector<std::uint8_t>& result) {
+    step();
+    result.clear();
+    return true;
+  });
+}
+
+void SimCameraStream::run()
+{
+  std::unique_lock<std::mutex> lock(m_stateMutex);
+  const unsigned               burstSize = m_burstSize;
+  const std::int64_t           jitterUs  = m_jitter.count();
+  const auto                   period    = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    std::chrono::duration<double>(burstSize / m_fps));
+
+  std::mt19937 rng(std::random_device{}());
+  auto         nextBurst = std::chrono::steady_clock::now();
+  while (!m_stop)
+  {
+    const auto sendTime =
+      nextBurst + std::chrono::microseconds(std::uniform_int_distribution<std::int64_t>(0, jitterUs)(rng));
+    if (m_stopCondition.wait_until(lock, sendTime, [this] { return m_stop; }))
+    {
+      break;
+    }
+    lock.unlock();
+
+    for (unsigned i = 0u; i < burstSize; ++i)
+    {
+      publishNext();
+    }
+
+    // when publishing took longer than the bursts missed meanwhile, skip them instead of sending them late
+    nextBurst += period;
+    const auto now = std::chrono::steady_clock::now();
+    if (now > nextBurst + period)
+    {
+      const auto missed = (now - nextBurst) / period;
+      m_droppedCount += static_cast<std::uint64_t>(missed) * burstSize;
+      nextBurst += missed * period;
+    }
+    lock.lock();
+  }
+}
+
+std::size_t SimCameraStream::publishNext()
+{
+  std::lock_guard<std::mutex> lock(m_publishMutex);
+
+  // copying into the own buffer keeps the sequence unmodified, so that streams can share it
+  const std::vector<std::uint8_t>& telegram = m_sequence.getTelegram(m_nextIndex);
+  m_telegram.assign(telegram.begin(), telegram.end());
+  m_nextIndex = (m_nextIndex + 1u) % m_sequence.size();
+
+  const std::uint64_t timestampMs = static_cast<std::uint64_t>(
+    std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch())
+      .count());
+  BlobEncoder::restamp(m_telegram, ++m_frameNumber, timestampMs);
+
+  ++m_frameCount;
+  return m_server.publish(m_telegram);
+}
+
+} // namespace visionary
@@ -0,0 +1,102 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "SimBlobServer.h"
+#include "SimControlServer.h"
+#include "SimFrameSequence.h"
+
+namespace visionary {
+
+/// Acquisition of a simulated camera: sends the frames of a SimFrameSequence on its data stream port
+///
+/// In continuous mode (start()) a thread publishes the sequence in a loop at the configured frame rate. Frames can
+/// be sent in bursts to simulate a device or network that delivers frames unevenly: burstSize frames are sent back to
+/// back, the bursts follow each other at burstSize / fps, so the average rate stays the same. Every frame gets a new
+/// frame number and the current time as timestamp.
+///
+/// When the receivers can't keep up, publishing blocks and frames are dropped (not sent later) as on a real device.
+class SimCameraStream
+{
+public:
+  /// \param[in] server   data stream port of the device; must outlive the stream
+  /// \param[in] sequence frames to send; must outlive the stream and must not be empty
+  SimCameraStream(SimBlobServer& server, const SimFrameSequence& sequence);
+  ~SimCameraStream();
+
+  SimCameraStream(const SimCameraStream&)            = delete;
+  SimCameraStream& operator=(const SimCameraStream&) = delete;
+
+  /// Frame rate of the continuous mode (default 30); takes effect at the next start()
+  void setFrameRate(double fps);
+
+  /// Number of frames sent back to back (default 1, i.e. evenly spaced); takes effect at the next start()
+  void setBurstSize(unsigned burstSize);
+
+  /// Maximum of a uniformly distributed random delay of every burst (default 0); takes effect at the next start()
+  void setJitter(std::chrono::microseconds jitter);
+
+  /// Starts the continuous mode; does nothing if already running
+  void start();
+
+  /// Stops the continuous mode
+  void stop();
+
+  bool isRunning() const;
+
+  /// Sends the next frame immediately (single step mode)
+  ///
+  /// \return number of receivers the frame was sent to
+  std::size_t step();
+
+  /// Number of frames published since construction
+  std::uint64_t getFrameCount() const;
+
+  /// Number of frames not sent in continuous mode because publishing fell behind the frame rate
+  std::uint64_t getDroppedCount() const;
+
+  /// Lets the acquisition methods of a simulated device control the stream
+  ///
+  /// PLAYSTART starts, PLAYSTOP stops the continuous mode and PLAYNEXT sends one frame. The stream must outlive
+  /// the server (or its handlers must be replaced).
+  void bindAcquisitionMethods(SimControlServer& control);
+
+private:
+  void        run();
+  std::size_t publishNext();
+
+  SimBlobServer&          m_server;
+  const SimFrameSequence& m_sequence;
+
+  // sending, serializes the continuous mode and step()
+  std::mutex                m_publishMutex;
+  std::vector<std::uint8_t> m_telegram;
+  std::size_t               m_nextIndex;
+  std::uint32_t             m_frameNumber;
+
+  std::atomic<std::uint64_t> m_frameCount;
+  std::atomic<std::uint64_t> m_droppedCount;
+
+  std::mutex                m_controlMutex; // serializes start() and stop()
+  mutable std::mutex        m_stateMutex;
+  std::condition_variable   m_stopCondition;
+  std::thread               m_thread;
+  bool                      m_stop;
+  double                    m_fps;
+  unsigned                  m_burstSize;
+  std::chrono::microseconds m_jitter;
+};
+
+} // namespace visionary
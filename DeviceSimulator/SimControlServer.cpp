@@ -0,0 +1,508 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "SimControlServer.h"
+
+#include <algorithm>
+
+#include "CoLaFrame.h"
+#include "CoLaLogin.h"
+#include "CoLaParameterWriter.h"
+
+namespace visionary {
+
+namespace {
+
+const std::uint32_t kPollMs = 100u;
+
+// SOPAS error codes used in sFA answers
+const std::uint16_t kErrorMethodAccessDenied        = 0x0001u;
+const std::uint16_t kErrorUnknownMethod             = 0x0002u;
+const std::uint16_t kErrorUnknownVariable           = 0x0003u;
+const std::uint16_t kErrorLocalCondition            = 0x0004u;
+const std::uint16_t kErrorVariableWriteAccessDenied = 0x000au;
+const std::uint16_t kErrorUnknownCommand            = 0x000cu;
+
+// challenge/response login
+const std::size_t  kChallengeSize      = 16u;
+const std::size_t  kSaltSize           = 16u;
+const std::uint8_t kLoginStatusOk      = 0u;
+const std::uint8_t kLoginStatusInvalid = 1u;
+
+std::vector<std::uint8_t> randomBytes(std::mt19937& rng, std::size_t size)
+{
+  std::vector<std::uint8_t> bytes(size);
+  for (std::uint8_t& byte : bytes)
+  {
+    byte = static_cast<std::uint8_t>(rng());
+  }
+  return bytes;
+}
+
+void makeAnswer(std::vector<std::uint8_t>&       response,
+                const char*                      code,
+                const std::string&               name,
+                const std::vector<std::uint8_t>& data)
+{
+  response.assign(code, code + 3);
+  response.push_back(' ');
+  response.insert(response.end(), name.begin(), name.end());
+  if (!data.empty())
+  {
+    response.push_back(' ');
+    response.insert(response.end(), data.begin(), data.end());
+  }
+}
+
+void makeError(std::vector<std::uint8_t>& response, std::uint16_t error)
+{
+  response.assign({'s', 'F', 'A', static_cast<std::uint8_t>(error >> 8u), static_cast<std::uint8_t>(error)});
+}
+
+} // namespace
+
+SimControlServer::SimControlServer(VisionaryControl::ProtocolType protocol)
+  : m_protocol(protocol), m_stop(true), m_commandCount(0u), m_loginCount(0u), m_nextSessionId(0x1000u)
+{
+  // passwords used by the samples
+  m_passwords[UserLevel::AUTHORIZED_CLIENT] = "CLIENT";
+  m_passwords[UserLevel::SERVICE]           = "CUST_SERV";
+}
+
+SimControlServer::~SimControlServer()
+{
+  stop();
+}
+
+bool SimControlServer::start(const std::string& address, std::uint16_t port)
+{
+  stop();
+  if (!m_listener.listen(address, (port != 0u) ? port : defaultCoLaPort(m_protocol)))
+  {
+    return false;
+  }
+  m_stop         = false;
+  m_commandCount = 0u;
+  m_loginCount   = 0u;
+  m_acceptThread = std::thread(&SimControlServer::acceptLoop, this);
+  return true;
+}
+
+void SimControlServer::stop()
+{
+  m_stop = true;
+  if (m_acceptThread.joinable())
+  {
+    m_acceptThread.join();
+  }
+  m_listener.close();
+
+  std::lock_guard<std::mutex> lock(m_clientsMutex);
+  for (auto& pClient : m_clients)
+  {
+    pClient->connection.shutdown();
+  }
+  for (auto& pClient : m_clients)
+  {
+    if (pClient->thread.joinable())
+    {
+      pClient->thread.join();
+    }
+  }
+  m_clients.clear();
+}
+
+std::uint16_t SimControlServer::getPort() const
+{
+  return m_listener.getPort();
+}
+
+VisionaryControl::ProtocolType SimControlServer::getProtocol() const
+{
+  return m_protocol;
+}
+
+void SimControlServer::setVariable(const std::string& name, const std::vector<std::uint8_t>& value)
+{
+  std::lock_guard<std::mutex> lock(m_tableMutex);
+  m_variables[name] = value;
+}
+
+bool SimControlServer::getVariable(const std::string& name, std::vector<std::uint8_t>& value) const
+{
+  std::lock_guard<std::mutex> lock(m_tableMutex);
+  const auto                  it = m_variables.find(name);
+  if (it == m_variables.end())
+  {
+    return false;
+  }
+  value = it->second;
+  return true;
+}
+
+void SimControlServer::setWriteLevel(const std::string& name, UserLevel level)
+{
+  std::lock_guard<std::mutex> lock(m_tableMutex);
+  m_writeLevels[name] = level;
+}
+
+void SimControlServer::setMethod(const std::string& name, MethodHandler handler, UserLevel level)
+{
+  std::lock_guard<std::mutex> lock(m_tableMutex);
+  m_methods[name]      = handler;
+  m_methodLevels[name] = level;
+}
+
+void SimControlServer::setPassword(UserLevel level, const std::string& password)
+{
+  std::lock_guard<std::mutex> lock(m_tableMutex);
+  m_passwords[level] = password;
+}
+
+void SimControlServer::setResponseDelay(std::chrono::microseconds delay, std::chrono::microseconds jitter)
+{
+  std::lock_guard<std::mutex> lock(m_tableMutex);
+  m_defaultDelay.delayUs  = delay.count();
+  m_defaultDelay.jitterUs = jitter.count();
+}
+
+void SimControlServer::setCommandDelay(const std::string&        name,
+                                       std::chrono::microseconds delay,
+                                       std::chrono::microseconds jitter)
+{
+  std::lock_guard<std::mutex> lock(m_tableMutex);
+  Delay&                      commandDelay = m_commandDelays[name];
+  commandDelay.delayUs                     = delay.count();
+  commandDelay.jitterUs                    = jitter.count();
+}
+
+std::uint64_t SimControlServer::getCommandCount() const
+{
+  return m_commandCount;
+}
+
+std::uint64_t SimControlServer::getLoginCount() const
+{
+  return m_loginCount;
+}
+
+std::size_t SimControlServer::getClientCount() const
+{
+  std::lock_guard<std::mutex> lock(m_clientsMutex);
+  return m_clients.size();
+}
+
+std::vector<std::uint8_t> SimControlServer::parametersOf(CoLaCommand command)
+{
+  const std::vector<std::uint8_t>& buffer = command.getBuffer();
+  const std::size_t                offset = command.getParameterOffset();
+  if (offset >= buffer.size())
+  {
+    return std::vector<std::uint8_t>();
+  }
+  return std::vector<std::uint8_t>(buffer.begin() + static_cast<std::ptrdiff_t>(offset), buffer.end());
+}
+
+void SimControlServer::acceptLoop()
+{
+  while (!m_stop)
+  {
+    reapClients();
+
+    std::unique_ptr<Client> pClient(new Client);
+    const int               ret = m_listener.accept(pClient->connection, kPollMs);
+    if (ret < 0)
+    {
+      break;
+    }
+    if (ret > 0)
+    {
+      std::lock_guard<std::mutex> lock(m_clientsMutex);
+      Client&                     client = *pClient;
+      m_clients.push_back(std::move(pClient));
+      client.thread = std::thread([this, &client]() {
+        clientLoop(client);
+        client.finished = true;
+      });
+    }
+  }
+}
+
+void SimControlServer::reapClients()
+{
+  std::lock_guard<std::mutex> lock(m_clientsMutex);
+  for (auto it = m_clients.begin(); it != m_clients.end();)
+  {
+    if ((*it)->finished)
+    {
+      (*it)->thread.join();
+      it = m_clients.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+void SimControlServer::clientLoop(Client& client)
+{
+  CoLaFrameDecoder          decoder(m_protocol);
+  std::vector<std::uint8_t> recvBuffer(4096u);
+  std::vector<std::uint8_t> response;
+  const std::uint32_t       sessionId = m_nextSessionId++;
+  client.rng.seed(sessionId);
+
+  while (!m_stop)
+  {
+    const int received = client.connection.recv(recvBuffer.data(), recvBuffer.size(), kPollMs);
+    if (received < 0)
+    {
+      break;
+    }
+    decoder.push(recvBuffer.data(), static_cast<std::size_t>(received));
+
+    CoLaFrame request;
+    while (decoder.pop(request))
+    {
+      handleTelegram(client, request.payload, response);
+
+      const std::chrono::microseconds delay = getDelay(getCoLaCommandName(request.payload), client.rng);
+      if (delay.count() > 0)
+      {
+        std::this_thread::sleep_for(delay);
+      }
+
+      CoLaFrame answer;
+      answer.sessionId = sessionId;
+      answer.requestId = request.requestId;
+      answer.payload.swap(response);
+      const std::vector<std::uint8_t> telegram = encodeCoLaFrame(m_protocol, answer);
+      if (!client.connection.send(telegram.data(), telegram.size()))
+      {
+        return;
+      }
+      ++m_commandCount;
+    }
+  }
+  client.connection.shutdown();
+}
+
+void SimControlServer::handleTelegram(Client&                          client,
+                                      const std::vector<std::uint8_t>& request,
+                                      std::vector<std::uint8_t>&       response)
+{
+  // CoLa 2 session handling
+  if ((request.size() >= 2u) && (request[0] == 'O') && (request[1] == 'x'))
+  {
+    response.assign({'O', 'A'});
+    return;
+  }
+  if ((request.size() >= 2u) && (request[0] == 'C') && (request[1] == 'x'))
+  {
+    response.assign({'C', 'A'});
+    return;
+  }
+
+  // the decoder restores the CoLa B form of CoLa 2 commands ("RN" -> "sRN"); a CoLa 2 command sent with an 's'
+  // ("ssRN" after decoding) falls through to "unknown command" like on a device
+  const std::string               code   = getCoLaCommandCode(request);
+  const std::string               name   = getCoLaCommandName(request);
+  const std::size_t               offset = getCoLaParameterOffset(request);
+  const std::vector<std::uint8_t> parameters(request.begin() + static_cast<std::ptrdiff_t>(offset), request.end());
+
+  if (code == "sRN")
+  {
+    std::vector<std::uint8_t> value;
+    if (getVariable(name, value))
+    {
+      makeAnswer(response, "sRA", name, value);
+    }
+    else
+    {
+      makeError(response, kErrorUnknownVariable);
+    }
+  }
+  else if (code == "sWN")
+  {
+    std::lock_guard<std::mutex> lock(m_tableMutex);
+    const auto                  it = m_variables.find(name);
+    if (it == m_variables.end())
+    {
+      makeError(response, kErrorUnknownVariable);
+    }
+    else if (!isAllowed(client, m_writeLevels, name))
+    {
+      makeError(response, kErrorVariableWriteAccessDenied);
+    }
+    else
+    {
+      it->second = parameters;
+      makeAnswer(response, "sWA", name, std::vector<std::uint8_t>());
+    }
+  }
+  else if (code == "sMN")
+  {
+    std::vector<std::uint8_t> result;
+    if (handleLogin(client, name, parameters, result))
+    {
+      makeAnswer(response, "sAN", name, result);
+      return;
+    }
+
+    MethodHandler handler;
+    bool          allowed = false;
+    {
+      std::lock_guard<std::mutex> lock(m_tableMutex);
+      const auto                  it = m_methods.find(name);
+      if (it != m_methods.end())
+      {
+        handler = it->second;
+        allowed = isAllowed(client, m_methodLevels, name);
+      }
+    }
+    if (!handler)
+    {
+      makeError(response, kErrorUnknownMethod);
+    }
+    else if (!allowed)
+    {
+      makeError(response, kErrorMethodAccessDenied);
+    }
+    else if (!handler(parameters, result))
+    {
+      makeError(response, kErrorLocalCondition);
+    }
+    else
+    {
+      makeAnswer(response, "sAN", name, result);
+    }
+  }
+  else
+  {
+    makeError(response, kErrorUnknownCommand);
+  }
+}
+
+bool SimControlServer::handleLogin(Client&                          client,
+                                   const std::string&               name,
+                                   const std::vector<std::uint8_t>& parameters,
+                                   std::vector<std::uint8_t>&       result)
+{
+  if (name == "Run")
+  {
+    client.userLevel = UserLevel::RUN;
+    result.assign(1u, 1u);
+    return true;
+  }
+
+  if (name == "SetAccessMode")
+  {
+    // SInt user level, UDInt password hash
+    bool ok = false;
+    if (parameters.size() >= 5u)
+    {
+      const UserLevel level = static_cast<UserLevel>(static_cast<std::int8_t>(parameters[0]));
+      std::string     password;
+      {
+        std::lock_guard<std::mutex> lock(m_tableMutex);
+        const auto                  it = m_passwords.find(level);
+        ok                             = (it != m_passwords.end());
+        if (ok)
+        {
+          password = it->second;
+        }
+      }
+      const std::vector<std::uint8_t> expected = parametersOf(
+        CoLaParameterWriter(CoLaCommandType::METHOD_INVOCATION, name.c_str()).parameterPasswordMD5(password).build());
+      ok = ok && std::equal(expected.begin(), expected.end(), parameters.begin() + 1);
+      if (ok)
+      {
+        client.userLevel = level;
+        ++m_loginCount;
+      }
+    }
+    result.assign(1u, ok ? 1u : 0u);
+    return true;
+  }
+
+  if (name == "GetChallenge")
+  {
+    // USInt user level; answer: USInt status, 16 bytes challenge, 16 bytes salt
+    client.challenge.clear();
+    bool hasPassword = false;
+    if (!parameters.empty())
+    {
+      client.challengeLevel = static_cast<UserLevel>(parameters[0]);
+      std::lock_guard<std::mutex> lock(m_tableMutex);
+      hasPassword = (m_passwords.find(client.challengeLevel) != m_passwords.end());
+    }
+    if (!hasPassword)
+    {
+      result.assign(1u, kLoginStatusInvalid);
+      return true;
+    }
+    client.challenge = randomBytes(client.rng, kChallengeSize);
+    client.salt      = randomBytes(client.rng, kSaltSize);
+    result.assign(1u, kLoginStatusOk);
+    result.insert(result.end(), client.challenge.begin(), client.challenge.end());
+    result.insert(result.end(), client.salt.begin(), client.salt.end());
+    return true;
+  }
+
+  if (name == "SetUserLevel")
+  {
+    // 32 bytes challenge response, USInt user level; answer: USInt status
+    bool ok = !client.challenge.empty() && (parameters.size() >= 33u)
+              && (static_cast<UserLevel>(parameters[32]) == client.challengeLevel);
+    if (ok)
+    {
+      std::string password;
+      {
+        std::lock_guard<std::mutex> lock(m_tableMutex);
+        password = m_passwords[client.challengeLevel];
+      }
+      const Sha256Digest expected =
+        computeCoLaChallengeResponse(client.challengeLevel, password, client.salt, client.challenge);
+      ok = std::equal(expected.begin(), expected.end(), parameters.begin());
+    }
+    if (ok)
+    {
+      client.userLevel = client.challengeLevel;
+      ++m_loginCount;
+    }
+    client.challenge.clear();
+    result.assign(1u, ok ? kLoginStatusOk : kLoginStatusInvalid);
+    return true;
+  }
+
+  return false;
+}
+
+bool SimControlServer::isAllowed(const Client&                           client,
+                                 const std::map<std::string, UserLevel>& levels,
+                                 const std::string&                      name) const
+{
+  const auto it = levels.find(name);
+  return (it == levels.end()) || (static_cast<int>(client.userLevel) >= static_cast<int>(it->second));
+}
+
+std::chrono::microseconds SimControlServer::getDelay(const std::string& name, std::mt19937& rng) const
+{
+  Delay delay;
+  {
+    std::lock_guard<std::mutex> lock(m_tableMutex);
+    const auto                  it = m_commandDelays.find(name);
+    delay                          = (it != m_commandDelays.end()) ? it->second : m_defaultDelay;
+  }
+  std::int64_t delayUs = delay.delayUs;
+  if (delay.jitterUs > 0)
+  {
+    delayUs += std::uniform_int_distribution<std::int64_t>(0, delay.jitterUs)(rng);
+  }
+  return std::chrono::microseconds(delayUs);
+}
+
+} // namespace visionary
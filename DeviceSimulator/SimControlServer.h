@@ -0,0 +1,176 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CoLaCommand.h"
+#include "IAuthentication.h"
+#include "TcpConnection.h"
+#include "VisionaryControl.h"
+
+namespace visionary {
+
+/// Control channel of a simulated device
+///
+/// Answers CoLa B or CoLa 2 telegrams from a variable table and registered method handlers, so VisionaryControl
+/// and the helpers in base/ can be exercised without hardware. The login methods of the devices are built in:
+/// - SetAccessMode (user level and MD5 password hash, as sent by VisionaryControl for CoLa B devices)
+/// - GetChallenge/SetUserLevel (challenge/response login of CoLa 2 devices, see computeCoLaChallengeResponse())
+/// - Run (logout)
+/// The user level is kept per connection; writing a variable or invoking a method below the level set with
+/// setWriteLevel()/setMethod() is answered with "access denied".
+///
+/// CoLa 2 is spoken as by a real device: the command modes have two letters on the wire ("RN", "WN", "MN" and the
+/// answers "RA", "WA", "AN", "FA"). A CoLa 2 command sent with the 's' of CoLa B ("sRN") is unknown to the device and
+/// answered with an error, so clients framing CoLa 2 wrongly fail against the simulator as well.
+///
+/// Every client connection is served by its own thread, plus one accept thread per server, so a few hundred
+/// simulated devices (each on its own loopback address, see loadSimDeviceProfile()) can run on one host.
+class SimControlServer
+{
+public:
+  typedef IAuthentication::UserLevel UserLevel;
+
+  /// Handler of a method invocation
+  ///
+  /// \param[in]  parameters binary parameters of the invocation
+  /// \param[out] result     binary return value
+  ///
+  /// \return false to answer with a CoLa error
+  typedef std::function<bool(const std::vector<std::uint8_t>& parameters, std::vector<std::uint8_t>& result)>
+    MethodHandler;
+
+  explicit SimControlServer(VisionaryControl::ProtocolType protocol);
+  ~SimControlServer();
+
+  SimControlServer(const SimControlServer&)            = delete;
+  SimControlServer& operator=(const SimControlServer&) = delete;
+
+  /// Starts listening
+  ///
+  /// \param[in] address local address, e.g. "127.0.0.1"
+  /// \param[in] port    local port; 0 selects the default port of the protocol
+  bool start(const std::string& address, std::uint16_t port = 0u);
+
+  /// Closes all connections and stops the server threads
+  void stop();
+
+  std::uint16_t getPort() const;
+
+  VisionaryControl::ProtocolType getProtocol() const;
+
+  /// Sets the binary value of a variable (as transported in the read response)
+  void setVariable(const std::string& name, const std::vector<std::uint8_t>& value);
+
+  /// Gets the binary value of a variable
+  ///
+  /// \return false if the variable does not exist
+  bool getVariable(const std::string& name, std::vector<std::uint8_t>& value) const;
+
+  /// Minimum user level to write a variable (default RUN, i.e. no login needed)
+  void setWriteLevel(const std::string& name, UserLevel level);
+
+  /// Registers the handler for a method
+  ///
+  /// \param[in] name    method name
+  /// \param[in] handler called from the connection thread
+  /// \param[in] level   minimum user level to invoke the method
+  void setMethod(const std::string& name, MethodHandler handler, UserLevel level = UserLevel::RUN);
+
+  /// Sets the password of a user level; levels without password can't be logged in to
+  void setPassword(UserLevel level, const std::string& password);
+
+  /// Simulated processing time of the device, added before every response
+  ///
+  /// \param[in] delay  fixed part
+  /// \param[in] jitter maximum of a uniformly distributed random part
+  void setResponseDelay(std::chrono::microseconds delay,
+                        std::chrono::microseconds jitter = std::chrono::microseconds(0));
+
+  /// Processing time of the commands on one variable or method, replaces the delay set by setResponseDelay()
+  void setCommandDelay(const std::string&        name,
+                       std::chrono::microseconds delay,
+                       std::chrono::microseconds jitter = std::chrono::microseconds(0));
+
+  /// Number of telegrams answered since start
+  std::uint64_t getCommandCount() const;
+
+  /// Number of successful logins since start
+  std::uint64_t getLoginCount() const;
+
+  /// Number of connected clients; disconnected ones are dropped within the accept poll interval
+  std::size_t getClientCount() const;
+
+  /// Extracts the binary parameters of a command, e.g. to fill the variable table using CoLaParameterWriter:
+  /// setVariable("x", parametersOf(CoLaParameterWriter(CoLaCommandType::READ_VARIABLE, "x").parameterUDInt(1).build()))
+  static std::vector<std::uint8_t> parametersOf(CoLaCommand command);
+
+private:
+  struct Delay
+  {
+    std::int64_t delayUs  = 0;
+    std::int64_t jitterUs = 0;
+  };
+
+  struct Client
+  {
+    TcpConnection     connection;
+    std::thread       thread;
+    std::atomic<bool> finished{false}; // the thread has ended and can be joined
+
+    // login state of the connection, owned by its thread
+    UserLevel                 userLevel      = UserLevel::RUN;
+    UserLevel                 challengeLevel = UserLevel::RUN;
+    std::vector<std::uint8_t> challenge; // empty if no challenge is pending
+    std::vector<std::uint8_t> salt;
+    std::mt19937              rng;
+  };
+
+  void acceptLoop();
+  void reapClients();
+  void clientLoop(Client& client);
+  void handleTelegram(Client& client, const std::vector<std::uint8_t>& request, std::vector<std::uint8_t>& response);
+  bool handleLogin(Client&                          client,
+                   const std::string&               name,
+                   const std::vector<std::uint8_t>& parameters,
+                   std::vector<std::uint8_t>&       result);
+  bool isAllowed(const Client& client, const std::map<std::string, UserLevel>& levels, const std::string& name) const;
+  std::chrono::microseconds getDelay(const std::string& name, std::mt19937& rng) const;
+
+  const VisionaryControl::ProtocolType m_protocol;
+  TcpListener                          m_listener;
+  std::thread                          m_acceptThread;
+  std::atomic<bool>                    m_stop;
+  std::atomic<std::uint64_t>           m_commandCount;
+  std::atomic<std::uint64_t>           m_loginCount;
+  std::atomic<std::uint32_t>           m_nextSessionId;
+
+  mutable std::mutex                 m_clientsMutex;
+  std::list<std::unique_ptr<Client>> m_clients;
+
+  mutable std::mutex                               m_tableMutex;
+  std::map<std::string, std::vector<std::uint8_t>> m_variables;
+  std::map<std::string, UserLevel>                 m_writeLevels;
+  std::map<std::string, MethodHandler>             m_methods;
+  std::map<std::string, UserLevel>                 m_methodLevels;
+  std::map<UserLevel, std::string>                 m_passwords;
+  Delay                                            m_defaultDelay;
+  std::map<std::string, Delay>                     m_commandDelays;
+};
+
+} // namespace visionary
@@ -0,0 +1,134 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "SimDeviceProfile.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "CoLaParameterWriter.h"
+#include "MSinfoDecoder.h"
+
+namespace visionary {
+
+namespace {
+
+// number of IOs reported by IOValue (one SInt each)
+const unsigned kNumIOs = 6u;
+
+CoLaParameterWriter valueWriter()
+{
+  return CoLaParameterWriter(CoLaCommandType::READ_VARIABLE, "value");
+}
+
+void setConfigVariable(SimControlServer& server, const char* name, CoLaCommand value)
+{
+  server.setVariable(name, SimControlServer::parametersOf(value));
+  server.setWriteLevel(name, IAuthentication::UserLevel::AUTHORIZED_CLIENT);
+}
+
+std::vector<std::uint8_t> makeMSinfo()
+{
+  // no messages pending: all entries zero with empty extInfo
+  CoLaParameterWriter writer = valueWriter();
+  for (std::size_t i = 0u; i < MSinfo::kNumMessages; ++i)
+  {
+    writer.parameterUDInt(0u).parameterUDInt(0u);
+    for (unsigned time = 0u; time < 2u; ++time)
+    {
+      writer.parameterUInt(0u).parameterUDInt(0u).parameterUDInt(0u);
+    }
+    writer.parameterUInt(0u).parameterUInt(0u).parameterFlexString("");
+  }
+  return SimControlServer::parametersOf(writer.build());
+}
+
+bool succeed(const std::vector<std::uint8_t>&, std::vector<std::uint8_t>& result)
+{
+  result.clear();
+  return true;
+}
+
+} // namespace
+
+VisionaryControl::ProtocolType getSimDeviceProtocol(SimDeviceType type)
+{
+  return (type == SimDeviceType::VISIONARY_S) ? VisionaryControl::ProtocolType::COLA_B
+                                              : VisionaryControl::ProtocolType::COLA_2;
+}
+
+std::uint32_t getSimDeviceFramePeriodUs(SimDeviceType type)
+{
+  return (type == SimDeviceType::VISIONARY_S) ? 150000u : 33333u;
+}
+
+void loadSimDeviceProfile(SimControlServer& server, SimDeviceType type, const std::string& deviceName)
+{
+  const bool        isS         = (type == SimDeviceType::VISIONARY_S);
+  const std::string defaultName = isS ? "Visionary-S CX (simulated)" : "Visionary-T Mini CX (simulated)";
+  const std::string name        = !deviceName.empty() ? deviceName : defaultName;
+
+  server.setVariable("DeviceIdent",
+                     SimControlServer::parametersOf(
+                       valueWriter().parameterFlexString(name).parameterFlexString("0.0.0").build()));
+  server.setVariable("MSinfo", makeMSinfo());
+  for (const char* method : {"PLAYSTART", "PLAYSTOP", "PLAYNEXT"})
+  {
+    server.setMethod(method, succeed);
+  }
+
+  setConfigVariable(server, "framePeriodTime", valueWriter().parameterUDInt(getSimDeviceFramePeriodUs(type)).build());
+
+  if (isS)
+  {
+    setConfigVariable(server, "acquisitionModeStereo", valueWriter().parameterUSInt(0u).build());
+    setConfigVariable(server, "integrationTimeUs", valueWriter().parameterUDInt(1000u).build());
+    setConfigVariable(server, "integrationTimeUsColor", valueWriter().parameterUDInt(1000u).build());
+    // left, right, top, bottom
+    const CoLaCommand fullImage =
+      valueWriter().parameterUDInt(0u).parameterUDInt(639u).parameterUDInt(0u).parameterUDInt(511u).build();
+    for (const char* roi : {"autoExposureROI", "autoExposureColorROI", "autoWhiteBalanceROI"})
+    {
+      setConfigVariable(server, roi, fullImage);
+    }
+    server.setVariable("autoExposureParameterizedRunning",
+                       SimControlServer::parametersOf(valueWriter().parameterBool(false).build()));
+    server.setMethod(
+      "TriggerAutoExposureParameterized",
+      [](const std::vector<std::uint8_t>&, std::vector<std::uint8_t>& result) {
+        result.assign(1u, 1u);
+        return true;
+      },
+      IAuthentication::UserLevel::AUTHORIZED_CLIENT);
+  }
+  else
+  {
+    server.setVariable("humidity", SimControlServer::parametersOf(valueWriter().parameterLReal(0.42).build()));
+    setConfigVariable(server, "enDepthMask", valueWriter().parameterBool(true).build());
+    setConfigVariable(server, "frontendMode", valueWriter().parameterUSInt(0u).build());
+    setConfigVariable(server, "DIO1Fnc", valueWriter().parameterUSInt(0u).build());
+    setConfigVariable(server, "DIO2Fnc", valueWriter().parameterUSInt(0u).build());
+    server.setVariable("IOValue", std::vector<std::uint8_t>(kNumIOs, 0u));
+  }
+}
+
+std::string getSimDeviceAddress(const std::string& firstAddress, unsigned index)
+{
+  unsigned  octets[4];
+  char      rest   = '\0';
+  const int fields =
+    std::sscanf(firstAddress.c_str(), "%u.%u.%u.%u%c", &octets[0], &octets[1], &octets[2], &octets[3], &rest);
+  if ((fields != 4) || (octets[0] > 255u) || (octets[1] > 255u) || (octets[2] > 255u) || (octets[3] > 255u))
+  {
+    return std::string();
+  }
+  std::uint32_t address = (octets[0] << 24u) | (octets[1] << 16u) | (octets[2] << 8u) | octets[3];
+  address += index;
+  return std::to_string(address >> 24u) + '.' + std::to_string((address >> 16u) & 0xffu) + '.'
+         + std::to_string((address >> 8u) & 0xffu) + '.' + std::to_string(address & 0xffu);
+}
+
+} // namespace visionary
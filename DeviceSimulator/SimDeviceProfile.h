@@ -0,0 +1,47 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "SimControlServer.h"
+
+namespace visionary {
+
+/// Device types the simulator can impersonate
+enum class SimDeviceType
+{
+  VISIONARY_S,     ///< CoLa B, variables of SampleVisionaryS
+  VISIONARY_T_MINI ///< CoLa 2, variables of SampleVisionaryTMini
+};
+
+/// Protocol the device type speaks on its control port
+VisionaryControl::ProtocolType getSimDeviceProtocol(SimDeviceType type);
+
+/// Default frame period (framePeriodTime) of the device type in microseconds
+std::uint32_t getSimDeviceFramePeriodUs(SimDeviceType type);
+
+/// Fills the variable table and methods of a simulated device with the ones the samples use
+///
+/// Besides DeviceIdent, MSinfo and the acquisition methods (PLAYSTART, PLAYSTOP, PLAYNEXT) these are the
+/// configuration variables of the device type (e.g. framePeriodTime, humidity, IOValue). As on the real devices,
+/// the configuration variables can only be written after logging in as AUTHORIZED_CLIENT.
+///
+/// \param[in] server     control channel of the simulated device
+/// \param[in] type       device type
+/// \param[in] deviceName name reported in DeviceIdent
+void loadSimDeviceProfile(SimControlServer& server, SimDeviceType type, const std::string& deviceName = "");
+
+/// Address of the index-th simulated device when every device gets its own loopback address
+///
+/// \param[in] firstAddress IPv4 address of the first device, e.g. "127.0.0.10"
+/// \param[in] index        device index; the host part of the address is incremented (across octets)
+///
+/// \return the address, empty if firstAddress is not a valid IPv4 address
+std::string getSimDeviceAddress(const std::string& firstAddress, unsigned index);
+
+} // namespace visionary
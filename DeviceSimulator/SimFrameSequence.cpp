@@ -0,0 +1,150 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "SimFrameSequence.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+namespace visionary {
+
+namespace {
+
+const std::uint32_t kTelegramMagic  = 0x02020202u;
+const std::size_t   kHeaderSize     = 4u + 4u; // magic and package length
+const std::uint8_t  kPacketTypeBlob = 0x62u;
+
+std::uint32_t getBigEndian32(const std::uint8_t* pSrc)
+{
+  return (static_cast<std::uint32_t>(pSrc[0]) << 24u) | (static_cast<std::uint32_t>(pSrc[1]) << 16u)
+         | (static_cast<std::uint32_t>(pSrc[2]) << 8u) | static_cast<std::uint32_t>(pSrc[3]);
+}
+
+void renderFrame(BlobEncoder::DeviceType deviceType,
+                 std::uint16_t           width,
+                 std::uint16_t           height,
+                 std::size_t             index,
+                 std::size_t             numFrames,
+                 SimFrame&               frame)
+{
+  const bool        isS       = (deviceType == BlobEncoder::DeviceType::VISIONARY_S);
+  const std::size_t boxWidth  = std::max<std::size_t>(width / 4u, 1u);
+  const std::size_t boxLeft   = (width - boxWidth) * index / numFrames;
+  const std::size_t boxTop    = height / 4u;
+  const std::size_t boxBottom = height - boxTop;
+
+  std::size_t pixel = 0u;
+  for (std::size_t y = 0u; y < height; ++y)
+  {
+    // the floor comes closer towards the bottom rows
+    const std::uint16_t floorDistance = static_cast<std::uint16_t>(3000u - 1500u * y / height);
+    for (std::size_t x = 0u; x < width; ++x, ++pixel)
+    {
+      const bool          inBox     = (x >= boxLeft) && (x < boxLeft + boxWidth) && (y >= boxTop) && (y < boxBottom);
+      const std::uint16_t distance  = inBox ? 1200u : floorDistance;
+      const std::uint16_t intensity = static_cast<std::uint16_t>(inBox ? 1800u : 400u + ((x ^ y) & 63u));
+
+      frame.distance[pixel] = distance;
+      if (isS)
+      {
+        const std::uint32_t gray = std::min<std::uint32_t>(intensity / 8u, 255u);
+        frame.rgba[pixel]        = gray | (gray << 8u) | (gray << 16u) | 0xff000000u;
+        frame.state[pixel]       = 0xffffu; // full confidence
+      }
+      else
+      {
+        frame.intensity[pixel] = intensity;
+        frame.state[pixel]     = 0u; // valid
+      }
+    }
+  }
+}
+
+} // namespace
+
+void SimFrameSequence::generate(BlobEncoder::DeviceType deviceType,
+                                std::uint16_t           width,
+                                std::uint16_t           height,
+                                std::size_t             numFrames)
+{
+  const BlobEncoder encoder(deviceType, width, height);
+  SimFrame          frame;
+  encoder.prepareFrame(frame);
+
+  m_telegrams.reserve(m_telegrams.size() + numFrames);
+  for (std::size_t i = 0u; i < numFrames; ++i)
+  {
+    renderFrame(deviceType, width, height, i, numFrames, frame);
+    frame.frameNumber = static_cast<std::uint32_t>(i + 1u);
+    add(encoder, frame);
+  }
+}
+
+void SimFrameSequence::add(const BlobEncoder& encoder, const SimFrame& frame)
+{
+  std::vector<std::uint8_t> telegram;
+  encoder.encode(frame, telegram);
+  m_telegrams.push_back(std::move(telegram));
+}
+
+void SimFrameSequence::add(std::vector<std::uint8_t> telegram)
+{
+  m_telegrams.push_back(std::move(telegram));
+}
+
+bool SimFrameSequence::load(const std::string& filename)
+{
+  std::ifstream file(filename.c_str(), std::ios::binary);
+  if (!file)
+  {
+    return false;
+  }
+  const std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+  const std::size_t numBefore = m_telegrams.size();
+  std::size_t       offset    = 0u;
+  while (offset + kHeaderSize < data.size())
+  {
+    const std::uint8_t* pHeader = data.data() + offset;
+    const std::size_t   length  = getBigEndian32(pHeader + 4u);
+    if ((getBigEndian32(pHeader) != kTelegramMagic) || (offset + kHeaderSize + length > data.size()) || (length < 3u))
+    {
+      // not at a telegram start, resynchronize on the next byte
+      ++offset;
+      continue;
+    }
+    // skip telegrams other than BLOB data (package type after the protocol version)
+    if (pHeader[kHeaderSize + 2u] == kPacketTypeBlob)
+    {
+      m_telegrams.emplace_back(pHeader, pHeader + kHeaderSize + length);
+    }
+    offset += kHeaderSize + length;
+  }
+  return m_telegrams.size() > numBefore;
+}
+
+void SimFrameSequence::clear()
+{
+  m_telegrams.clear();
+}
+
+std::size_t SimFrameSequence::size() const
+{
+  return m_telegrams.size();
+}
+
+bool SimFrameSequence::empty() const
+{
+  return m_telegrams.empty();
+}
+
+const std::vector<std::uint8_t>& SimFrameSequence::getTelegram(std::size_t index) const
+{
+  return m_telegrams[index];
+}
+
+} // namespace visionary
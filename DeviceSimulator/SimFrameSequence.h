@@ -0,0 +1,61 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "BlobEncoder.h"
+
+namespace visionary {
+
+/// Pre-encoded data stream telegrams a simulated camera sends in a loop (see SimCameraStream)
+///
+/// The telegrams are encoded once, the stream only replaces frame number and timestamp before sending
+/// (BlobEncoder::restamp()), so that generating frames costs no more than copying them. A sequence is never modified
+/// while streaming and can be shared by any number of streams.
+class SimFrameSequence
+{
+public:
+  /// Fills the sequence with a synthetic scene: a tilted floor and a box moving across the image once per sequence
+  ///
+  /// \param[in] deviceType data format of the telegrams
+  /// \param[in] width      map width in pixels
+  /// \param[in] height     map height in pixels
+  /// \param[in] numFrames  number of distinct frames; the memory needed grows linearly with it
+  void generate(BlobEncoder::DeviceType deviceType, std::uint16_t width, std::uint16_t height, std::size_t numFrames);
+
+  /// Appends a frame
+  void add(const BlobEncoder& encoder, const SimFrame& frame);
+
+  /// Appends a complete telegram as sent on the data stream port
+  void add(std::vector<std::uint8_t> telegram);
+
+  /// Loads a recording of a real device for replay
+  ///
+  /// The file holds the raw bytes received from the data stream port (2114), e.g. recorded with
+  /// "nc <device ip> 2114 > recording.bin". Bytes not belonging to a complete BLOB telegram, e.g. a telegram cut at
+  /// the start or end of the recording, are skipped.
+  ///
+  /// \retval true  at least one telegram was loaded (appended to the sequence)
+  /// \retval false the file could not be read or holds no complete BLOB telegram
+  bool load(const std::string& filename);
+
+  void clear();
+
+  std::size_t size() const;
+  bool        empty() const;
+
+  /// index-th telegram; index must be less than size()
+  const std::vector<std::uint8_t>& getTelegram(std::size_t index) const;
+
+private:
+  std::vector<std::vector<std::uint8_t>> m_telegrams;
+};
+
+} // namespace visionary
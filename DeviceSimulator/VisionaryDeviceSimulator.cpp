@@ -0,0 +1,251 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+// Runs simulated Visionary devices until ENTER is pressed, e.g. as backend for the samples and benchmarks.
+// Every device listens on its own loopback address (127.0.0.10, 127.0.0.11, ... by default) on the default
+// control port of its protocol, since VisionaryControl always connects to the default port, and on the data
+// stream port 2114. The devices stream a synthetic scene or a recording of a real device (all devices the same
+// frames) after PLAYSTART, or right from the start with -s.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "SimBlobServer.h"
+#include "SimCameraStream.h"
+#include "SimControlServer.h"
+#include "SimDeviceProfile.h"
+#include "SimFrameSequence.h"
+#include "TcpConnection.h"
+
+using namespace visionary;
+
+namespace {
+
+// members in reverse shutdown order: the control channel may start the stream, the stream publishes to blob
+struct SimDevice
+{
+  SimBlobServer                    blob;
+  std::unique_ptr<SimCameraStream> pStream;
+  SimControlServer                 control;
+
+  explicit SimDevice(SimDeviceType type) : control(getSimDeviceProtocol(type))
+  {
+  }
+};
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  unsigned    numDevices      = 1u;
+  std::string deviceType      = "tmini";
+  std::string firstAddress    = "127.0.0.10";
+  unsigned    responseDelayUs = 0u;
+  unsigned    jitterUs        = 0u;
+  double      fps             = 0.0;
+  unsigned    width           = 0u;
+  unsigned    height          = 0u;
+  unsigned    burstSize       = 1u;
+  unsigned    frameJitterUs   = 0u;
+  unsigned    numFrames       = 30u;
+  std::string recording;
+  bool        streamAtStart   = false;
+
+  bool showHelpAndExit = false;
+  int  exitCode        = 0;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::istringstream argstream(argv[i]);
+
+    if (argstream.get() != '-')
+    {
+      showHelpAndExit = true;
+      exitCode        = 1;
+      break;
+    }
+    switch (argstream.get())
+    {
+      case 'h':
+        showHelpAndExit = true;
+        break;
+      case 'n':
+        argstream >> numDevices;
+        break;
+      case 't':
+        argstream >> deviceType;
+        break;
+      case 'a':
+        argstream >> firstAddress;
+        break;
+      case 'd':
+        argstream >> responseDelayUs;
+        break;
+      case 'j':
+        argstream >> jitterUs;
+        break;
+      case 'f':
+        argstream >> fps;
+        break;
+      case 'r':
+      {
+        char separator = '\0';
+        argstream >> width >> separator >> height;
+        if (separator != 'x')
+        {
+          width = 0u;
+        }
+        break;
+      }
+      case 'b':
+        argstream >> burstSize;
+        break;
+      case 'w':
+        argstream >> frameJitterUs;
+        break;
+      case 'l':
+        argstream >> numFrames;
+        break;
+      case 'p':
+        argstream >> recording;
+        break;
+      case 's':
+        streamAtStart = true;
+        break;
+      default:
+        showHelpAndExit = true;
+        exitCode        = 1;
+        break;
+    }
+  }
+
+  if ((numDevices == 0u) || ((deviceType != "s") && (deviceType != "tmini"))
+      || getSimDeviceAddress(firstAddress, 0u).empty() || (fps < 0.0) || (burstSize == 0u) || (numFrames == 0u)
+      || ((width != 0u) && ((width > 0xffffu) || (height == 0u) || (height > 0xffffu))))
+  {
+    showHelpAndExit = true;
+    exitCode        = 1;
+  }
+
+  if (showHelpAndExit)
+  {
+    std::cout << argv[0] << " [option]*" << std::endl;
+    std::cout << "where option is one of" << std::endl;
+    std::cout << "-h          show this help and exit" << std::endl;
+    std::cout << "-n<cnt>     number of simulated devices; default is 1" << std::endl;
+    std::cout << "-t<type>    device type: s (Visionary-S, CoLa B) or tmini (Visionary-T Mini, CoLa 2);" << std::endl;
+    std::cout << "            default is tmini" << std::endl;
+    std::cout << "-a<ip>      address of the first device, the following devices use the next addresses;" << std::endl;
+    std::cout << "            default is 127.0.0.10" << std::endl;
+    std::cout << "-d<us>      simulated processing time per control command; default is 0" << std::endl;
+    std::cout << "-j<us>      additional random processing time per command (0..jitter); default is 0" << std::endl;
+    std::cout << "-f<fps>     frame rate; default is the one of framePeriodTime" << std::endl;
+    std::cout << "-r<w>x<h>   resolution of the synthetic frames; default is 640x512 (s) or 512x424 (tmini)"
+              << std::endl;
+    std::cout << "-b<cnt>     frames sent back to back in bursts (at the same average rate); default is 1" << std::endl;
+    std::cout << "-w<us>      random delay of every burst (0..jitter); default is 0" << std::endl;
+    std::cout << "-l<cnt>     number of distinct synthetic frames; default is 30" << std::endl;
+    std::cout << "-p<file>    replay the data stream recording file (raw bytes from port 2114) instead" << std::endl;
+    std::cout << "-s          stream from the start, not only after PLAYSTART" << std::endl;
+    std::cout << "Passwords: AUTHORIZED_CLIENT \"CLIENT\", SERVICE \"CUST_SERV\"." << std::endl;
+    return exitCode;
+  }
+
+  TcpConnection::initSocketLibrary();
+
+  const SimDeviceType type = (deviceType == "s") ? SimDeviceType::VISIONARY_S : SimDeviceType::VISIONARY_T_MINI;
+  const bool          isS  = (type == SimDeviceType::VISIONARY_S);
+
+  SimFrameSequence sequence;
+  if (!recording.empty())
+  {
+    if (!sequence.load(recording))
+    {
+      std::printf("Failed to load BLOB telegrams from %s\n", recording.c_str());
+      return 1;
+    }
+  }
+  else
+  {
+    const BlobEncoder::DeviceType encoderType =
+      isS ? BlobEncoder::DeviceType::VISIONARY_S : BlobEncoder::DeviceType::VISIONARY_T_MINI;
+    if (width == 0u)
+    {
+      width  = isS ? 640u : 512u;
+      height = isS ? 512u : 424u;
+    }
+    sequence.generate(encoderType, static_cast<std::uint16_t>(width), static_cast<std::uint16_t>(height), numFrames);
+  }
+  if (fps <= 0.0)
+  {
+    fps = 1e6 / getSimDeviceFramePeriodUs(type);
+  }
+
+  std::vector<std::unique_ptr<SimDevice>> devices;
+  for (unsigned i = 0u; i < numDevices; ++i)
+  {
+    const std::string          address = getSimDeviceAddress(firstAddress, i);
+    std::unique_ptr<SimDevice> pDevice(new SimDevice(type));
+    loadSimDeviceProfile(pDevice->control, type, "simulated device " + std::to_string(i));
+    pDevice->control.setResponseDelay(std::chrono::microseconds(responseDelayUs),
+                                      std::chrono::microseconds(jitterUs));
+
+    pDevice->pStream.reset(new SimCameraStream(pDevice->blob, sequence));
+    pDevice->pStream->setFrameRate(fps);
+    pDevice->pStream->setBurstSize(burstSize);
+    pDevice->pStream->setJitter(std::chrono::microseconds(frameJitterUs));
+    pDevice->pStream->bindAcquisitionMethods(pDevice->control);
+
+    if (!pDevice->control.start(address) || !pDevice->blob.start(address))
+    {
+      std::printf("Failed to start the simulated device on %s (port in use?)\n", address.c_str());
+      return 1;
+    }
+    if (streamAtStart)
+    {
+      pDevice->pStream->start();
+    }
+    devices.push_back(std::move(pDevice));
+  }
+
+  std::printf("%u simulated devices on %s..%s, control port %u, data stream port %u, %zu distinct frames at %.2f fps."
+              " Press ENTER to stop.\n",
+              numDevices,
+              firstAddress.c_str(),
+              getSimDeviceAddress(firstAddress, numDevices - 1u).c_str(),
+              static_cast<unsigned>(devices.front()->control.getPort()),
+              static_cast<unsigned>(devices.front()->blob.getPort()),
+              sequence.size(),
+              fps);
+  std::cin.get();
+
+  std::uint64_t commands = 0u;
+  std::uint64_t logins   = 0u;
+  std::uint64_t frames   = 0u;
+  std::uint64_t dropped  = 0u;
+  for (const std::unique_ptr<SimDevice>& pDevice : devices)
+  {
+    // stop the control channel first, so that PLAYSTART can't restart the stream
+    pDevice->control.stop();
+    pDevice->pStream->stop();
+    pDevice->blob.stop();
+    commands += pDevice->control.getCommandCount();
+    logins += pDevice->control.getLoginCount();
+    frames += pDevice->pStream->getFrameCount();
+    dropped += pDevice->pStream->getDroppedCount();
+  }
+  std::printf("answered %llu commands, %llu logins; sent %llu frames, dropped %llu\n",
+              static_cast<unsigned long long>(commands),
+              static_cast<unsigned long long>(logins),
+              static_cast<unsigned long long>(frames),
+              static_cast<unsigned long long>(dropped));
+  return 0;
+}
@@ -11,14 +11,19 @@
 #include <sstream>
 
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 
+#include "CoLaEventChannel.h"
 #include "CoLaParameterReader.h"
 #include "CoLaParameterWriter.h"
+#include "FrameStreamSync.h"
+#include "MSinfoDecoder.h"
 #include "PointCloudPlyWriter.h"
 #include "PointXYZ.h"
+#include "TracedDataStream.h"
 #include "VisionaryControl.h"
-#include "VisionaryDataStream.h"
 #include "VisionarySData.h" // Header specific for the Stereo data
 
 // helper class, stores an exit code
@@ -61,9 +66,9 @@ static int runStreamingDemo(const std::string& ipAddress, unsigned short dataPor
   ExitCode exitcode;
 
   // Generate Visionary instance
-  auto                pDataHandler = std::make_shared<VisionarySData>();
-  VisionaryDataStream dataStream(pDataHandler);
-  VisionaryControl    visionaryControl;
+  auto             pDataHandler = std::make_shared<VisionarySData>();
+  TracedDataStream dataStream(pDataHandler);
+  VisionaryControl visionaryControl;
 
   //-----------------------------------------------
   // Connect to devices control channel
@@ -199,6 +204,30 @@ static int runStreamingDemo(const std::string& ipAddress, unsigned short dataPor
     /* Info: For White Balance exists no SOPAS variable; the changes are done internally in the device and applied to
        the image. If you open SOPAS and you are running this sample in parallel you can see how the image changes. */
 
+    // Register for change notifications of 'autoExposureParameterizedRunning'.
+    // The device then reports the end of the auto exposure on the event channel and we don't have to poll the
+    // variable. The event channel is a second control connection which receives the notifications in the
+    // background. If the device does not support the notification we fall back to polling.
+    std::mutex              autoExpMutex;
+    std::condition_variable autoExpCondition;
+    bool                    autoExpParamRunning = false;
+
+    CoLaEventChannel eventChannel;
+    const bool       eventsAvailable =
+      eventChannel.open(VisionaryControl::ProtocolType::COLA_B, ipAddress, 5000 /*ms*/)
+      && eventChannel.subscribe("autoExposureParameterizedRunning", [&](const std::string&, CoLaCommand& eventData) {
+           const bool running = CoLaParameterReader(eventData).readBool();
+           {
+             std::lock_guard<std::mutex> lock(autoExpMutex);
+             autoExpParamRunning = running;
+           }
+           autoExpCondition.notify_all();
+         });
+    if (!eventsAvailable)
+    {
+      std::printf("Change notification for autoExposureParameterizedRunning not available, polling instead\n");
+    }
+
     // Invoke auto exposure method
     if (visionaryControl.login(IAuthentication::UserLevel::SERVICE, "CUST_SERV"))
     {
@@ -207,6 +236,11 @@ static int runStreamingDemo(const std::string& ipAddress, unsigned short dataPor
       {
         std::printf("Invoke method 'TriggerAutoExposureParameterized' (Param: %d) ...\n", autoType);
 
+        {
+          std::lock_guard<std::mutex> lock(autoExpMutex);
+          autoExpParamRunning = true;
+        }
+
         CoLaCommand invokeAutoExposureCommand =
           CoLaParameterWriter(CoLaCommandType::METHOD_INVOCATION, "TriggerAutoExposureParameterized")
             .parameterUInt(1)
@@ -220,30 +254,37 @@ static int runStreamingDemo(const std::string& ipAddress, unsigned short dataPor
                       CoLaParameterReader(autoExposureResponse).readBool());
         }
 
-        // Wait until auto exposure method is finished
-        bool      autoExpParamRunning = true;
-        long long startTime           = std::chrono::system_clock::now().time_since_epoch().count();
-        long long timeNow             = startTime;
-        while (autoExpParamRunning)
+        // Wait until auto exposure method is finished (time after auto exposure method should be finished: 10 sec)
+        const auto autoExpTimeout = std::chrono::seconds(10);
+        bool       autoExpDone    = false;
+        if (eventsAvailable)
         {
-          CoLaCommand getAutoExpParamRunningCommand =
-            CoLaParameterWriter(CoLaCommandType::READ_VARIABLE, "autoExposureParameterizedRunning").build();
-          CoLaCommand autoExpParamRunningResponse = visionaryControl.sendCommand(getAutoExpParamRunningCommand);
-          autoExpParamRunning                     = CoLaParameterReader(autoExpParamRunningResponse).readBool();
-
-          timeNow = std::chrono::system_clock::now().time_since_epoch().count();
-          if ((timeNow - startTime)
-              <= 10000000000) // 10 sec = 10 000 000 000 ns (time after auto exposure method should be finished)
+          std::unique_lock<std::mutex> lock(autoExpMutex);
+          autoExpDone = autoExpCondition.wait_for(lock, autoExpTimeout, [&]() { return !autoExpParamRunning; });
+        }
+        else
+        {
+          const auto startTime = std::chrono::steady_clock::now();
+          while (std::chrono::steady_clock::now() - startTime <= autoExpTimeout)
           {
+            CoLaCommand getAutoExpParamRunningCommand =
+              CoLaParameterWriter(CoLaCommandType::READ_VARIABLE, "autoExposureParameterizedRunning").build();
+            CoLaCommand autoExpParamRunningResponse = visionaryControl.sendCommand(getAutoExpParamRunningCommand);
+            if (!CoLaParameterReader(autoExpParamRunningResponse).readBool())
+            {
+              autoExpDone = true;
+              break;
+            }
             std::this_thread::sleep_for(std::chrono::seconds(1));
           }
-          else
-          {
-            std::printf("TIMEOUT: auto exposure function (Param: %d) needs longer than expected!\n", autoType);
-          }
+        }
+        if (!autoExpDone)
+        {
+          std::printf("TIMEOUT: auto exposure function (Param: %d) needs longer than expected!\n", autoType);
         }
       }
     }
+    eventChannel.close();
 
     // Read out new integration time values (after auto exposure was triggered)
     getIntegrationTimeUsCommand  = CoLaParameterWriter(CoLaCommandType::READ_VARIABLE, "integrationTimeUs").build();
@@ -264,34 +305,26 @@ static int runStreamingDemo(const std::string& ipAddress, unsigned short dataPor
     CoLaCommand getMessagesCommand = CoLaParameterWriter(CoLaCommandType::READ_VARIABLE, "MSinfo").build();
     CoLaCommand messagesResponse   = visionaryControl.sendCommand(getMessagesCommand);
 
-    // Read message array, length of array is always 25 items (see MSinfo in PDF).
-    CoLaParameterReader reader(messagesResponse);
-    for (int i = 0; i < 25; i++) // Read 25 items
+    // The message array always has 25 items (see MSinfo in PDF). decodeMSinfo maps them in one pass without
+    // allocating, extInfo refers to messagesResponse.
+    MSinfo msinfo;
+    if (!decodeMSinfo(messagesResponse, msinfo))
     {
-      uint32_t errorId    = reader.readUDInt();
-      uint32_t errorState = reader.readUDInt();
-
-      // Read ErrTimeType struct members for FirstTime
-      uint16_t firstTime_PwrOnCount = reader.readUInt();
-      uint32_t firstTime_OpSecs     = reader.readUDInt();
-      uint32_t firstTime_TimeOccur  = reader.readUDInt();
-
-      // Read ErrTimeType struct members for LastTime
-      uint16_t lastTime_PwrOnCount = reader.readUInt();
-      uint32_t lastTime_OpSecs     = reader.readUDInt();
-      uint32_t lastTime_TimeOccur  = reader.readUDInt();
-
-      uint16_t    numberOccurrences = reader.readUInt();
-      uint16_t    errReserved       = reader.readUInt();
-      std::string extInfo           = reader.readFlexString();
-
-      // Write all non-empty info messages to the console
-      if (errorId != 0)
+      std::printf("Failed to read MSinfo\n");
+    }
+    else
+    {
+      for (const ErrStructType& message : msinfo.messages)
       {
-        std::printf("Info message [0x%032x], extInfo: %s, number of occurrences: %u\n",
-                    errorId,
-                    extInfo.c_str(),
-                    numberOccurrences);
+        // Write all non-empty info messages to the console
+        if (message.errorId != 0)
+        {
+          std::printf("Info message [0x%032x], extInfo: %.*s, number of occurrences: %u\n",
+                      message.errorId,
+                      static_cast<int>(message.extInfo.size),
+                      message.extInfo.pData,
+                      message.numberOccurrences);
+        }
       }
     }
   }
@@ -304,17 +337,8 @@ static int runStreamingDemo(const std::string& ipAddress, unsigned short dataPor
     exitcode(2);
   }
 
-  //-----------------------------------------------
-  // Depending on the PC we might be too fast for the device configuration
-  // Just wait a short time. This should only be necessary after stop
-  // (to make sure stop really propagated and you don't get a pending frame)
-  // or after a configure to make sure configuration has finished
-  std::this_thread::sleep_for(
-    std::chrono::milliseconds(100)); // This short deelay is necessary to not have any old frames in the pipeline.
-
   //-----------------------------------------------
   // Connect to devices data stream
-  // This is done after stopping acquisition to ensure that there are no old frames are buffered
   if (!dataStream.open(ipAddress, dataPort))
   {
     std::printf("Failed to open data stream connection to device.\n");
@@ -322,10 +346,16 @@ static int runStreamingDemo(const std::string& ipAddress, unsigned short dataPor
     return exitcode.get();
   }
 
+  //-----------------------------------------------
+  // Frames taken before the stop or the configuration change can still be on their way. Drop them: flush() only
+  // waits while the stream is still delivering, so there is no need for a fixed delay.
+  FrameStreamSync<VisionarySData> streamSync(dataStream);
+  streamSync.flush();
+
   //-----------------------------------------------
   // Capture a single frame
   visionaryControl.stepAcquisition();
-  if (!dataStream.getNextFrame())
+  if (!streamSync.getNextFrame(pDataHandler, 2000))
   {
     std::printf("Frame timeout after single step.\n");
     exitcode(11);
@@ -11,14 +11,16 @@
 #include <sstream>
 
 #include <chrono>
-#include <thread>
 
 #include "CoLaParameterReader.h"
 #include "CoLaParameterWriter.h"
+#include "FrameStreamSync.h"
+#include "MSinfoDecoder.h"
+#include "MapView.h"
 #include "PointCloudPlyWriter.h"
 #include "PointXYZ.h"
+#include "TracedDataStream.h"
 #include "VisionaryControl.h"
-#include "VisionaryDataStream.h"
 #include "VisionaryTMiniData.h" // Header specific for the Time of Flight data
 
 // helper class, stores an exit code
@@ -64,9 +66,9 @@ static int runStreamingDemo(const std::string& ipAddress,
   ExitCode exitcode;
 
   // Generate Visionary instance
-  auto                pDataHandler = std::make_shared<VisionaryTMiniData>();
-  VisionaryDataStream dataStream(pDataHandler);
-  VisionaryControl    visionaryControl;
+  auto             pDataHandler = std::make_shared<VisionaryTMiniData>();
+  TracedDataStream dataStream(pDataHandler);
+  VisionaryControl visionaryControl;
 
   //-----------------------------------------------
   // Connect to devices control channel
@@ -140,34 +142,26 @@ static int runStreamingDemo(const std::string& ipAddress,
     CoLaCommand getMessagesCommand = CoLaParameterWriter(CoLaCommandType::READ_VARIABLE, "MSinfo").build();
     CoLaCommand messagesResponse   = visionaryControl.sendCommand(getMessagesCommand);
 
-    // Read message array, length of array is always 25 items (see MSinfo in PDF).
-    CoLaParameterReader reader(messagesResponse);
-    for (int i = 0; i < 25; i++) // Read 25 items
+    // The message array always has 25 items (see MSinfo in PDF). decodeMSinfo maps them in one pass without
+    // allocating, extInfo refers to messagesResponse.
+    MSinfo msinfo;
+    if (!decodeMSinfo(messagesResponse, msinfo))
     {
-      uint32_t errorId    = reader.readUDInt();
-      uint32_t errorState = reader.readUDInt();
-
-      // Read ErrTimeType struct members for FirstTime
-      uint16_t firstTime_PwrOnCount = reader.readUInt();
-      uint32_t firstTime_OpSecs     = reader.readUDInt();
-      uint32_t firstTime_TimeOccur  = reader.readUDInt();
-
-      // Read ErrTimeType struct members for LastTime
-      uint16_t lastTime_PwrOnCount = reader.readUInt();
-      uint32_t lastTime_OpSecs     = reader.readUDInt();
-      uint32_t lastTime_TimeOccur  = reader.readUDInt();
-
-      uint16_t    numberOccurrences = reader.readUInt();
-      uint16_t    errReserved       = reader.readUInt();
-      std::string extInfo           = reader.readFlexString();
-
-      // Write all non-empty info messages to the console
-      if (errorId != 0)
+      std::printf("Failed to read MSinfo\n");
+    }
+    else
+    {
+      for (const ErrStructType& message : msinfo.messages)
       {
-        std::printf("Info message [0x%032x], extInfo: %s, number of occurrences: %u\n",
-                    errorId,
-                    extInfo.c_str(),
-                    numberOccurrences);
+        // Write all non-empty info messages to the console
+        if (message.errorId != 0)
+        {
+          std::printf("Info message [0x%032x], extInfo: %.*s, number of occurrences: %u\n",
+                      message.errorId,
+                      static_cast<int>(message.extInfo.size),
+                      message.extInfo.pData,
+                      message.numberOccurrences);
+        }
       }
     }
   }
@@ -192,17 +186,8 @@ static int runStreamingDemo(const std::string& ipAddress,
     exitcode(2);
   }
 
-  //-----------------------------------------------
-  // Depending on the PC we might be too fast for the device configuration
-  // Just wait a short time. This should only be necessary after stop
-  // (to make sure stop really propagated and you don't get a pending frame)
-  // or after a configure to make sure configuration has finished
-  std::this_thread::sleep_for(
-    std::chrono::milliseconds(100)); // This short deelay is necessary to not have any old frames in the pipeline.
-
   //-----------------------------------------------
   // Connect to devices data stream
-  // This is done after stopping acquisition to ensure that there are no old frames are buffered
   if (!dataStream.open(ipAddress, dataPort))
   {
     std::printf("Failed to open data stream connection to device.\n");
@@ -210,10 +195,16 @@ static int runStreamingDemo(const std::string& ipAddress,
     return exitcode.get();
   }
 
+  //-----------------------------------------------
+  // Frames taken before the stop or the configuration change can still be on their way. Drop them: flush() only
+  // waits while the stream is still delivering, so there is no need for a fixed delay.
+  FrameStreamSync<VisionaryTMiniData> streamSync(dataStream);
+  streamSync.flush();
+
   //-----------------------------------------------
   // Capture a single frame
   visionaryControl.stepAcquisition();
-  if (!dataStream.getNextFrame())
+  if (!streamSync.getNextFrame(pDataHandler, 2000))
   {
     std::printf("Frame timeout after single step.\n");
     exitcode(11);
@@ -254,9 +245,19 @@ static int runStreamingDemo(const std::string& ipAddress,
       std::printf("Frame received in continuous mode, frame #%" PRIu32 ", timestamp: %" PRIu64 "\n",
                   pDataHandler->getFrameNum(),
                   pDataHandler->getTimestampMS());
-      std::vector<uint16_t> intensityMap = pDataHandler->getIntensityMap();
-      std::vector<uint16_t> distanceMap  = pDataHandler->getDistanceMap();
-      std::vector<uint16_t> stateMap     = pDataHandler->getStateMap();
+      // views instead of copies of the maps, valid until the next frame is received (use a MapBufferPool to keep maps)
+      const MapView<std::uint16_t> intensityMap = getIntensityView(*pDataHandler);
+      const MapView<std::uint16_t> distanceMap  = getDistanceView(*pDataHandler);
+      const MapView<std::uint16_t> stateMap     = getStateView(*pDataHandler);
+      if (!intensityMap.empty() && !distanceMap.empty() && !stateMap.empty())
+      {
+        const std::size_t x = distanceMap.width / 2u;
+        const std::size_t y = distanceMap.height / 2u;
+        std::printf("  center pixel: distance %u, intensity %u, state %u\n",
+                    static_cast<unsigned>(distanceMap.at(x, y)),
+                    static_cast<unsigned>(intensityMap.at(x, y)),
+                    static_cast<unsigned>(stateMap.at(x, y)));
+      }
     }
   }
 
@@ -310,16 +311,8 @@ static int runStreamingDemo(const std::string& ipAddress,
       }
     }
 
-    // Re-Connect to device data stream (make sure there are no old images in the pipeline)
-    dataStream.close();
-    std::this_thread::sleep_for(
-      std::chrono::seconds(1)); // This short delay is necessary to not have any old frames in the pipeline.
-    if (!dataStream.open(ipAddress, dataPort))
-    {
-      std::printf("Failed to open data stream connection to device.\n");
-      exitcode(10);
-      return exitcode.get();
-    }
+    // Drop the frames taken before the trigger was configured (make sure there are no old images in the pipeline)
+    streamSync.flush();
 
     std::printf("Please enable trigger on IO1 to receive an image:\n");
     long long startTime = std::chrono::system_clock::now().time_since_epoch().count();
@@ -343,7 +336,7 @@ static int runStreamingDemo(const std::string& ipAddress,
       // Receive the next frame
       if (IOValue2 == 0)
       {
-        if (dataStream.getNextFrame())
+        if (streamSync.getNextFrame(pDataHandler, 1000))
         {
           std::printf("Frame received in external trigger mode, frame #%" PRIu32 "\n", pDataHandler->getFrameNum());
           frameReceived = true;
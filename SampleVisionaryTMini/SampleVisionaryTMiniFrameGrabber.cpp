@@ -10,14 +10,13 @@
 #include <memory>
 #include <sstream>
 
-#include <chrono>
-#include <thread>
-
-#include "CoLaParameterReader.h"
-#include "CoLaParameterWriter.h"
 #include "FrameGrabber.h"
+#include "FramePool.h"
+#include "FrameStreamSync.h"
+#include "MapView.h"
 #include "PointCloudPlyWriter.h"
 #include "PointXYZ.h"
+#include "TriggeredCapture.h"
 #include "VisionaryControl.h"
 #include "VisionaryDataStream.h"
 #include "VisionaryTMiniData.h" // Header specific for the Time of Flight data
@@ -68,6 +67,8 @@ static int runStreamingDemo(const std::string& ipAddress,
   visionary::FrameGrabber<VisionaryTMiniData> frameGrabber(ipAddress, dataPort, 5000);
   std::shared_ptr<VisionaryTMiniData>         pDataHandler;
   VisionaryControl                            visionaryControl;
+  // recycles the data handlers when frames are kept (e.g. queued to another thread) instead of allocating new ones
+  FramePool<VisionaryTMiniData> framePool;
 
   //-----------------------------------------------
   // Connect to devices control channel
@@ -96,17 +97,15 @@ static int runStreamingDemo(const std::string& ipAddress,
   }
 
   //-----------------------------------------------
-  // Depending on the PC we might be too fast for the device configuration
-  // Just wait a short time. This should only be necessary after stop
-  // (to make sure stop really propagated and you don't get a pending frame)
-  // or after a configure to make sure configuration has finished
-  std::this_thread::sleep_for(
-    std::chrono::milliseconds(100)); // This short deelay is necessary to not have any old frames in the pipeline.
+  // Frames taken before the stop can still be queued in the frame grabber or be on their way. Drop them: flush()
+  // only waits while the stream is still delivering, so there is no need for a fixed delay.
+  FrameStreamSync<VisionaryTMiniData> streamSync(frameGrabber);
+  streamSync.flush();
 
   //-----------------------------------------------
   // Capture a single frame
   visionaryControl.stepAcquisition();
-  if (!frameGrabber.getNextFrame(pDataHandler, 2000))
+  if (!streamSync.getNextFrame(pDataHandler, 2000))
   {
     std::printf("Frame timeout after single step.\n");
     exitcode(11);
@@ -136,7 +135,7 @@ static int runStreamingDemo(const std::string& ipAddress,
   visionaryControl.startAcquisition();
   for (unsigned i = 0u; i < numberOfFrames; i++)
   {
-    if (!frameGrabber.getNextFrame(pDataHandler))
+    if (!framePool.getNextFrame(frameGrabber, pDataHandler))
     {
       std::printf("Frame timeout in continuous mode after %u frames\n", i);
       exitcode(12);
@@ -145,11 +144,26 @@ static int runStreamingDemo(const std::string& ipAddress,
     else
     {
       std::printf("Frame received in continuous mode, frame #%" PRIu32 "\n", pDataHandler->getFrameNum());
-      std::vector<uint16_t> intensityMap = pDataHandler->getIntensityMap();
-      std::vector<uint16_t> distanceMap  = pDataHandler->getDistanceMap();
-      std::vector<uint16_t> stateMap     = pDataHandler->getStateMap();
+      // views instead of copies of the maps, valid until the next frame is received (use a MapBufferPool to keep maps)
+      const MapView<std::uint16_t> intensityMap = getIntensityView(*pDataHandler);
+      const MapView<std::uint16_t> distanceMap  = getDistanceView(*pDataHandler);
+      const MapView<std::uint16_t> stateMap     = getStateView(*pDataHandler);
+      if (!intensityMap.empty() && !distanceMap.empty() && !stateMap.empty())
+      {
+        const std::size_t x = distanceMap.width / 2u;
+        const std::size_t y = distanceMap.height / 2u;
+        std::printf("  center pixel: distance %u, intensity %u, state %u\n",
+                    static_cast<unsigned>(distanceMap.at(x, y)),
+                    static_cast<unsigned>(intensityMap.at(x, y)),
+                    static_cast<unsigned>(stateMap.at(x, y)));
+      }
     }
   }
+  const FramePool<VisionaryTMiniData>::Statistics poolStatistics = framePool.getStatistics();
+  std::printf("Data handlers: %" PRIu64 " allocated, %" PRIu64 " reused, at most %zu in use\n",
+              poolStatistics.allocations,
+              poolStatistics.reuses,
+              poolStatistics.maxInUse);
 
   //-----------------------------------------------
   // This part of the sample code is skipped by default because not every user has a working IO trigger hardware
@@ -160,81 +174,36 @@ static int runStreamingDemo(const std::string& ipAddress,
     // NOTE: This part of the sample only works if you have a working rising egde signal on IO1 which triggers an image!
     std::printf("\n=== Starting external trigger example:\n");
     // Login as authorized client
+    TriggeredCapture<VisionaryTMiniData> triggeredCapture(visionaryControl, frameGrabber);
     if (!visionaryControl.login(IAuthentication::UserLevel::AUTHORIZED_CLIENT, "CLIENT"))
     {
       std::printf("Failed to log into device\n");
       exitcode(2);
     }
-    else
+    // Set frontendMode to STOP (= 1), DIO1Fnc to Trigger (= 7) and DIO2Fnc to TriggerBusy (= 23)
+    else if (!triggeredCapture.armHardwareTrigger())
     {
-      // Set frontendMode to STOP (= 1)
-      std::printf("Setting frontendMode to STOP (= 1)\n");
-      CoLaCommand setFrontendModeCommand =
-        CoLaParameterWriter(CoLaCommandType::WRITE_VARIABLE, "frontendMode").parameterUSInt(1).build();
-      CoLaCommand setFrontendModeResponse = visionaryControl.sendCommand(setFrontendModeCommand);
-      if (setFrontendModeResponse.getError() != CoLaError::OK)
-      {
-        std::printf("Failed to set frontendMode to STOP (= 1)\n");
-        exitcode(6);
-      }
-
-      // Set INOUT1_Function to Trigger (= 7)
-      std::printf("Setting DIO1Fnc to Trigger (= 7)\n");
-      CoLaCommand setDIO1FncCommand =
-        CoLaParameterWriter(CoLaCommandType::WRITE_VARIABLE, "DIO1Fnc").parameterUSInt(7).build();
-      CoLaCommand setDIO1FncResponse = visionaryControl.sendCommand(setDIO1FncCommand);
-      if (setDIO1FncResponse.getError() != CoLaError::OK)
-      {
-        std::printf("Failed to set DIO1Fnc to Trigger (= 7)\n");
-        exitcode(5);
-      }
-
-      // Set INOUT2_Function to TriggerBusy (= 23)
-      std::printf("Setting DIO2Fnc to TriggerBusy (= 23)\n");
-      CoLaCommand setDIO2FncCommand =
-        CoLaParameterWriter(CoLaCommandType::WRITE_VARIABLE, "DIO2Fnc").parameterUSInt(23).build();
-      CoLaCommand setDIO2FncResponse = visionaryControl.sendCommand(setDIO2FncCommand);
-      if (setDIO2FncResponse.getError() != CoLaError::OK)
-      {
-        std::printf("Failed to set DIO2Fnc to TriggerBusy (= 23)\n");
-        exitcode(5);
-      }
+      std::printf("Failed to configure the device for IO trigger\n");
+      exitcode(5);
     }
-    std::printf("Please enable trigger on IO1 to receive an image:\n");
-    long long startTime = std::chrono::system_clock::now().time_since_epoch().count();
-    long long timeNow   = startTime;
 
-    // Limited time loop for receiving hardware trigger signals on IO1 pin
-    bool      frameReceived  = false;
-    long long triggerTimeOut = 100000000; // 10 sec = 100 000 000
-    while ((timeNow - startTime) <= triggerTimeOut)
+    // Wait for the frame on the data stream only. There is no need to poll TriggerBusy via IOValue: polling adds a
+    // control round trip to every capture and keeps the control channel busy.
+    std::printf("Please enable trigger on IO1 to receive an image:\n");
+    const std::uint32_t                          triggerTimeoutMs = 10000u;
+    TriggeredCapture<VisionaryTMiniData>::Result result;
+    if (triggeredCapture.waitForFrame(result, triggerTimeoutMs))
     {
-      // Read variable IOValue
-      CoLaCommand         getIOValue      = CoLaParameterWriter(CoLaCommandType::READ_VARIABLE, "IOValue").build();
-      CoLaCommand         IOValueResponse = visionaryControl.sendCommand(getIOValue);
-      CoLaParameterReader IOValues(IOValueResponse);
-
-      // The parameter reader works like a FILE, so we need to read one value after the next. First IO1, then IO2 etc
-      const std::int8_t IOValue1 = IOValues.readSInt();
-      const std::int8_t IOValue2 = IOValues.readSInt(); // We need the IOValue of IO2 from the V3SIOsState struct
-      std::printf("Read TriggerBusy = %d\n", IOValue2);
-
-      // Receive the next frame
-      if (IOValue2 == 0)
-      {
-        if (frameGrabber.getNextFrame(pDataHandler, 2000))
-        {
-          std::printf("Frame received in external trigger mode, frame #%" PRIu32\n", pDataHandler->getFrameNum());
-          frameReceived = true;
-        }
-        timeNow = std::chrono::system_clock::now().time_since_epoch().count();
-      }
+      pDataHandler = result.pFrame;
+      // the trigger time is not known here, only the time waited for the signal on IO1
+      std::printf("Frame received in external trigger mode, frame #%" PRIu32 ", %lld ms after waiting started\n",
+                  pDataHandler->getFrameNum(),
+                  static_cast<long long>(result.waitTime.count() / 1000));
     }
-
-    if (!frameReceived)
+    else
     {
       std::printf("TIMEOUT: No trigger signal received on IO1 within %.2f seconds!\n",
-                  static_cast<float>(triggerTimeOut) / 10000000.f);
+                  static_cast<double>(triggerTimeoutMs) / 1000.);
       exitcode(13);
     }
   }
@@ -0,0 +1,177 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "AsyncControl.h"
+#include "CoLaError.h"
+#include "CoLaParameterWriter.h"
+#include "SimControlServer.h"
+#include "TcpConnection.h"
+#include "TestUtils.h"
+
+using namespace visionary;
+
+namespace {
+
+const char          kAddress[] = "127.0.0.1";
+const std::uint16_t kPort      = 42125u;
+
+const std::chrono::milliseconds kSlowDelay(300);
+
+CoLaCommand makeRead(const char* pName)
+{
+  return CoLaParameterWriter(CoLaCommandType::READ_VARIABLE, pName).build();
+}
+
+void checkTimeout(VisionaryControl::ProtocolType protocol)
+{
+  SimControlServer device(protocol);
+  device.setVariable("DeviceIdent", {0x00u, 0x02u, 'T', 'M'});
+  device.setVariable("SlowVariable", {0x00u});
+  device.setCommandDelay("SlowVariable", kSlowDelay);
+  if (!VISIONARY_CHECK(device.start(kAddress, kPort)))
+  {
+    return;
+  }
+
+  AsyncControl control;
+  if (!VISIONARY_CHECK(control.open(protocol, kAddress, 2000u, kPort)))
+  {
+    return;
+  }
+
+  const auto  start    = std::chrono::steady_clock::now();
+  CoLaCommand response = control.sendCommand(makeRead("SlowVariable"), 50u);
+  const auto  elapsed  = std::chrono::steady_clock::now() - start;
+  VISIONARY_CHECK(response.getError() == CoLaError::NETWORK_ERROR);
+  VISIONARY_CHECK(elapsed < kSlowDelay / 2);
+
+  // the session survives the timeout and the late response is not taken for the next one
+  VISIONARY_CHECK(control.isConnected());
+  VISIONARY_CHECK(control.sendCommand(makeRead("DeviceIdent")).getError() == CoLaError::OK);
+  VISIONARY_CHECK(control.getStatistics().getCounters(makeRead("SlowVariable").getBuffer()).timeouts == 1u);
+}
+
+void testTimeoutCoLaB()
+{
+  checkTimeout(VisionaryControl::ProtocolType::COLA_B);
+}
+
+void testTimeoutCoLa2()
+{
+  checkTimeout(VisionaryControl::ProtocolType::COLA_2);
+}
+
+void testCloseWhilePending()
+{
+  const unsigned kNumRequests = 3u;
+
+  SimControlServer device(VisionaryControl::ProtocolType::COLA_2);
+  device.setVariable("SlowVariable", {0x00u});
+  device.setCommandDelay("SlowVariable", kSlowDelay);
+  if (!VISIONARY_CHECK(device.start(kAddress, kPort)))
+  {
+    return;
+  }
+
+  AsyncControl control;
+  if (!VISIONARY_CHECK(control.open(VisionaryControl::ProtocolType::COLA_2, kAddress, 2000u, kPort)))
+  {
+    return;
+  }
+
+  std::atomic<unsigned> failed(0u);
+  for (unsigned i = 0u; i < kNumRequests; ++i)
+  {
+    control.sendCommandAsync(makeRead("SlowVariable"), [&failed](CoLaCommand& response) {
+      if (response.getError() == CoLaError::NETWORK_ERROR)
+      {
+        ++failed;
+      }
+    });
+  }
+  std::this_thread::sleep_for(kSlowDelay / 6);
+  VISIONARY_CHECK(control.getInFlightCount() == kNumRequests);
+
+  // close() completes the pending requests instead of waiting for their responses
+  const auto start = std::chrono::steady_clock::now();
+  control.close();
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  VISIONARY_CHECK(failed == kNumRequests);
+  VISIONARY_CHECK(elapsed < kSlowDelay / 2);
+  VISIONARY_CHECK(control.sendCommand(makeRead("SlowVariable")).getError() == CoLaError::NETWORK_ERROR);
+}
+
+void checkCloseWhileSending(VisionaryControl::ProtocolType protocol)
+{
+  SimControlServer device(protocol);
+  device.setVariable("DeviceIdent", {0x00u, 0x02u, 'T', 'M'});
+  if (!VISIONARY_CHECK(device.start(kAddress, kPort)))
+  {
+    return;
+  }
+
+  AsyncControl control;
+  if (!VISIONARY_CHECK(control.open(protocol, kAddress, 2000u, kPort)))
+  {
+    return;
+  }
+
+  // senders keep sending until after the connection was closed; every command must complete, sent or not
+  const unsigned           kNumSenders = 4u;
+  std::atomic<bool>        stop(false);
+  std::atomic<unsigned>    submitted(0u);
+  std::atomic<unsigned>    completed(0u);
+  std::vector<std::thread> senders;
+  for (unsigned i = 0u; i < kNumSenders; ++i)
+  {
+    senders.emplace_back([&]() {
+      while (!stop)
+      {
+        ++submitted;
+        control.sendCommandAsync(makeRead("DeviceIdent"), [&completed](CoLaCommand&) { ++completed; });
+      }
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  control.close();
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  stop = true;
+  for (std::thread& sender : senders)
+  {
+    sender.join();
+  }
+  VISIONARY_CHECK(completed == submitted);
+  VISIONARY_CHECK(!control.isConnected());
+}
+
+void testCloseWhileSendingCoLaB()
+{
+  checkCloseWhileSending(VisionaryControl::ProtocolType::COLA_B);
+}
+
+void testCloseWhileSendingCoLa2()
+{
+  checkCloseWhileSending(VisionaryControl::ProtocolType::COLA_2);
+}
+
+} // namespace
+
+int main()
+{
+  TcpConnection::initSocketLibrary();
+
+  VISIONARY_RUN_TEST(testTimeoutCoLaB);
+  VISIONARY_RUN_TEST(testTimeoutCoLa2);
+  VISIONARY_RUN_TEST(testCloseWhilePending);
+  VISIONARY_RUN_TEST(testCloseWhileSendingCoLaB);
+  VISIONARY_RUN_TEST(testCloseWhileSendingCoLa2);
+  return test::result();
+}
@@ -0,0 +1,222 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "CoLaFrame.h"
+#include "TestUtils.h"
+
+using namespace visionary;
+
+namespace {
+
+std::vector<std::uint8_t> toBytes(const std::string& text)
+{
+  return std::vector<std::uint8_t>(text.begin(), text.end());
+}
+
+CoLaFrame makeFrame(const std::string& payload, std::uint32_t sessionId = 0u, std::uint16_t requestId = 0u)
+{
+  CoLaFrame frame;
+  frame.sessionId = sessionId;
+  frame.requestId = requestId;
+  frame.payload   = toBytes(payload);
+  return frame;
+}
+
+bool decodeOne(VisionaryControl::ProtocolType protocol, const std::vector<std::uint8_t>& telegram, CoLaFrame& frame)
+{
+  CoLaFrameDecoder decoder(protocol);
+  decoder.push(telegram.data(), telegram.size());
+  return decoder.pop(frame);
+}
+
+void testCoLa2RequestOnTheWire()
+{
+  // the command mode goes out with two letters, as CoLa2ProtocolHandler sends it
+  const std::vector<std::uint8_t> expected = {0x02, 0x02, 0x02, 0x02, // magic
+                                              0x00, 0x00, 0x00, 0x16, // length: header + "RN DeviceIdent"
+                                              0x00, 0x00,             // HubCntr, NoC
+                                              0x12, 0x34, 0x56, 0x78, // session id
+                                              0x00, 0x2a,             // request id
+                                              'R',  'N',  ' ',  'D',  'e', 'v', 'i', 'c', 'e', 'I', 'd', 'e', 'n', 't'};
+
+  VISIONARY_CHECK(encodeCoLaFrame(VisionaryControl::ProtocolType::COLA_2,
+                                  makeFrame("sRN DeviceIdent", 0x12345678u, 42u))
+                  == expected);
+}
+
+void testCoLa2ResponseFromTheWire()
+{
+  const std::vector<std::uint8_t> telegram = {0x02, 0x02, 0x02, 0x02, 0x00, 0x00, 0x00, 0x19, 0x00, 0x00,
+                                              0x12, 0x34, 0x56, 0x78, 0x00, 0x2a, 'R',  'A',  ' ',  'D',
+                                              'e',  'v',  'i',  'c',  'e',  'I',  'd',  'e',  'n',  't',
+                                              ' ',  0x00, 0x03};
+
+  CoLaFrame frame;
+  if (!VISIONARY_CHECK(decodeOne(VisionaryControl::ProtocolType::COLA_2, telegram, frame)))
+  {
+    return;
+  }
+  VISIONARY_CHECK(frame.sessionId == 0x12345678u);
+  VISIONARY_CHECK(frame.requestId == 42u);
+  // the 's' is added again, so the payload has the layout of CoLaCommand
+  std::vector<std::uint8_t> expectedPayload = toBytes("sRA DeviceIdent ");
+  expectedPayload.push_back(0x00);
+  expectedPayload.push_back(0x03);
+  VISIONARY_CHECK(frame.payload == expectedPayload);
+  VISIONARY_CHECK(getCoLaCommandCode(frame.payload) == "sRA");
+  VISIONARY_CHECK(getCoLaCommandName(frame.payload) == "DeviceIdent");
+}
+
+void testCoLa2SessionTelegramsUnchanged()
+{
+  const std::vector<std::uint8_t> openSession = makeCoLa2OpenSessionPayload(5u, "ab");
+  const std::vector<std::uint8_t> expected    = {
+    0x02, 0x02, 0x02, 0x02, 0x00, 0x00, 0x00, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+    'O',  'x',  0x05, 0x00, 0x02, 'a',  'b'};
+
+  CoLaFrame request;
+  request.requestId = 1u;
+  request.payload   = openSession;
+  VISIONARY_CHECK(encodeCoLaFrame(VisionaryControl::ProtocolType::COLA_2, request) == expected);
+
+  CoLaFrame decoded;
+  VISIONARY_CHECK(decodeOne(VisionaryControl::ProtocolType::COLA_2, expected, decoded));
+  VISIONARY_CHECK(decoded.payload == openSession);
+
+  CoLaFrame answer;
+  VISIONARY_CHECK(decodeOne(VisionaryControl::ProtocolType::COLA_2,
+                            encodeCoLaFrame(VisionaryControl::ProtocolType::COLA_2, makeFrame("OA", 7u, 1u)),
+                            answer));
+  VISIONARY_CHECK(answer.payload == toBytes("OA"));
+  VISIONARY_CHECK(answer.sessionId == 7u);
+}
+
+void testCoLaBOnTheWire()
+{
+  // CoLa B keeps the 's' and appends the XOR checksum of the payload
+  const std::vector<std::uint8_t> expected = {0x02, 0x02, 0x02, 0x02, 0x00, 0x00, 0x00, 0x0f, 's', 'R', 'N', ' ',
+                                              'D',  'e',  'v',  'i',  'c',  'e',  'I',  'd',  'e', 'n', 't', 0x25};
+
+  VISIONARY_CHECK(encodeCoLaFrame(VisionaryControl::ProtocolType::COLA_B, makeFrame("sRN DeviceIdent")) == expected);
+
+  CoLaFrame frame;
+  VISIONARY_CHECK(decodeOne(VisionaryControl::ProtocolType::COLA_B, expected, frame));
+  VISIONARY_CHECK(frame.payload == toBytes("sRN DeviceIdent"));
+}
+
+void testRoundTrip()
+{
+  const VisionaryControl::ProtocolType protocols[] = {VisionaryControl::ProtocolType::COLA_B,
+                                                      VisionaryControl::ProtocolType::COLA_2};
+  for (VisionaryControl::ProtocolType protocol : protocols)
+  {
+    for (const char* pPayload : {"sMN SetAccessMode", "sEN TriggerDone ", "sFA", "sAN Run "})
+    {
+      CoLaFrame frame;
+      VISIONARY_CHECK(decodeOne(protocol, encodeCoLaFrame(protocol, makeFrame(pPayload, 3u, 4u)), frame));
+      VISIONARY_CHECK(frame.payload == toBytes(pPayload));
+    }
+  }
+}
+
+void testSplitTelegram()
+{
+  const VisionaryControl::ProtocolType protocols[] = {VisionaryControl::ProtocolType::COLA_B,
+                                                      VisionaryControl::ProtocolType::COLA_2};
+  for (VisionaryControl::ProtocolType protocol : protocols)
+  {
+    const std::vector<std::uint8_t> telegram = encodeCoLaFrame(protocol, makeFrame("sRN DeviceIdent", 3u, 4u));
+    CoLaFrameDecoder                decoder(protocol);
+    CoLaFrame                       frame;
+    for (std::size_t i = 0u; i + 1u < telegram.size(); ++i)
+    {
+      decoder.push(&telegram[i], 1u);
+      VISIONARY_CHECK(!decoder.pop(frame));
+    }
+    decoder.push(&telegram.back(), 1u);
+    VISIONARY_CHECK(decoder.pop(frame) && (frame.payload == toBytes("sRN DeviceIdent")));
+    VISIONARY_CHECK(!decoder.pop(frame));
+    VISIONARY_CHECK(decoder.getDiscardedBytes() == 0u);
+  }
+}
+
+void testResyncAfterGarbage()
+{
+  const VisionaryControl::ProtocolType protocols[] = {VisionaryControl::ProtocolType::COLA_B,
+                                                      VisionaryControl::ProtocolType::COLA_2};
+  for (VisionaryControl::ProtocolType protocol : protocols)
+  {
+    // the garbage ends with a partial magic, followed by a telegram split in the middle of its magic
+    const std::vector<std::uint8_t> garbage  = {'x', 0x02, 0x02, 0x00, 0x02, 0x02, 0x02};
+    const std::vector<std::uint8_t> telegram = encodeCoLaFrame(protocol, makeFrame("sRA DeviceIdent", 3u, 4u));
+    CoLaFrameDecoder                decoder(protocol);
+    CoLaFrame                       frame;
+    decoder.push(garbage.data(), garbage.size());
+    decoder.push(telegram.data(), 2u);
+    VISIONARY_CHECK(!decoder.pop(frame));
+    decoder.push(telegram.data() + 2u, telegram.size() - 2u);
+    VISIONARY_CHECK(decoder.pop(frame) && (frame.payload == toBytes("sRA DeviceIdent")));
+    VISIONARY_CHECK(decoder.getDiscardedBytes() == garbage.size());
+  }
+}
+
+void testResyncAfterChecksumError()
+{
+  const std::vector<std::uint8_t> telegram =
+    encodeCoLaFrame(VisionaryControl::ProtocolType::COLA_B, makeFrame("sRA DeviceIdent"));
+
+  std::vector<std::uint8_t> stream = encodeCoLaFrame(VisionaryControl::ProtocolType::COLA_B, makeFrame("sRA Broken"));
+  stream.back() ^= 0x01u;
+  const std::size_t brokenSize = stream.size();
+  stream.insert(stream.end(), telegram.begin(), telegram.end());
+
+  CoLaFrameDecoder decoder(VisionaryControl::ProtocolType::COLA_B);
+  CoLaFrame        frame;
+  decoder.push(stream.data(), stream.size());
+  VISIONARY_CHECK(decoder.pop(frame) && (frame.payload == toBytes("sRA DeviceIdent")));
+  VISIONARY_CHECK(decoder.getDiscardedBytes() == brokenSize);
+  VISIONARY_CHECK(!decoder.pop(frame));
+}
+
+void testResyncAfterImplausibleLength()
+{
+  // a magic followed by a length above the limit, e.g. a corrupted header
+  const std::vector<std::uint8_t> telegram =
+    encodeCoLaFrame(VisionaryControl::ProtocolType::COLA_2, makeFrame("sRA DeviceIdent", 3u, 4u));
+
+  std::vector<std::uint8_t> stream     = {0x02, 0x02, 0x02, 0x02, 0x7f, 0xff, 0xff, 0xff};
+  const std::size_t         brokenSize = stream.size();
+  stream.insert(stream.end(), telegram.begin(), telegram.end());
+
+  CoLaFrameDecoder decoder(VisionaryControl::ProtocolType::COLA_2);
+  CoLaFrame        frame;
+  decoder.push(stream.data(), stream.size());
+  VISIONARY_CHECK(decoder.pop(frame) && (frame.requestId == 4u));
+  VISIONARY_CHECK(decoder.getDiscardedBytes() == brokenSize);
+
+  decoder.reset();
+  VISIONARY_CHECK(decoder.getDiscardedBytes() == 0u);
+}
+
+} // namespace
+
+int main()
+{
+  VISIONARY_RUN_TEST(testCoLa2RequestOnTheWire);
+  VISIONARY_RUN_TEST(testCoLa2ResponseFromTheWire);
+  VISIONARY_RUN_TEST(testCoLa2SessionTelegramsUnchanged);
+  VISIONARY_RUN_TEST(testCoLaBOnTheWire);
+  VISIONARY_RUN_TEST(testRoundTrip);
+  VISIONARY_RUN_TEST(testSplitTelegram);
+  VISIONARY_RUN_TEST(testResyncAfterGarbage);
+  VISIONARY_RUN_TEST(testResyncAfterChecksumError);
+  VISIONARY_RUN_TEST(testResyncAfterImplausibleLength);
+  return test::result();
+}
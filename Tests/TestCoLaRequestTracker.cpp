@@ -0,0 +1,167 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "CoLaCommand.h"
+#include "CoLaError.h"
+#include "CoLaFrame.h"
+#include "CoLaRequestTracker.h"
+#include "TestUtils.h"
+
+using namespace visionary;
+
+namespace {
+
+typedef CoLaRequestTracker::Clock Clock;
+
+const std::chrono::milliseconds kTimeout(100);
+
+/// Records the errors of the completed requests
+struct Results
+{
+  std::vector<CoLaError::Enum> errors;
+
+  CoLaRequestTracker::ResponseCallback callback()
+  {
+    return [this](CoLaCommand& response) { errors.push_back(response.getError()); };
+  }
+};
+
+CoLaRequestTracker::Request makeRequest(CoLaRequestTracker& tracker, Clock::time_point now, Results& results)
+{
+  CoLaRequestTracker::Request request;
+  request.requestId = tracker.nextRequestId();
+  request.deadline  = now + kTimeout;
+  request.callback  = results.callback();
+  return request;
+}
+
+CoLaFrame makeResponse(std::uint16_t requestId)
+{
+  const std::string payload = "sRA DeviceIdent ";
+
+  CoLaFrame frame;
+  frame.requestId = requestId;
+  frame.payload.assign(payload.begin(), payload.end());
+  return frame;
+}
+
+void testCoLa2Timeout()
+{
+  CoLaRequestTracker tracker;
+  tracker.reset(VisionaryControl::ProtocolType::COLA_2, 1000u);
+
+  Results                           results;
+  CoLaRequestTracker::Completions   completions;
+  const Clock::time_point           now        = Clock::now();
+  const CoLaRequestTracker::Request request    = makeRequest(tracker, now, results);
+  const std::uint16_t               timedOutId = request.requestId;
+  tracker.addInFlight(request);
+  tracker.addInFlight(makeRequest(tracker, now + kTimeout, results));
+  VISIONARY_CHECK(tracker.nextDeadline(Clock::time_point::max()) == now + kTimeout);
+
+  tracker.expire(now + kTimeout / 2, completions);
+  VISIONARY_CHECK(completions.empty());
+
+  tracker.expire(now + kTimeout, completions);
+  CoLaRequestTracker::complete(completions);
+  VISIONARY_CHECK((results.errors.size() == 1u) && (results.errors[0] == CoLaError::NETWORK_ERROR));
+  VISIONARY_CHECK(tracker.getInFlightCount() == 1u);
+
+  // the late response is dropped, the other request gets its own
+  tracker.handleResponse(makeResponse(timedOutId), completions);
+  VISIONARY_CHECK(completions.empty());
+  VISIONARY_CHECK(tracker.canSend(2u));
+
+  tracker.handleResponse(makeResponse(static_cast<std::uint16_t>(timedOutId + 1u)), completions);
+  CoLaRequestTracker::complete(completions);
+  VISIONARY_CHECK((results.errors.size() == 2u) && (results.errors[1] == CoLaError::OK));
+  VISIONARY_CHECK(tracker.getInFlightCount() == 0u);
+}
+
+void testCoLaBLateResponse()
+{
+  const std::chrono::milliseconds kStaleTimeout(1000);
+
+  CoLaRequestTracker tracker;
+  tracker.reset(VisionaryControl::ProtocolType::COLA_B, static_cast<std::uint32_t>(kStaleTimeout.count()));
+
+  Results                         results;
+  CoLaRequestTracker::Completions completions;
+  const Clock::time_point         now = Clock::now();
+  tracker.addInFlight(makeRequest(tracker, now, results));
+  VISIONARY_CHECK(!tracker.canSend(8u));
+
+  tracker.expire(now + kTimeout, completions);
+  CoLaRequestTracker::complete(completions);
+  VISIONARY_CHECK((results.errors.size() == 1u) && (results.errors[0] == CoLaError::NETWORK_ERROR));
+
+  // CoLa B can't tell the late response from the next one: nothing is sent until it arrived
+  VISIONARY_CHECK(!tracker.canSend(8u));
+  tracker.handleResponse(makeResponse(0u), completions);
+  VISIONARY_CHECK(completions.empty());
+  VISIONARY_CHECK(tracker.canSend(8u));
+
+  tracker.addInFlight(makeRequest(tracker, now + kTimeout, results));
+  tracker.handleResponse(makeResponse(0u), completions);
+  CoLaRequestTracker::complete(completions);
+  VISIONARY_CHECK((results.errors.size() == 2u) && (results.errors[1] == CoLaError::OK));
+}
+
+void testCoLaBResponseNeverArrives()
+{
+  const std::chrono::milliseconds kStaleTimeout(1000);
+
+  CoLaRequestTracker tracker;
+  tracker.reset(VisionaryControl::ProtocolType::COLA_B, static_cast<std::uint32_t>(kStaleTimeout.count()));
+
+  Results                         results;
+  CoLaRequestTracker::Completions completions;
+  const Clock::time_point         now = Clock::now();
+  tracker.addInFlight(makeRequest(tracker, now, results));
+  tracker.expire(now + kTimeout, completions);
+  VISIONARY_CHECK(tracker.nextDeadline(Clock::time_point::max()) == now + kTimeout + kStaleTimeout);
+
+  // after the stale timeout the device is assumed to have swallowed the request
+  tracker.expire(now + kTimeout + kStaleTimeout, completions);
+  VISIONARY_CHECK(tracker.canSend(8u));
+  CoLaRequestTracker::complete(completions);
+  VISIONARY_CHECK(results.errors.size() == 1u);
+}
+
+void testFailAll()
+{
+  CoLaRequestTracker tracker;
+  tracker.reset(VisionaryControl::ProtocolType::COLA_2, 1000u);
+
+  Results                                 results;
+  CoLaRequestTracker::Completions         completions;
+  std::deque<CoLaRequestTracker::Request> queue;
+  const Clock::time_point                 now = Clock::now();
+  tracker.addInFlight(makeRequest(tracker, now, results));
+  queue.push_back(makeRequest(tracker, now, results));
+
+  tracker.failAll(completions);
+  CoLaRequestTracker::failQueue(queue, completions);
+  CoLaRequestTracker::complete(completions);
+  VISIONARY_CHECK(results.errors == std::vector<CoLaError::Enum>(2u, CoLaError::NETWORK_ERROR));
+  VISIONARY_CHECK((tracker.getInFlightCount() == 0u) && queue.empty());
+}
+
+} // namespace
+
+int main()
+{
+  VISIONARY_RUN_TEST(testCoLa2Timeout);
+  VISIONARY_RUN_TEST(testCoLaBLateResponse);
+  VISIONARY_RUN_TEST(testCoLaBResponseNeverArrives);
+  VISIONARY_RUN_TEST(testFailAll);
+  return test::result();
+}
@@ -0,0 +1,174 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "AsyncControl.h"
+#include "CommandStatistics.h"
+#include "ConfigurationProfile.h"
+#include "SimControlServer.h"
+#include "TcpConnection.h"
+#include "TestUtils.h"
+
+using namespace visionary;
+
+namespace {
+
+const char          kAddress[]     = "127.0.0.1";
+const std::uint16_t kPort          = 42126u;
+const char          kProfileFile[] = "TestConfigurationProfile.txt";
+
+const std::vector<std::uint8_t> kFrontendMode = {0x00u};
+const std::vector<std::uint8_t> kExposureUs   = {0x00u, 0x00u, 0x03u, 0xe8u};
+const std::vector<std::uint8_t> kLocationName = {0x00u, 0x03u, 'a', 'b', 'c'};
+
+const std::vector<std::string> kNames = {"frontendMode", "integrationTimeUs", "LocationName"};
+
+void setupDevice(SimControlServer& device)
+{
+  device.setVariable("frontendMode", kFrontendMode);
+  device.setVariable("integrationTimeUs", kExposureUs);
+  device.setVariable("LocationName", kLocationName);
+  for (const std::string& name : kNames)
+  {
+    device.setWriteLevel(name, IAuthentication::UserLevel::AUTHORIZED_CLIENT);
+  }
+}
+
+void checkRoundTrip(VisionaryControl::ProtocolType protocol)
+{
+  SimControlServer device(protocol);
+  setupDevice(device);
+  if (!VISIONARY_CHECK(device.start(kAddress, kPort)))
+  {
+    return;
+  }
+
+  AsyncControl control;
+  if (!VISIONARY_CHECK(control.open(protocol, kAddress, 2000u, kPort))
+      || !VISIONARY_CHECK(control.login(IAuthentication::UserLevel::AUTHORIZED_CLIENT, "CLIENT")))
+  {
+    return;
+  }
+
+  ConfigurationProfile saved;
+  VISIONARY_CHECK(saved.read(control, kNames));
+  VISIONARY_CHECK(saved.getNames() == kNames);
+  VISIONARY_CHECK(saved.save(kProfileFile));
+
+  // somebody changes the exposure on the device
+  const std::vector<std::uint8_t> changedExposureUs = {0x00u, 0x00u, 0x07u, 0xd0u};
+  device.setVariable("integrationTimeUs", changedExposureUs);
+
+  ConfigurationProfile loaded;
+  VISIONARY_CHECK(loaded.load(kProfileFile));
+  std::remove(kProfileFile);
+  VISIONARY_CHECK(loaded.getEntries() == saved.getEntries());
+
+  ConfigurationProfile actual;
+  VISIONARY_CHECK(actual.read(control, kNames));
+  const ConfigurationProfile delta = loaded.diff(actual);
+  VISIONARY_CHECK(delta.size() == 1u);
+  VISIONARY_CHECK((delta.find("integrationTimeUs") != nullptr) && (*delta.find("integrationTimeUs") == kExposureUs));
+
+  // apply() reads all variables but only writes the changed one
+  control.getStatistics().reset();
+  VISIONARY_CHECK(loaded.apply(control) == 1);
+  std::vector<std::string> written;
+  std::uint64_t            numReads = 0u;
+  for (const CommandStatistics::CommandSnapshot& command : control.getStatistics().snapshot().commands)
+  {
+    if ((command.command.compare(0u, 4u, "sWN ") == 0) && (command.latency.count > 0u))
+    {
+      written.push_back(command.command);
+    }
+    numReads += (command.command.compare(0u, 4u, "sRN ") == 0) ? command.latency.count : 0u;
+  }
+  VISIONARY_CHECK(written == std::vector<std::string>(1u, "sWN integrationTimeUs"));
+  VISIONARY_CHECK(numReads == kNames.size());
+
+  std::vector<std::uint8_t> value;
+  VISIONARY_CHECK(device.getVariable("integrationTimeUs", value) && (value == kExposureUs));
+  VISIONARY_CHECK(device.getVariable("frontendMode", value) && (value == kFrontendMode));
+  VISIONARY_CHECK(device.getVariable("LocationName", value) && (value == kLocationName));
+
+  VISIONARY_CHECK(loaded.apply(control) == 0);
+}
+
+void testRoundTripCoLaB()
+{
+  checkRoundTrip(VisionaryControl::ProtocolType::COLA_B);
+}
+
+void testRoundTripCoLa2()
+{
+  checkRoundTrip(VisionaryControl::ProtocolType::COLA_2);
+}
+
+void testWriteWithoutLogin()
+{
+  SimControlServer device(VisionaryControl::ProtocolType::COLA_2);
+  setupDevice(device);
+  if (!VISIONARY_CHECK(device.start(kAddress, kPort)))
+  {
+    return;
+  }
+
+  AsyncControl control;
+  if (!VISIONARY_CHECK(control.open(VisionaryControl::ProtocolType::COLA_2, kAddress, 2000u, kPort)))
+  {
+    return;
+  }
+
+  ConfigurationProfile desired;
+  desired.set("integrationTimeUs", {0x00u, 0x00u, 0x07u, 0xd0u});
+  desired.set("LocationName", kLocationName);
+  desired.set("missingVariable", {0x01u});
+
+  // the unknown variable fails the read, nothing is written
+  std::vector<std::string> failed;
+  VISIONARY_CHECK(desired.apply(control, &failed) == -1);
+  VISIONARY_CHECK(failed == std::vector<std::string>(1u, "missingVariable"));
+
+  desired.remove("missingVariable");
+  failed.clear();
+  VISIONARY_CHECK(desired.apply(control, &failed) == -1);
+  VISIONARY_CHECK(failed == std::vector<std::string>(1u, "integrationTimeUs"));
+
+  std::vector<std::uint8_t> value;
+  VISIONARY_CHECK(device.getVariable("integrationTimeUs", value) && (value == kExposureUs));
+}
+
+void testLoadSyntaxError()
+{
+  {
+    std::ofstream file(kProfileFile);
+    file << "# comment\n\nfrontendMode 00\nintegrationTimeUs 0x3e8\n";
+  }
+  ConfigurationProfile profile;
+  profile.set("LocationName", kLocationName);
+  VISIONARY_CHECK(!profile.load(kProfileFile));
+  std::remove(kProfileFile);
+  VISIONARY_CHECK((profile.size() == 1u) && (profile.find("LocationName") != nullptr));
+
+  VISIONARY_CHECK(!profile.load(kProfileFile));
+}
+
+} // namespace
+
+int main()
+{
+  TcpConnection::initSocketLibrary();
+
+  VISIONARY_RUN_TEST(testRoundTripCoLaB);
+  VISIONARY_RUN_TEST(testRoundTripCoLa2);
+  VISIONARY_RUN_TEST(testWriteWithoutLogin);
+  VISIONARY_RUN_TEST(testLoadSyntaxError);
+  return test::result();
+}
@@ -0,0 +1,212 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+#include "FrameStreamSync.h"
+#include "TestUtils.h"
+
+using namespace visionary;
+
+namespace {
+
+const std::uint64_t kIntervalMs = 33u;
+
+struct FakeFrame
+{
+  std::uint32_t frameNum;
+  std::uint64_t timestampMs;
+
+  std::uint32_t getFrameNum() const
+  {
+    return frameNum;
+  }
+
+  std::uint64_t getTimestampMS() const
+  {
+    return timestampMs;
+  }
+};
+
+/// Stream of queued frames; waiting for a frame that is not there only adds to waitedMs, nothing sleeps
+class FakeStream
+{
+public:
+  FakeStream() : m_waitedMs(0u)
+  {
+  }
+
+  void push(std::uint32_t frameNum)
+  {
+    push(frameNum, 1000u + frameNum * kIntervalMs);
+  }
+
+  void push(std::uint32_t frameNum, std::uint64_t timestampMs)
+  {
+    m_frames.push_back(std::make_shared<FakeFrame>(FakeFrame{frameNum, timestampMs}));
+  }
+
+  /// The frame is still on its way: only a caller that waits receives it
+  void pushInTransit(std::uint32_t frameNum)
+  {
+    m_inTransit.push_back(std::make_shared<FakeFrame>(FakeFrame{frameNum, 1000u + frameNum * kIntervalMs}));
+  }
+
+  FrameStreamSync<FakeFrame>::FrameSource source()
+  {
+    return [this](std::shared_ptr<FakeFrame>& pFrame, std::uint32_t timeoutMs) {
+      if (m_frames.empty() && !m_inTransit.empty() && (timeoutMs > 0u))
+      {
+        m_frames.push_back(m_inTransit.front());
+        m_inTransit.pop_front();
+        ++m_waitedMs;
+      }
+      if (m_frames.empty())
+      {
+        m_waitedMs += timeoutMs;
+        return false;
+      }
+      pFrame = m_frames.front();
+      m_frames.pop_front();
+      return true;
+    };
+  }
+
+  std::uint64_t getWaitedMs() const
+  {
+    return m_waitedMs;
+  }
+
+private:
+  std::deque<std::shared_ptr<FakeFrame>> m_frames;
+  std::deque<std::shared_ptr<FakeFrame>> m_inTransit;
+  std::uint64_t                          m_waitedMs;
+};
+
+void testFlushWhileNotStreaming()
+{
+  FakeStream                 stream;
+  FrameStreamSync<FakeFrame> sync(stream.source());
+  // without a known frame interval the whole maxWaitMs is waited for a frame in transit
+  VISIONARY_CHECK(sync.flush(200u) == 0u);
+  VISIONARY_CHECK((stream.getWaitedMs() > 0u) && (stream.getWaitedMs() <= 200u));
+}
+
+void testFlushCatchesFrameInTransit()
+{
+  FakeStream                 stream;
+  FrameStreamSync<FakeFrame> sync(stream.source());
+  std::shared_ptr<FakeFrame> pFrame;
+  stream.push(1u);
+  stream.push(2u);
+  VISIONARY_CHECK(sync.getNextFrame(pFrame, 100u) && sync.getNextFrame(pFrame, 100u));
+
+  // stopped with nothing queued, the last frame taken is still on its way
+  stream.pushInTransit(3u);
+  VISIONARY_CHECK(sync.flush(1000u) == 1u);
+  VISIONARY_CHECK(stream.getWaitedMs() == 1u + 2u * kIntervalMs);
+
+  stream.push(3u);
+  stream.push(4u);
+  VISIONARY_CHECK(sync.getNextFrame(pFrame, 100u) && (pFrame->frameNum == 4u));
+}
+
+void testFlushWaitsTwoIntervals()
+{
+  FakeStream stream;
+  stream.push(1u);
+  stream.push(2u);
+  stream.push(3u);
+  FrameStreamSync<FakeFrame> sync(stream.source());
+  VISIONARY_CHECK(sync.flush(1000u) == 3u);
+  VISIONARY_CHECK(stream.getWaitedMs() == 2u * kIntervalMs);
+  VISIONARY_CHECK(sync.getDiscardedCount() == 3u);
+}
+
+void testFlushSingleFrameUsesKnownInterval()
+{
+  FakeStream                 stream;
+  FrameStreamSync<FakeFrame> sync(stream.source());
+  std::shared_ptr<FakeFrame> pFrame;
+  stream.push(1u);
+  stream.push(2u);
+  VISIONARY_CHECK(sync.getNextFrame(pFrame, 100u) && sync.getNextFrame(pFrame, 100u));
+
+  stream.push(3u);
+  VISIONARY_CHECK(sync.flush(1000u) == 1u);
+  VISIONARY_CHECK(stream.getWaitedMs() == 2u * kIntervalMs);
+}
+
+void testFlushSingleFrameWaitsAtMostMaxWait()
+{
+  FakeStream stream;
+  stream.push(1u);
+  FrameStreamSync<FakeFrame> sync(stream.source());
+  VISIONARY_CHECK(sync.flush(200u) == 1u);
+  VISIONARY_CHECK((stream.getWaitedMs() > 0u) && (stream.getWaitedMs() <= 200u));
+}
+
+void testLateFramesSkipped()
+{
+  FakeStream stream;
+  stream.push(10u);
+  stream.push(11u);
+  FrameStreamSync<FakeFrame> sync(stream.source());
+  sync.flush(0u);
+
+  stream.push(11u);
+  stream.push(9u);
+  stream.push(12u);
+  std::shared_ptr<FakeFrame> pFrame;
+  VISIONARY_CHECK(sync.getNextFrame(pFrame, 100u) && (pFrame->frameNum == 12u));
+  VISIONARY_CHECK(sync.getDiscardedCount() == 4u);
+}
+
+void testFrameCounterRestart()
+{
+  FakeStream stream;
+  stream.push(5000u);
+  stream.push(5001u);
+  FrameStreamSync<FakeFrame> sync(stream.source());
+  sync.flush(0u);
+
+  // the device restarted its frame counter, e.g. after a reboot
+  stream.push(0u, 10u);
+  stream.push(1u, 10u + kIntervalMs);
+  std::shared_ptr<FakeFrame> pFrame;
+  VISIONARY_CHECK(sync.getNextFrame(pFrame, 100u) && (pFrame->frameNum == 0u));
+  VISIONARY_CHECK(sync.getNextFrame(pFrame, 100u) && (pFrame->frameNum == 1u));
+  VISIONARY_CHECK(sync.getDiscardedCount() == 2u);
+}
+
+void testFrameNumberWrapAround()
+{
+  FakeStream stream;
+  stream.push(0xFFFFFFFEu, 1000u);
+  stream.push(0xFFFFFFFFu, 1000u + kIntervalMs);
+  FrameStreamSync<FakeFrame> sync(stream.source());
+  sync.flush(0u);
+
+  stream.push(0u, 1000u + 2u * kIntervalMs);
+  std::shared_ptr<FakeFrame> pFrame;
+  VISIONARY_CHECK(sync.getNextFrame(pFrame, 100u) && (pFrame->frameNum == 0u));
+}
+
+} // namespace
+
+int main()
+{
+  VISIONARY_RUN_TEST(testFlushWhileNotStreaming);
+  VISIONARY_RUN_TEST(testFlushCatchesFrameInTransit);
+  VISIONARY_RUN_TEST(testFlushWaitsTwoIntervals);
+  VISIONARY_RUN_TEST(testFlushSingleFrameUsesKnownInterval);
+  VISIONARY_RUN_TEST(testFlushSingleFrameWaitsAtMostMaxWait);
+  VISIONARY_RUN_TEST(testLateFramesSkipped);
+  VISIONARY_RUN_TEST(testFrameCounterRestart);
+  VISIONARY_RUN_TEST(testFrameNumberWrapAround);
+  return test::result();
+}
@@ -0,0 +1,207 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "LatencyHistogram.h"
+#include "TestUtils.h"
+
+using namespace visionary;
+
+namespace {
+
+const double kPercentiles[] = {0., 1., 10., 25., 50., 75., 90., 99., 99.9, 100.};
+
+/// The p-th percentile as defined by LatencyHistogram::Snapshot::percentile(), from the sorted samples
+std::uint64_t exactPercentile(const std::vector<std::uint64_t>& sorted, double p)
+{
+  const std::size_t rank =
+    std::max<std::size_t>(static_cast<std::size_t>(p / 100. * static_cast<double>(sorted.size()) + 0.5), 1u);
+  return sorted[rank - 1u];
+}
+
+/// Records the samples and checks count, min, max, sum and that every percentile is at most one bucket width
+/// (1/32 of the value) above the exact one
+void checkDistribution(std::vector<std::uint64_t> samples)
+{
+  LatencyHistogram histogram;
+  std::uint64_t    sumUs = 0u;
+  for (const std::uint64_t valueUs : samples)
+  {
+    histogram.record(valueUs);
+    sumUs += valueUs;
+  }
+  std::sort(samples.begin(), samples.end());
+
+  const LatencyHistogram::Snapshot snapshot = histogram.snapshot();
+  VISIONARY_CHECK(snapshot.count == samples.size());
+  VISIONARY_CHECK((snapshot.minUs == samples.front()) && (snapshot.maxUs == samples.back()));
+  VISIONARY_CHECK(snapshot.sumUs == sumUs);
+  for (const double p : kPercentiles)
+  {
+    const std::uint64_t exact     = exactPercentile(samples, p);
+    const std::uint64_t estimated = snapshot.percentile(p);
+    VISIONARY_CHECK((estimated >= exact) && (estimated <= exact + exact / 32u));
+  }
+}
+
+void testEmpty()
+{
+  LatencyHistogram                 histogram;
+  const LatencyHistogram::Snapshot snapshot = histogram.snapshot();
+  VISIONARY_CHECK(snapshot.count == 0u);
+  VISIONARY_CHECK((snapshot.minUs == 0u) && (snapshot.maxUs == 0u));
+  VISIONARY_CHECK(snapshot.percentile(50.) == 0u);
+  VISIONARY_CHECK(std::fabs(snapshot.mean()) < 1e-9);
+}
+
+void testSmallValuesExact()
+{
+  // below 64 us every value has its own bucket
+  LatencyHistogram histogram;
+  for (std::uint64_t valueUs = 1u; valueUs <= 50u; ++valueUs)
+  {
+    histogram.record(valueUs);
+  }
+  const LatencyHistogram::Snapshot snapshot = histogram.snapshot();
+  VISIONARY_CHECK(snapshot.percentile(0.) == 1u);
+  VISIONARY_CHECK(snapshot.percentile(50.) == 25u);
+  VISIONARY_CHECK(snapshot.percentile(90.) == 45u);
+  VISIONARY_CHECK(snapshot.percentile(100.) == 50u);
+  VISIONARY_CHECK(std::fabs(snapshot.mean() - 25.5) < 1e-9);
+}
+
+void testUniform()
+{
+  std::vector<std::uint64_t> samples;
+  for (std::uint64_t valueUs = 1u; valueUs <= 100000u; ++valueUs)
+  {
+    samples.push_back(valueUs);
+  }
+  checkDistribution(samples);
+}
+
+void testExponential()
+{
+  std::mt19937                          rng(42u);
+  std::exponential_distribution<double> distribution(1. / 2000.); // mean 2 ms
+  std::vector<std::uint64_t>            samples;
+  for (int i = 0; i < 100000; ++i)
+  {
+    samples.push_back(static_cast<std::uint64_t>(distribution(rng)));
+  }
+  checkDistribution(samples);
+}
+
+void testLogNormalWithOutliers()
+{
+  // typical network round trips: a log-normal body around 500 us and a few timeouts of several seconds
+  std::mt19937                        rng(7u);
+  std::lognormal_distribution<double> distribution(std::log(500.), 0.5);
+  std::vector<std::uint64_t>          samples;
+  for (int i = 0; i < 100000; ++i)
+  {
+    samples.push_back(static_cast<std::uint64_t>(distribution(rng)));
+  }
+  samples.insert(samples.end(), 10u, 5000000u);
+  checkDistribution(samples);
+}
+
+void testBucketBounds()
+{
+  for (std::size_t i = 0u; i + 1u < LatencyHistogram::kNumBuckets; ++i)
+  {
+    const std::uint64_t upperBound = LatencyHistogram::getBucketUpperBound(i);
+    if (!VISIONARY_CHECK(LatencyHistogram::getBucketIndex(upperBound) == i)
+        || !VISIONARY_CHECK(LatencyHistogram::getBucketIndex(upperBound + 1u) == i + 1u))
+    {
+      return;
+    }
+  }
+  // values beyond the range end up in the last bucket, max still reports them
+  LatencyHistogram    histogram;
+  const std::uint64_t hugeUs = std::uint64_t(1u) << 40u;
+  histogram.record(hugeUs);
+  VISIONARY_CHECK(LatencyHistogram::getBucketIndex(hugeUs) == LatencyHistogram::kNumBuckets - 1u);
+  VISIONARY_CHECK(histogram.snapshot().maxUs == hugeUs);
+}
+
+void testMerge()
+{
+  LatencyHistogram first;
+  LatencyHistogram second;
+  LatencyHistogram all;
+  for (std::uint64_t valueUs = 100u; valueUs < 200u; ++valueUs)
+  {
+    first.record(valueUs);
+    all.record(valueUs);
+  }
+  for (std::uint64_t valueUs = 10000u; valueUs < 10100u; ++valueUs)
+  {
+    second.record(valueUs);
+    all.record(valueUs);
+  }
+
+  LatencyHistogram::Snapshot merged;
+  merged.merge(second.snapshot());
+  merged.merge(first.snapshot());
+  const LatencyHistogram::Snapshot expected = all.snapshot();
+  VISIONARY_CHECK(merged.counts == expected.counts);
+  VISIONARY_CHECK((merged.count == 200u) && (merged.sumUs == expected.sumUs));
+  VISIONARY_CHECK((merged.minUs == 100u) && (merged.maxUs == 10099u));
+  VISIONARY_CHECK(merged.percentile(50.) == expected.percentile(50.));
+}
+
+void testConcurrentRecord()
+{
+  const unsigned kNumThreads = 4u;
+  const unsigned kNumSamples = 100000u;
+
+  LatencyHistogram         histogram;
+  std::vector<std::thread> threads;
+  for (unsigned t = 0u; t < kNumThreads; ++t)
+  {
+    threads.emplace_back([&histogram, t]() {
+      for (unsigned i = 0u; i < kNumSamples; ++i)
+      {
+        histogram.record(t * kNumSamples + i + 1u);
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+  {
+    thread.join();
+  }
+
+  const LatencyHistogram::Snapshot snapshot = histogram.snapshot();
+  std::uint64_t                    sum      = 0u;
+  for (const std::uint64_t count : snapshot.counts)
+  {
+    sum += count;
+  }
+  VISIONARY_CHECK((snapshot.count == kNumThreads * kNumSamples) && (sum == snapshot.count));
+  VISIONARY_CHECK((snapshot.minUs == 1u) && (snapshot.maxUs == kNumThreads * kNumSamples));
+}
+
+} // namespace
+
+int main()
+{
+  VISIONARY_RUN_TEST(testEmpty);
+  VISIONARY_RUN_TEST(testSmallValuesExact);
+  VISIONARY_RUN_TEST(testUniform);
+  VISIONARY_RUN_TEST(testExponential);
+  VISIONARY_RUN_TEST(testLogNormalWithOutliers);
+  VISIONARY_RUN_TEST(testBucketBounds);
+  VISIONARY_RUN_TEST(testMerge);
+  VISIONARY_RUN_TEST(testConcurrentRecord);
+  return test::result();
+}
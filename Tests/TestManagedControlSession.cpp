@@ -0,0 +1,97 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "CoLaError.h"
+#include "CoLaParameterWriter.h"
+#include "ManagedControlSession.h"
+#include "SimControlServer.h"
+#include "TcpConnection.h"
+#include "TestUtils.h"
+
+using namespace visionary;
+
+namespace {
+
+const char          kAddress[] = "127.0.0.1";
+const std::uint16_t kPort      = 42124u;
+
+void testLoginIsCached()
+{
+  SimControlServer device(VisionaryControl::ProtocolType::COLA_2);
+  device.setVariable("ExampleVariable", {0x00u});
+  device.setWriteLevel("ExampleVariable", IAuthentication::UserLevel::SERVICE);
+  if (!VISIONARY_CHECK(device.start(kAddress, kPort)))
+  {
+    return;
+  }
+
+  ManagedControlSession session;
+  if (!VISIONARY_CHECK(session.open(VisionaryControl::ProtocolType::COLA_2, kAddress, 2000u, kPort)))
+  {
+    return;
+  }
+  VISIONARY_CHECK(session.login(IAuthentication::UserLevel::SERVICE, "CUST_SERV"));
+  VISIONARY_CHECK(session.login(IAuthentication::UserLevel::SERVICE, "CUST_SERV"));
+  VISIONARY_CHECK(session.login(IAuthentication::UserLevel::MAINTENANCE, "CUST_SERV"));
+  VISIONARY_CHECK(session.getLoginCount() == 1u);
+  VISIONARY_CHECK(device.getLoginCount() == 1u);
+
+  const CoLaCommand write =
+    CoLaParameterWriter(CoLaCommandType::WRITE_VARIABLE, "ExampleVariable").parameterUSInt(1u).build();
+  VISIONARY_CHECK(session.sendCommand(write).getError() == CoLaError::OK);
+
+  VISIONARY_CHECK(!session.login(IAuthentication::UserLevel::SERVICE, "wrong password"));
+  VISIONARY_CHECK(session.getLoginCount() == 2u);
+}
+
+void testStateNotLockedDuringLogin()
+{
+  const std::chrono::milliseconds kLoginDelay(300);
+
+  SimControlServer device(VisionaryControl::ProtocolType::COLA_2);
+  device.setCommandDelay("SetUserLevel", kLoginDelay);
+  if (!VISIONARY_CHECK(device.start(kAddress, kPort)))
+  {
+    return;
+  }
+
+  ManagedControlSession session;
+  session.setKeepaliveInterval(0u);
+  if (!VISIONARY_CHECK(session.open(VisionaryControl::ProtocolType::COLA_2, kAddress, 2000u, kPort)))
+  {
+    return;
+  }
+
+  bool        loggedIn = false;
+  std::thread loginThread(
+    [&session, &loggedIn]() { loggedIn = session.login(IAuthentication::UserLevel::SERVICE, "CUST_SERV"); });
+  std::this_thread::sleep_for(kLoginDelay / 3);
+
+  // the login is on the wire now; reading the state must not wait for it
+  const auto start     = std::chrono::steady_clock::now();
+  const bool connected = session.isConnected();
+  session.setKeepaliveVariable("DeviceIdent");
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  loginThread.join();
+
+  VISIONARY_CHECK(connected);
+  VISIONARY_CHECK(elapsed < kLoginDelay / 3);
+  VISIONARY_CHECK(loggedIn);
+}
+
+} // namespace
+
+int main()
+{
+  TcpConnection::initSocketLibrary();
+
+  VISIONARY_RUN_TEST(testLoginIsCached);
+  VISIONARY_RUN_TEST(testStateNotLockedDuringLogin);
+  return test::result();
+}
@@ -0,0 +1,95 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "MpscQueue.h"
+#include "TestUtils.h"
+
+using namespace visionary;
+
+namespace {
+
+void testFifo()
+{
+  MpscQueue<int> queue;
+  int            value = 0;
+  VISIONARY_CHECK(!queue.pop(value));
+  for (int i = 0; i < 10; ++i)
+  {
+    queue.push(i);
+  }
+  for (int i = 0; i < 10; ++i)
+  {
+    VISIONARY_CHECK(queue.pop(value) && (value == i));
+  }
+  VISIONARY_CHECK(!queue.pop(value));
+
+  // elements left in the queue are released by the destructor
+  queue.push(10);
+}
+
+void testOrderUnderContention()
+{
+  const unsigned kNumProducers = 4u;
+  const unsigned kNumItems     = 100000u;
+
+  // (producer, sequence number); the order between producers is arbitrary, the order of each producer is not
+  MpscQueue<std::pair<unsigned, unsigned>> queue;
+  std::atomic<bool>                        start(false);
+  std::vector<std::thread>                 producers;
+  for (unsigned producer = 0u; producer < kNumProducers; ++producer)
+  {
+    producers.emplace_back([&queue, &start, producer]() {
+      while (!start)
+      {
+        std::this_thread::yield();
+      }
+      for (unsigned n = 0u; n < kNumItems; ++n)
+      {
+        queue.push(std::make_pair(producer, n));
+      }
+    });
+  }
+  start = true;
+
+  std::vector<unsigned>         expected(kNumProducers, 0u);
+  unsigned                      received = 0u;
+  bool                          inOrder  = true;
+  std::pair<unsigned, unsigned> item;
+  while (received < kNumProducers * kNumItems)
+  {
+    if (!queue.pop(item))
+    {
+      std::this_thread::yield();
+      continue;
+    }
+    inOrder = inOrder && (item.first < kNumProducers) && (item.second == expected[item.first]);
+    if (item.first < kNumProducers)
+    {
+      ++expected[item.first];
+    }
+    ++received;
+  }
+  for (std::thread& producer : producers)
+  {
+    producer.join();
+  }
+
+  VISIONARY_CHECK(inOrder);
+  VISIONARY_CHECK(!queue.pop(item));
+}
+
+} // namespace
+
+int main()
+{
+  VISIONARY_RUN_TEST(testFifo);
+  VISIONARY_RUN_TEST(testOrderUnderContention);
+  return test::result();
+}
@@ -0,0 +1,115 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CoLaError.h"
+#include "CoLaParameterWriter.h"
+#include "SharedControlSession.h"
+#include "SimControlServer.h"
+#include "TcpConnection.h"
+#include "TestUtils.h"
+
+using namespace visionary;
+
+namespace {
+
+const char          kAddress[] = "127.0.0.1";
+const std::uint16_t kPort      = 42123u;
+
+void checkLogin(VisionaryControl::ProtocolType protocol)
+{
+  SimControlServer device(protocol);
+  device.setVariable("ExampleVariable", {0x00u});
+  device.setWriteLevel("ExampleVariable", IAuthentication::UserLevel::SERVICE);
+  if (!VISIONARY_CHECK(device.start(kAddress, kPort)))
+  {
+    return;
+  }
+
+  SharedControlSession session;
+  if (!VISIONARY_CHECK(session.open(protocol, kAddress, 2000u, kPort)))
+  {
+    return;
+  }
+  const CoLaCommand write =
+    CoLaParameterWriter(CoLaCommandType::WRITE_VARIABLE, "ExampleVariable").parameterUSInt(1u).build();
+
+  VISIONARY_CHECK(!session.login(IAuthentication::UserLevel::SERVICE, "wrong password"));
+  VISIONARY_CHECK(session.sendCommand(write).getError() != CoLaError::OK);
+
+  VISIONARY_CHECK(session.login(IAuthentication::UserLevel::SERVICE, "CUST_SERV"));
+  VISIONARY_CHECK(session.sendCommand(write).getError() == CoLaError::OK);
+  VISIONARY_CHECK(device.getLoginCount() == 1u);
+}
+
+void testLoginCoLaB()
+{
+  checkLogin(VisionaryControl::ProtocolType::COLA_B);
+}
+
+void testLoginCoLa2()
+{
+  checkLogin(VisionaryControl::ProtocolType::COLA_2);
+}
+
+void testCloseWhileSubmitting()
+{
+  SimControlServer device(VisionaryControl::ProtocolType::COLA_2);
+  device.setVariable("DeviceIdent", {0x00u, 0x02u, 'T', 'M'});
+  if (!VISIONARY_CHECK(device.start(kAddress, kPort)))
+  {
+    return;
+  }
+
+  std::unique_ptr<SharedControlSession> pSession(new SharedControlSession);
+  if (!VISIONARY_CHECK(pSession->open(VisionaryControl::ProtocolType::COLA_2, kAddress, 2000u, kPort)))
+  {
+    return;
+  }
+
+  // producers keep submitting while the session is closed; every command must complete, sent or not
+  const unsigned           kNumProducers = 4u;
+  const unsigned           kNumCommands  = 200u;
+  std::atomic<unsigned>    completed(0u);
+  std::vector<std::thread> producers;
+  for (unsigned i = 0u; i < kNumProducers; ++i)
+  {
+    producers.emplace_back([&]() {
+      for (unsigned n = 0u; n < kNumCommands; ++n)
+      {
+        pSession->sendCommandAsync(CoLaParameterWriter(CoLaCommandType::READ_VARIABLE, "DeviceIdent").build(),
+                                   SharedControlSession::Lane::NORMAL,
+                                   [&completed](CoLaCommand&) { ++completed; });
+      }
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  pSession->close();
+  for (std::thread& producer : producers)
+  {
+    producer.join();
+  }
+  VISIONARY_CHECK(completed == kNumProducers * kNumCommands);
+  VISIONARY_CHECK(!pSession->isConnected());
+}
+
+} // namespace
+
+int main()
+{
+  TcpConnection::initSocketLibrary();
+
+  VISIONARY_RUN_TEST(testLoginCoLaB);
+  VISIONARY_RUN_TEST(testLoginCoLa2);
+  VISIONARY_RUN_TEST(testCloseWhileSubmitting);
+  return test::result();
+}
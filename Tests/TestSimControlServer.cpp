@@ -0,0 +1,193 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+// Checks the CoLa 2 telegrams of the simulated device on the wire, with hand-written requests instead of the codec
+// of base/, so a framing bug shared by client and simulator can't cancel out.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SimControlServer.h"
+#include "TcpConnection.h"
+#include "TestUtils.h"
+
+using namespace visionary;
+
+namespace {
+
+const char          kAddress[]  = "127.0.0.1";
+const std::uint16_t kPort       = 42122u;
+const std::uint32_t kTimeoutMs  = 2000u;
+const std::size_t   kHeaderSize = 16u; // magic, length, HubCntr, NoC, session id, request id
+
+std::vector<std::uint8_t> makeCoLa2Telegram(std::uint32_t sessionId, std::uint16_t requestId, const std::string& body)
+{
+  const std::uint32_t       length   = static_cast<std::uint32_t>(body.size() + 8u);
+  std::vector<std::uint8_t> telegram = {0x02u,
+                                        0x02u,
+                                        0x02u,
+                                        0x02u,
+                                        static_cast<std::uint8_t>(length >> 24u),
+                                        static_cast<std::uint8_t>(length >> 16u),
+                                        static_cast<std::uint8_t>(length >> 8u),
+                                        static_cast<std::uint8_t>(length),
+                                        0x00u,
+                                        0x00u,
+                                        static_cast<std::uint8_t>(sessionId >> 24u),
+                                        static_cast<std::uint8_t>(sessionId >> 16u),
+                                        static_cast<std::uint8_t>(sessionId >> 8u),
+                                        static_cast<std::uint8_t>(sessionId),
+                                        static_cast<std::uint8_t>(requestId >> 8u),
+                                        static_cast<std::uint8_t>(requestId)};
+  telegram.insert(telegram.end(), body.begin(), body.end());
+  return telegram;
+}
+
+std::uint32_t getUInt32(const std::vector<std::uint8_t>& telegram, std::size_t offset)
+{
+  std::uint32_t value = 0u;
+  for (std::size_t i = offset; i < offset + 4u; ++i)
+  {
+    value = (value << 8u) | telegram[i];
+  }
+  return value;
+}
+
+/// Receives one CoLa 2 telegram
+bool receiveTelegram(TcpConnection& connection, std::vector<std::uint8_t>& telegram)
+{
+  telegram.clear();
+  std::size_t expectedSize = kHeaderSize;
+  while (telegram.size() < expectedSize)
+  {
+    std::uint8_t      buffer[256];
+    const std::size_t size     = std::min(sizeof(buffer), expectedSize - telegram.size());
+    const int         received = connection.recv(buffer, size, kTimeoutMs);
+    if (received <= 0)
+    {
+      return false;
+    }
+    telegram.insert(telegram.end(), buffer, buffer + received);
+    if (telegram.size() >= 8u)
+    {
+      expectedSize = 8u + getUInt32(telegram, 4u);
+    }
+  }
+  return true;
+}
+
+/// Opens the session like CoLa2ProtocolHandler::openSession(), returns the session id (0 on failure)
+std::uint32_t openSession(TcpConnection& connection)
+{
+  const std::string               body    = std::string("Ox") + '\x05' + '\x00' + '\x04' + "test";
+  const std::vector<std::uint8_t> request = makeCoLa2Telegram(0u, 1u, body);
+  std::vector<std::uint8_t>       response;
+  if (!connection.send(request.data(), request.size()) || !receiveTelegram(connection, response))
+  {
+    return 0u;
+  }
+  const std::vector<std::uint8_t> expectedBody = {'O', 'A'};
+  if (!VISIONARY_CHECK(std::vector<std::uint8_t>(response.begin() + kHeaderSize, response.end()) == expectedBody))
+  {
+    return 0u;
+  }
+  return getUInt32(response, 10u);
+}
+
+void testTwoLetterCommandModes()
+{
+  SimControlServer device(VisionaryControl::ProtocolType::COLA_2);
+  device.setVariable("DeviceIdent", {0x00u, 0x02u, 'T', 'M'});
+  if (!VISIONARY_CHECK(device.start(kAddress, kPort)))
+  {
+    return;
+  }
+
+  TcpConnection connection;
+  if (!VISIONARY_CHECK(connection.connect(kAddress, kPort, kTimeoutMs)))
+  {
+    return;
+  }
+  const std::uint32_t sessionId = openSession(connection);
+  VISIONARY_CHECK(sessionId != 0u);
+
+  const std::vector<std::uint8_t> request = makeCoLa2Telegram(sessionId, 0x1234u, "RN DeviceIdent");
+  std::vector<std::uint8_t>       response;
+  VISIONARY_CHECK(connection.send(request.data(), request.size()));
+  if (!VISIONARY_CHECK(receiveTelegram(connection, response)))
+  {
+    return;
+  }
+  const std::vector<std::uint8_t> expected =
+    makeCoLa2Telegram(sessionId, 0x1234u, std::string("RA DeviceIdent ") + '\x00' + '\x02' + "TM");
+  VISIONARY_CHECK(response == expected);
+}
+
+void testCoLaBCommandModeRejected()
+{
+  SimControlServer device(VisionaryControl::ProtocolType::COLA_2);
+  device.setVariable("DeviceIdent", {0x00u, 0x02u, 'T', 'M'});
+  if (!VISIONARY_CHECK(device.start(kAddress, kPort)))
+  {
+    return;
+  }
+
+  TcpConnection connection;
+  if (!VISIONARY_CHECK(connection.connect(kAddress, kPort, kTimeoutMs)))
+  {
+    return;
+  }
+  const std::uint32_t sessionId = openSession(connection);
+
+  // "sRN" is not a CoLa 2 command mode; a device answers with an error (0x000c: unknown command)
+  const std::vector<std::uint8_t> request = makeCoLa2Telegram(sessionId, 2u, "sRN DeviceIdent");
+  std::vector<std::uint8_t>       response;
+  VISIONARY_CHECK(connection.send(request.data(), request.size()));
+  if (!VISIONARY_CHECK(receiveTelegram(connection, response)))
+  {
+    return;
+  }
+  VISIONARY_CHECK(response == makeCoLa2Telegram(sessionId, 2u, std::string("FA") + '\x00' + '\x0c'));
+}
+
+void testDisconnectedClientsReaped()
+{
+  SimControlServer device(VisionaryControl::ProtocolType::COLA_2);
+  if (!VISIONARY_CHECK(device.start(kAddress, kPort)))
+  {
+    return;
+  }
+
+  for (int i = 0; i < 5; ++i)
+  {
+    TcpConnection connection;
+    VISIONARY_CHECK(connection.connect(kAddress, kPort, kTimeoutMs));
+  }
+  TcpConnection connection;
+  VISIONARY_CHECK(connection.connect(kAddress, kPort, kTimeoutMs));
+
+  // only the open connection is left once the accept loop noticed the others are gone
+  for (int retry = 0; (retry < 100) && (device.getClientCount() != 1u); ++retry)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  VISIONARY_CHECK(device.getClientCount() == 1u);
+}
+
+} // namespace
+
+int main()
+{
+  TcpConnection::initSocketLibrary();
+
+  VISIONARY_RUN_TEST(testTwoLetterCommandModes);
+  VISIONARY_RUN_TEST(testCoLaBCommandModeRejected);
+  VISIONARY_RUN_TEST(testDisconnectedClientsReaped);
+  return test::result();
+}
@@ -0,0 +1,106 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "BlobEncoder.h"
+#include "TcpConnection.h"
+#include "TestUtils.h"
+#include "TracedDataStream.h"
+#include "VisionaryTMiniData.h"
+
+using namespace visionary;
+
+namespace {
+
+const char          kAddress[] = "127.0.0.1";
+const std::uint16_t kPort      = 42127u;
+
+std::vector<std::uint8_t> encodeFrame(std::uint32_t frameNumber)
+{
+  const BlobEncoder encoder(BlobEncoder::DeviceType::VISIONARY_T_MINI, 512u, 424u);
+
+  SimFrame frame;
+  frame.frameNumber = frameNumber;
+  frame.timestampMs = 1700000000000u;
+  encoder.prepareFrame(frame);
+
+  std::vector<std::uint8_t> packet;
+  encoder.encode(frame, packet);
+  return packet;
+}
+
+/// Connects stream to a local listener and returns the device side of the connection
+bool connect(TcpListener& listener, TracedDataStream& stream, TcpConnection& device)
+{
+  return VISIONARY_CHECK(listener.listen(kAddress, kPort)) && VISIONARY_CHECK(stream.open(kAddress, kPort, 2000u))
+         && VISIONARY_CHECK(listener.accept(device, 2000u) == 1);
+}
+
+void testTimeoutKeepsPartialTelegram()
+{
+  TcpListener      listener;
+  TcpConnection    device;
+  TracedDataStream stream(std::make_shared<VisionaryTMiniData>());
+  if (!connect(listener, stream, device))
+  {
+    return;
+  }
+
+  // the frame arrives in two parts, the first call times out in between
+  const std::vector<std::uint8_t> packet = encodeFrame(17u);
+  const std::size_t               split  = packet.size() / 2u;
+  VISIONARY_CHECK(device.send(packet.data(), split));
+  VISIONARY_CHECK(!stream.getNextFrame(50u));
+  VISIONARY_CHECK(stream.isConnected());
+
+  VISIONARY_CHECK(device.send(packet.data() + split, packet.size() - split));
+  VISIONARY_CHECK(stream.getNextFrame(2000u));
+  VISIONARY_CHECK(stream.getDataHandler()->getFrameNum() == 17u);
+  VISIONARY_CHECK((stream.getFrameCount() == 1u) && (stream.getInvalidCount() == 0u));
+
+  // a timeout within the header works the same way
+  const std::vector<std::uint8_t> next = encodeFrame(18u);
+  VISIONARY_CHECK(device.send(next.data(), 6u));
+  VISIONARY_CHECK(!stream.getNextFrame(50u));
+  VISIONARY_CHECK(device.send(next.data() + 6u, next.size() - 6u));
+  VISIONARY_CHECK(stream.getNextFrame(2000u));
+  VISIONARY_CHECK(stream.getDataHandler()->getFrameNum() == 18u);
+  VISIONARY_CHECK(stream.getDroppedCount() == 0u);
+}
+
+void testResyncAfterImplausibleLength()
+{
+  TcpListener      listener;
+  TcpConnection    device;
+  TracedDataStream stream(std::make_shared<VisionaryTMiniData>());
+  if (!connect(listener, stream, device))
+  {
+    return;
+  }
+
+  // garbage, then a header whose length is far beyond any device, then the next telegram
+  std::vector<std::uint8_t>       data   = {0x55u, 0x02u, 0x02u, 0x02u, 0x02u, 0x7fu, 0xffu, 0xffu, 0xffu, 0x00u};
+  const std::vector<std::uint8_t> packet = encodeFrame(42u);
+  data.insert(data.end(), packet.begin(), packet.end());
+  VISIONARY_CHECK(device.send(data.data(), data.size()));
+
+  VISIONARY_CHECK(stream.getNextFrame(2000u));
+  VISIONARY_CHECK(stream.getDataHandler()->getFrameNum() == 42u);
+  VISIONARY_CHECK((stream.getFrameCount() == 1u) && (stream.getInvalidCount() == 1u));
+}
+
+} // namespace
+
+int main()
+{
+  TcpConnection::initSocketLibrary();
+
+  VISIONARY_RUN_TEST(testTimeoutKeepsPartialTelegram);
+  VISIONARY_RUN_TEST(testResyncAfterImplausibleLength);
+  return test::result();
+}
@@ -0,0 +1,52 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstdio>
+
+namespace visionary {
+namespace test {
+
+/// Number of failed checks of the test program
+inline int& failureCount()
+{
+  static int count = 0;
+  return count;
+}
+
+/// Records and prints a failed check
+///
+/// \return the checked condition, so a test can stop early on a failed precondition
+inline bool check(bool condition, const char* expression, const char* file, int line)
+{
+  if (!condition)
+  {
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+    ++failureCount();
+  }
+  return condition;
+}
+
+/// Runs one test case and prints its name
+inline void run(const char* name, void (*pTest)())
+{
+  const int failuresBefore = failureCount();
+  pTest();
+  std::printf("%-48s %s\n", name, (failureCount() == failuresBefore) ? "passed" : "FAILED");
+}
+
+/// Exit code of the test program: 0 if all checks passed
+inline int result()
+{
+  return (failureCount() == 0) ? 0 : 1;
+}
+
+} // namespace test
+} // namespace visionary
+
+#define VISIONARY_CHECK(condition) ::visionary::test::check((condition), #condition, __FILE__, __LINE__)
+
+#define VISIONARY_RUN_TEST(testFunction) ::visionary::test::run(#testFunction, &testFunction)
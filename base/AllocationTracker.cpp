@@ -0,0 +1,218 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "AllocationTracker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+namespace visionary {
+
+namespace {
+
+const std::size_t kOtherStage = kNumFrameStages;
+const std::size_t kNumSlots   = kNumFrameStages + 1u; // the stages and "other"
+
+/// Counts of the current frame
+struct FrameCounts
+{
+  std::atomic<std::uint64_t> allocations;
+  std::atomic<std::uint64_t> bytes;
+};
+
+// zero-initialized before any dynamic initialization, so allocations of static constructors are counted, too
+FrameCounts                g_frameCounts[kNumSlots];
+std::atomic<std::uint64_t> g_totalAllocations;
+std::atomic<std::uint64_t> g_totalBytes;
+
+thread_local std::size_t t_stage = kOtherStage;
+
+/// Report of the completed frames; endFrame(), getReport() and reset() are serialized by the mutex
+struct ReportState
+{
+  std::mutex                                            mutex;
+  std::uint64_t                                         frames = 0u;
+  std::array<AllocationTracker::StageCounts, kNumSlots> stages;
+};
+
+ReportState& getReportState()
+{
+  static ReportState state;
+  return state;
+}
+
+#if defined(VISIONARY_ENABLE_ALLOCATION_TRACKING)
+
+void* allocate(std::size_t size)
+{
+  FrameCounts& counts = g_frameCounts[t_stage];
+  counts.allocations.fetch_add(1u, std::memory_order_relaxed);
+  counts.bytes.fetch_add(size, std::memory_order_relaxed);
+  g_totalAllocations.fetch_add(1u, std::memory_order_relaxed);
+  g_totalBytes.fetch_add(size, std::memory_order_relaxed);
+  return std::malloc((size == 0u) ? 1u : size);
+}
+
+#endif
+
+void appendLine(std::string& text, const char* name, const AllocationTracker::StageCounts& counts, double frames)
+{
+  char line[128];
+  std::snprintf(line,
+                sizeof(line),
+                "%-16s %14.2f %14.0f %14llu\n",
+                name,
+                static_cast<double>(counts.allocations) / frames,
+                static_cast<double>(counts.bytes) / frames,
+                static_cast<unsigned long long>(counts.maxAllocations));
+  text += line;
+}
+
+} // namespace
+
+bool AllocationTracker::isAvailable()
+{
+#if defined(VISIONARY_ENABLE_ALLOCATION_TRACKING)
+  return true;
+#else
+  return false;
+#endif
+}
+
+std::size_t AllocationTracker::setStage(std::size_t stage)
+{
+  const std::size_t previousStage = t_stage;
+  t_stage                         = std::min(stage, kOtherStage);
+  return previousStage;
+}
+
+void AllocationTracker::endFrame()
+{
+  ReportState&                state = getReportState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  ++state.frames;
+  for (std::size_t i = 0u; i < kNumSlots; ++i)
+  {
+    const std::uint64_t allocations = g_frameCounts[i].allocations.exchange(0u, std::memory_order_relaxed);
+    const std::uint64_t bytes       = g_frameCounts[i].bytes.exchange(0u, std::memory_order_relaxed);
+    StageCounts&        counts      = state.stages[i];
+    counts.allocations += allocations;
+    counts.bytes += bytes;
+    counts.maxAllocations = std::max(counts.maxAllocations, allocations);
+  }
+}
+
+AllocationTracker::Report AllocationTracker::getReport()
+{
+  ReportState&                state = getReportState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  Report                      report;
+  report.frames = state.frames;
+  std::copy(state.stages.begin(), state.stages.begin() + kNumFrameStages, report.stages.begin());
+  report.other = state.stages[kOtherStage];
+  return report;
+}
+
+void AllocationTracker::reset()
+{
+  ReportState&                state = getReportState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.frames = 0u;
+  state.stages.fill(StageCounts());
+  for (FrameCounts& counts : g_frameCounts)
+  {
+    counts.allocations = 0u;
+    counts.bytes       = 0u;
+  }
+}
+
+std::uint64_t AllocationTracker::getAllocationCount()
+{
+  return g_totalAllocations.load(std::memory_order_relaxed);
+}
+
+std::uint64_t AllocationTracker::getAllocatedBytes()
+{
+  return g_totalBytes.load(std::memory_order_relaxed);
+}
+
+std::string AllocationTracker::format(const Report& report)
+{
+  std::string text;
+  char        line[128];
+
+  if (report.frames == 0u)
+  {
+    return "no frames\n";
+  }
+  std::snprintf(
+    line, sizeof(line), "heap allocations in %llu frames\n", static_cast<unsigned long long>(report.frames));
+  text += line;
+  std::snprintf(line, sizeof(line), "%-16s %14s %14s %14s\n", "stage", "allocs/frame", "bytes/frame", "max allocs");
+  text += line;
+
+  const double frames = static_cast<double>(report.frames);
+  for (std::size_t i = 0u; i < kNumFrameStages; ++i)
+  {
+    appendLine(text, getFrameStageName(static_cast<FrameStage>(i)), report.stages[i], frames);
+  }
+  appendLine(text, "other", report.other, frames);
+  return text;
+}
+
+} // namespace visionary
+
+#if defined(VISIONARY_ENABLE_ALLOCATION_TRACKING)
+
+void* operator new(std::size_t size)
+{
+  void* p = visionary::allocate(size);
+  if (p == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void* operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  return visionary::allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+  return visionary::allocate(size);
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+  std::free(p);
+}
+
+#endif
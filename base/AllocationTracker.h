@@ -0,0 +1,92 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "FrameTrace.h"
+
+namespace visionary {
+
+/// Heap allocations per frame and pipeline stage
+///
+/// Profiling mode: when the library is built with VISIONARY_ENABLE_ALLOCATION_TRACKING (CMake option
+/// VISIONARY_SAMPLES_ENABLE_ALLOCATION_TRACKING), AllocationTracker.cpp replaces the global operator new of every
+/// program using the tracker. Each allocation is counted for the pipeline stage the allocating thread is in (see
+/// AllocationScope), or as "other" outside of any scope. The frame loop calls endFrame() once per frame, which adds
+/// the counts of the frame to the report. Without the option nothing is counted and isAvailable() returns false.
+///
+/// Counting costs two relaxed atomic increments per allocation; the tracker itself does not allocate.
+class AllocationTracker
+{
+public:
+  struct StageCounts
+  {
+    std::uint64_t allocations    = 0u; ///< allocations in all frames
+    std::uint64_t bytes          = 0u; ///< bytes requested in all frames
+    std::uint64_t maxAllocations = 0u; ///< most allocations in a single frame
+  };
+
+  struct Report
+  {
+    std::uint64_t                            frames = 0u;
+    std::array<StageCounts, kNumFrameStages> stages; ///< allocations attributed to the pipeline stages
+    StageCounts                              other;  ///< allocations outside of any AllocationScope
+  };
+
+  /// Whether the counting operator new is compiled in
+  static bool isAvailable();
+
+  /// Sets the stage the allocations of the calling thread are attributed to
+  ///
+  /// \param[in] stage stage index (static_cast<std::size_t>(FrameStage)), kNumFrameStages for "other"
+  ///
+  /// \return the previous stage index of the thread
+  static std::size_t setStage(std::size_t stage);
+
+  /// Closes the current frame: adds the allocations counted since the previous call to the report
+  static void endFrame();
+
+  static Report getReport();
+
+  /// Discards the report and the counts of the current frame
+  static void reset();
+
+  /// Allocations of the whole process since start, independent of frames and stages
+  static std::uint64_t getAllocationCount();
+
+  /// Bytes requested from operator new since start
+  static std::uint64_t getAllocatedBytes();
+
+  /// Text table of a report: allocations and bytes per frame for every stage
+  static std::string format(const Report& report);
+};
+
+/// Attributes the allocations of the calling thread to a pipeline stage while in scope
+class AllocationScope
+{
+public:
+  explicit AllocationScope(FrameStage stage)
+    : m_previousStage(AllocationTracker::setStage(static_cast<std::size_t>(stage)))
+  {
+  }
+
+  ~AllocationScope()
+  {
+    AllocationTracker::setStage(m_previousStage);
+  }
+
+  AllocationScope(const AllocationScope&)            = delete;
+  AllocationScope& operator=(const AllocationScope&) = delete;
+
+private:
+  const std::size_t m_previousStage;
+};
+
+} // namespace visionary
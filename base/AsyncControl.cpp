@@ -0,0 +1,225 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "AsyncControl.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "CoLaLogin.h"
+
+namespace visionary {
+
+namespace {
+
+// the reader thread checks the stop flag and the request deadlines at least this often
+const std::uint32_t kReaderPollMs = 100u;
+
+const std::size_t kDefaultMaxInFlight = 8u;
+
+} // namespace
+
+AsyncControl::AsyncControl() : m_stop(true), m_connected(false), m_timeoutMs(5000u), m_maxInFlight(kDefaultMaxInFlight)
+{
+  m_connection.setStatistics(&m_statistics);
+  m_tracker.setStatistics(&m_statistics);
+}
+
+AsyncControl::~AsyncControl()
+{
+  close();
+}
+
+bool AsyncControl::open(VisionaryControl::ProtocolType protocol,
+                        const std::string&             hostname,
+                        std::uint32_t                  timeoutMs,
+                        std::uint16_t                  port)
+{
+  close();
+
+  if (!m_connection.open(protocol, hostname, timeoutMs, port))
+  {
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tracker.reset(protocol, timeoutMs);
+    m_timeoutMs = timeoutMs;
+    m_connected = true;
+  }
+  m_stop         = false;
+  m_readerThread = std::thread(&AsyncControl::readerLoop, this);
+  return true;
+}
+
+void AsyncControl::close()
+{
+  m_stop = true;
+  if (m_readerThread.joinable())
+  {
+    m_connection.shutdown();
+    m_readerThread.join();
+  }
+  m_connection.close();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_connected = false;
+  }
+  failAll();
+}
+
+bool AsyncControl::isConnected() const
+{
+  return m_connected;
+}
+
+bool AsyncControl::login(IAuthentication::UserLevel userLevel, const std::string& password)
+{
+  return loginCoLa(
+    m_connection.getProtocol(), userLevel, password, [this](CoLaCommand command) { return sendCommand(command); });
+}
+
+void AsyncControl::setMaxInFlight(std::size_t maxInFlight)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_maxInFlight = std::max<std::size_t>(maxInFlight, 1u);
+}
+
+void AsyncControl::sendCommandAsync(CoLaCommand command, ResponseCallback callback, std::uint32_t timeoutMs)
+{
+  Outgoing outgoing;
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_connected)
+    {
+      lock.unlock();
+      CoLaCommand response = CoLaCommand::networkErrorCommand();
+      callback(response);
+      return;
+    }
+
+    CoLaRequestTracker::Request request;
+    request.requestId = m_tracker.nextRequestId();
+    request.payload   = command.getBuffer();
+    request.deadline  = Clock::now() + std::chrono::milliseconds((timeoutMs != 0u) ? timeoutMs : m_timeoutMs);
+    request.callback  = callback;
+    m_queue.push_back(std::move(request));
+    takeSendable(outgoing);
+  }
+  send(outgoing);
+}
+
+std::future<CoLaCommand> AsyncControl::sendCommandAsync(CoLaCommand command, std::uint32_t timeoutMs)
+{
+  std::shared_ptr<std::promise<CoLaCommand>> pPromise = std::make_shared<std::promise<CoLaCommand>>();
+  std::future<CoLaCommand>                   future   = pPromise->get_future();
+  sendCommandAsync(command, [pPromise](CoLaCommand& response) { pPromise->set_value(response); }, timeoutMs);
+  return future;
+}
+
+CoLaCommand AsyncControl::sendCommand(CoLaCommand command, std::uint32_t timeoutMs)
+{
+  return sendCommandAsync(command, timeoutMs).get();
+}
+
+std::size_t AsyncControl::getInFlightCount() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_tracker.getInFlightCount();
+}
+
+void AsyncControl::readerLoop()
+{
+  while (!m_stop)
+  {
+    std::uint32_t waitMs;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      waitMs = nextWakeupMs(Clock::now());
+    }
+
+    CoLaFrame frame;
+    const int ret = m_connection.receive(frame, waitMs);
+    if (ret < 0)
+    {
+      break;
+    }
+
+    CoLaRequestTracker::Completions completions;
+    Outgoing                        outgoing;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (ret > 0)
+      {
+        m_tracker.handleResponse(frame, completions);
+      }
+      const Clock::time_point now = Clock::now();
+      m_tracker.expire(now, completions);
+      CoLaRequestTracker::expireQueue(m_queue, now, completions);
+      takeSendable(outgoing);
+    }
+    send(outgoing);
+    CoLaRequestTracker::complete(completions);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_connected = false;
+  }
+  failAll();
+}
+
+void AsyncControl::takeSendable(Outgoing& outgoing)
+{
+  while (!m_queue.empty() && m_tracker.canSend(m_maxInFlight))
+  {
+    CoLaRequestTracker::Request& next = m_queue.front();
+    outgoing.push_back(std::make_pair(next.requestId, std::vector<std::uint8_t>()));
+    m_tracker.addInFlight(std::move(next), &outgoing.back().second);
+    m_queue.pop_front();
+  }
+}
+
+void AsyncControl::send(const Outgoing& outgoing)
+{
+  for (const auto& telegram : outgoing)
+  {
+    // a failed send shuts the connection down, the reader thread then fails all requests; after close() the
+    // requests are failed already
+    if (!m_connection.send(telegram.second, telegram.first))
+    {
+      return;
+    }
+  }
+}
+
+void AsyncControl::failAll()
+{
+  CoLaRequestTracker::Completions completions;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tracker.failAll(completions);
+    CoLaRequestTracker::failQueue(m_queue, completions);
+  }
+  CoLaRequestTracker::complete(completions);
+}
+
+std::uint32_t AsyncControl::nextWakeupMs(Clock::time_point now) const
+{
+  Clock::time_point wakeup = now + std::chrono::milliseconds(kReaderPollMs);
+  wakeup                   = m_tracker.nextDeadline(wakeup);
+  wakeup                   = CoLaRequestTracker::nextDeadline(m_queue, wakeup);
+
+  const auto waitMs = std::chrono::duration_cast<std::chrono::milliseconds>(wakeup - now).count();
+  return static_cast<std::uint32_t>(std::max<decltype(waitMs)>(waitMs, 1));
+}
+
+CommandStatistics& AsyncControl::getStatistics()
+{
+  return m_statistics;
+}
+
+} // namespace visionary
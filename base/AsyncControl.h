@@ -0,0 +1,137 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CoLaCommand.h"
+#include "CoLaConnection.h"
+#include "CoLaRequestTracker.h"
+#include "CommandStatistics.h"
+#include "IAuthentication.h"
+#include "VisionaryControl.h"
+
+namespace visionary {
+
+/// Control connection with asynchronous commands
+///
+/// VisionaryControl::sendCommand() blocks the calling thread for a full round trip, and since it is not thread
+/// safe all other control operations have to wait as well. sendCommandAsync() returns immediately; the response is
+/// delivered through a future or a callback from a background reader thread.
+///
+/// With CoLa 2 several requests are in flight at the same time and their responses are matched by request id.
+/// CoLa B has no request ids, so requests are queued and sent one after the other.
+///
+/// A request that times out completes with CoLaCommand::networkErrorCommand(), the session stays open. A late
+/// response to it is dropped (for CoLa B the next request is held back until it arrived, see sendCommandAsync()).
+class AsyncControl
+{
+public:
+  /// Completion callback
+  ///
+  /// Called from the reader thread (or from close() for requests still pending). It must not block, in particular
+  /// it must not wait for another response of the same connection.
+  ///
+  /// \param[in] response response of the device, or CoLaCommand::networkErrorCommand() on timeout or connection loss
+  typedef CoLaRequestTracker::ResponseCallback ResponseCallback;
+
+  AsyncControl();
+  ~AsyncControl();
+
+  AsyncControl(const AsyncControl&)            = delete;
+  AsyncControl& operator=(const AsyncControl&) = delete;
+
+  /// Opens the control connection (and for CoLa 2 the session)
+  ///
+  /// \param[in] protocol  protocol type the device understands (CoLa B or CoLa 2)
+  /// \param[in] hostname  host name or IP address of the device
+  /// \param[in] timeoutMs connect timeout and default timeout of the requests
+  /// \param[in] port      control port; 0 selects the default port of the protocol
+  ///
+  /// \retval true  the connection was established and the reader thread is running
+  /// \retval false the connection failed
+  bool open(VisionaryControl::ProtocolType protocol,
+            const std::string&             hostname,
+            std::uint32_t                  timeoutMs = 5000u,
+            std::uint16_t                  port      = 0u);
+
+  /// Closes the connection. Pending requests complete with CoLaCommand::networkErrorCommand().
+  void close();
+
+  /// True as long as the connection is alive
+  bool isConnected() const;
+
+  /// Logs the connection in, e.g. as AUTHORIZED_CLIENT before writing variables
+  ///
+  /// The login method depends on the protocol, see loginCoLa(): SetAccessMode for CoLa B, the GetChallenge and
+  /// SetUserLevel challenge/response for CoLa 2 devices. Blocks the calling thread until the device answered.
+  ///
+  /// \retval true  the device accepted the password
+  /// \retval false wrong password or no response
+  bool login(IAuthentication::UserLevel userLevel, const std::string& password);
+
+  /// Limits the number of CoLa 2 requests in flight; further requests are queued (default 8, CoLa B always 1)
+  void setMaxInFlight(std::size_t maxInFlight);
+
+  /// Sends a command without waiting for the response
+  ///
+  /// \param[in] command   command to send
+  /// \param[in] callback  called with the response
+  /// \param[in] timeoutMs time from the call until the request is given up; 0 selects the timeout passed to open()
+  ///
+  /// For CoLa B a request that timed out still occupies the connection until its late response arrived (or for
+  /// another timeout period), since the response of the next request could not be told apart.
+  void sendCommandAsync(CoLaCommand command, ResponseCallback callback, std::uint32_t timeoutMs = 0u);
+
+  /// Sends a command without waiting for the response
+  ///
+  /// \return future which receives the response
+  std::future<CoLaCommand> sendCommandAsync(CoLaCommand command, std::uint32_t timeoutMs = 0u);
+
+  /// Sends a command and waits for the response; other threads can use the connection in the meantime
+  CoLaCommand sendCommand(CoLaCommand command, std::uint32_t timeoutMs = 0u);
+
+  /// Number of requests sent but not answered yet
+  std::size_t getInFlightCount() const;
+
+  /// Latency, error and timeout statistics per command and the traffic of the connection since construction
+  CommandStatistics& getStatistics();
+
+private:
+  typedef CoLaRequestTracker::Clock Clock;
+
+  // telegrams to send outside of the lock (request id, payload)
+  typedef std::vector<std::pair<std::uint16_t, std::vector<std::uint8_t>>> Outgoing;
+
+  void          readerLoop();
+  void          takeSendable(Outgoing& outgoing);
+  void          send(const Outgoing& outgoing);
+  void          failAll();
+  std::uint32_t nextWakeupMs(Clock::time_point now) const;
+
+  CommandStatistics m_statistics; // declared first, the connection and the tracker record into it
+  CoLaConnection    m_connection;
+  std::thread       m_readerThread;
+  std::atomic<bool> m_stop;
+  std::atomic<bool> m_connected;
+  std::uint32_t     m_timeoutMs;
+
+  mutable std::mutex                      m_mutex;
+  std::deque<CoLaRequestTracker::Request> m_queue; // not sent yet
+  CoLaRequestTracker                      m_tracker;
+  std::size_t                             m_maxInFlight;
+};
+
+} // namespace visionary
@@ -0,0 +1,83 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "BlobParser.h"
+
+#include <cstddef>
+#include <string>
+
+namespace visionary {
+
+namespace {
+
+const std::uint16_t kProtocolVersion = 0x0001u;
+const std::uint8_t  kPacketTypeBlob  = 0x62u;
+const std::size_t   kBlobOffset      = 2u + 1u; // the segment offsets are relative to the blob id
+
+std::uint16_t getBigEndian16(const std::uint8_t* pSrc)
+{
+  return static_cast<std::uint16_t>((pSrc[0] << 8u) | pSrc[1]);
+}
+
+std::uint32_t getBigEndian32(const std::uint8_t* pSrc)
+{
+  return (static_cast<std::uint32_t>(pSrc[0]) << 24u) | (static_cast<std::uint32_t>(pSrc[1]) << 16u)
+         | (static_cast<std::uint32_t>(pSrc[2]) << 8u) | static_cast<std::uint32_t>(pSrc[3]);
+}
+
+} // namespace
+
+BlobParser::BlobParser() : m_hasChangeCounter(false), m_changeCounter(0u)
+{
+}
+
+void BlobParser::reset()
+{
+  m_hasChangeCounter = false;
+}
+
+bool BlobParser::parse(VisionaryData& dataHandler, std::vector<std::uint8_t>& package)
+{
+  const std::size_t   size     = package.size();
+  const std::uint8_t* pPackage = package.data();
+  if ((size < kBlobOffset + 4u) || (getBigEndian16(pPackage) != kProtocolVersion) || (pPackage[2] != kPacketTypeBlob))
+  {
+    return false;
+  }
+
+  // segment table: offset and change counter per segment, the first segment is the XML, the second the binary data
+  const std::uint8_t* pBlob       = pPackage + kBlobOffset;
+  const std::size_t   blobSize    = size - kBlobOffset;
+  const std::size_t   numSegments = getBigEndian16(pBlob + 2u);
+  if ((numSegments < 2u) || (4u + numSegments * 8u > blobSize))
+  {
+    return false;
+  }
+  const std::size_t   xmlOffset     = getBigEndian32(pBlob + 4u);
+  const std::uint32_t changeCounter = getBigEndian32(pBlob + 8u);
+  const std::size_t   binaryOffset  = getBigEndian32(pBlob + 12u);
+  const std::size_t   binaryEnd     = (numSegments > 2u) ? getBigEndian32(pBlob + 20u) : blobSize;
+  if ((xmlOffset > binaryOffset) || (binaryOffset > binaryEnd) || (binaryEnd > blobSize))
+  {
+    return false;
+  }
+
+  if (!m_hasChangeCounter || (changeCounter != m_changeCounter))
+  {
+    const std::string xml(pBlob + xmlOffset, pBlob + binaryOffset);
+    if (!dataHandler.parseXML(xml, changeCounter))
+    {
+      return false;
+    }
+    m_hasChangeCounter = true;
+    m_changeCounter    = changeCounter;
+  }
+
+  const std::vector<std::uint8_t>::iterator itBinary =
+    package.begin() + static_cast<std::ptrdiff_t>(kBlobOffset + binaryOffset);
+  return dataHandler.parseBinaryData(itBinary, binaryEnd - binaryOffset);
+}
+
+} // namespace visionary
@@ -0,0 +1,42 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "VisionaryData.h"
+
+namespace visionary {
+
+/// Parses BLOB telegrams of the data stream into a data handler
+///
+/// The XML segment describes the layout of the binary segment and only changes when the device configuration
+/// changes, so it is only parsed when its change counter differs from the one of the previous telegram.
+class BlobParser
+{
+public:
+  BlobParser();
+
+  /// Forgets the change counter, e.g. after reconnecting or when switching the data handler
+  void reset();
+
+  /// Parses one telegram into the data handler
+  ///
+  /// \param[in] dataHandler data handler of the device type, e.g. VisionaryTMiniData
+  /// \param[in] package     telegram without magic and package length (protocol version, packet type, BLOB id and
+  ///                        segments); the data handler reads the binary segment in place
+  ///
+  /// \retval true  the data handler holds the new frame
+  /// \retval false the telegram is not a BLOB telegram or could not be parsed
+  bool parse(VisionaryData& dataHandler, std::vector<std::uint8_t>& package);
+
+private:
+  bool          m_hasChangeCounter;
+  std::uint32_t m_changeCounter;
+};
+
+} // namespace visionary
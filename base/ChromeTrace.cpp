@@ -0,0 +1,234 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "ChromeTrace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace visionary {
+
+namespace {
+
+struct Event
+{
+  const char*  name;
+  const char*  category;
+  const char*  argName;
+  std::int64_t argValue;
+  std::int64_t beginNs; // since the trace epoch
+  std::int64_t durationNs;
+};
+
+// written only by its thread; size is published after the event, so write() reads complete events only
+struct ThreadBuffer
+{
+  std::uint32_t            tid = 0u;
+  std::string              name; // guarded by the registry mutex
+  std::unique_ptr<Event[]> pEvents;
+  std::atomic<std::size_t> size;
+
+  ThreadBuffer() : pEvents(new Event[ChromeTrace::kEventsPerThread]), size(0u)
+  {
+  }
+};
+
+struct Registry
+{
+  std::mutex                                 mutex;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  std::atomic<std::uint64_t>                 droppedCount;
+  const ChromeTrace::Clock::time_point       epoch;
+
+  Registry() : droppedCount(0u), epoch(ChromeTrace::Clock::now())
+  {
+  }
+};
+
+Registry& getRegistry()
+{
+  static Registry registry;
+  return registry;
+}
+
+// the registry keeps the buffer when the thread ends
+thread_local std::shared_ptr<ThreadBuffer> t_pBuffer;
+
+ThreadBuffer& getThreadBuffer()
+{
+  if (!t_pBuffer)
+  {
+    Registry&                   registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    t_pBuffer.reset(new ThreadBuffer());
+    t_pBuffer->tid = static_cast<std::uint32_t>(registry.buffers.size() + 1u);
+    registry.buffers.push_back(t_pBuffer);
+  }
+  return *t_pBuffer;
+}
+
+std::int64_t toNs(ChromeTrace::Clock::duration duration)
+{
+  return static_cast<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+}
+
+std::string escapeJson(const std::string& text)
+{
+  std::string escaped;
+  for (const char c : text)
+  {
+    if ((c == '"') || (c == '\\'))
+    {
+      escaped += '\\';
+      escaped += c;
+    }
+    else if (static_cast<unsigned char>(c) < 0x20u)
+    {
+      char code[8];
+      std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(c));
+      escaped += code;
+    }
+    else
+    {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+} // namespace
+
+std::atomic<bool> ChromeTrace::s_enabled(false);
+
+void ChromeTrace::enable()
+{
+  getRegistry(); // fixes the epoch before the first event
+  s_enabled.store(true, std::memory_order_relaxed);
+}
+
+void ChromeTrace::disable()
+{
+  s_enabled.store(false, std::memory_order_relaxed);
+}
+
+void ChromeTrace::setThreadName(const std::string& name)
+{
+  ThreadBuffer&               buffer = getThreadBuffer();
+  std::lock_guard<std::mutex> lock(getRegistry().mutex);
+  buffer.name = name;
+}
+
+void ChromeTrace::addSpan(const char*       name,
+                          const char*       category,
+                          Clock::time_point begin,
+                          Clock::time_point end,
+                          const char*       argName,
+                          std::int64_t      argValue)
+{
+  ThreadBuffer&     buffer = getThreadBuffer();
+  const std::size_t size   = buffer.size.load(std::memory_order_relaxed);
+  if (size >= kEventsPerThread)
+  {
+    getRegistry().droppedCount.fetch_add(1u, std::memory_order_relaxed);
+    return;
+  }
+
+  // spans measured before the trace was enabled start at the epoch
+  const Clock::time_point epoch = getRegistry().epoch;
+  begin                         = std::max(begin, epoch);
+  end                           = std::max(end, begin);
+
+  Event& event     = buffer.pEvents[size];
+  event.name       = name;
+  event.category   = category;
+  event.argName    = argName;
+  event.argValue   = argValue;
+  event.beginNs    = toNs(begin - epoch);
+  event.durationNs = toNs(end - begin);
+  buffer.size.store(size + 1u, std::memory_order_release);
+}
+
+bool ChromeTrace::write(const std::string& filename)
+{
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  std::vector<std::string>                   names;
+  {
+    Registry&                   registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    buffers = registry.buffers;
+    for (const std::shared_ptr<ThreadBuffer>& pBuffer : buffers)
+    {
+      names.push_back(pBuffer->name);
+    }
+  }
+
+  std::FILE* pFile = std::fopen(filename.c_str(), "w");
+  if (pFile == nullptr)
+  {
+    return false;
+  }
+
+  std::fprintf(pFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  const char* separator = "";
+  for (std::size_t i = 0u; i < buffers.size(); ++i)
+  {
+    const ThreadBuffer& buffer = *buffers[i];
+    if (!names[i].empty())
+    {
+      std::fprintf(pFile,
+                   "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                   separator,
+                   static_cast<unsigned>(buffer.tid),
+                   escapeJson(names[i]).c_str());
+      separator = ",\n";
+    }
+
+    const std::size_t size = buffer.size.load(std::memory_order_acquire);
+    for (std::size_t j = 0u; j < size; ++j)
+    {
+      const Event& event = buffer.pEvents[j];
+      std::fprintf(pFile,
+                   "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%lld.%03lld,"
+                   "\"dur\":%lld.%03lld",
+                   separator,
+                   event.name,
+                   event.category,
+                   static_cast<unsigned>(buffer.tid),
+                   static_cast<long long>(event.beginNs / 1000),
+                   static_cast<long long>(event.beginNs % 1000),
+                   static_cast<long long>(event.durationNs / 1000),
+                   static_cast<long long>(event.durationNs % 1000));
+      if (event.argName != nullptr)
+      {
+        std::fprintf(pFile, ",\"args\":{\"%s\":%lld}", event.argName, static_cast<long long>(event.argValue));
+      }
+      std::fprintf(pFile, "}");
+      separator = ",\n";
+    }
+  }
+  std::fprintf(pFile, "\n]}\n");
+  return std::fclose(pFile) == 0;
+}
+
+void ChromeTrace::clear()
+{
+  Registry&                   registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (const std::shared_ptr<ThreadBuffer>& pBuffer : registry.buffers)
+  {
+    pBuffer->size.store(0u, std::memory_order_relaxed);
+  }
+  registry.droppedCount = 0u;
+}
+
+std::uint64_t ChromeTrace::getDroppedCount()
+{
+  return getRegistry().droppedCount;
+}
+
+} // namespace visionary
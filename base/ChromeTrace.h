@@ -0,0 +1,126 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace visionary {
+
+/// Timeline of pipeline stages in the Chrome trace event format (chrome://tracing, ui.perfetto.dev)
+///
+/// Tracing is off by default. While it is off, a TraceSpan costs one relaxed atomic load. While it is on, every
+/// thread appends its events to its own fixed-size buffer without locking; only the first event of a thread takes a
+/// lock to register the buffer. Events which don't fit into the buffer any more are counted as dropped. write()
+/// saves the events of all threads, also of threads that ended meanwhile.
+///
+/// Event names, categories and argument names are not copied and must be string literals (or live as long as the
+/// trace).
+class ChromeTrace
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  /// Events per thread (about 48 bytes each)
+  static const std::size_t kEventsPerThread = 65536u;
+
+  static void enable();
+  static void disable();
+
+  static bool isEnabled()
+  {
+    return s_enabled.load(std::memory_order_relaxed);
+  }
+
+  /// Name of the calling thread in the timeline, e.g. "receiver 192.168.1.10"
+  static void setThreadName(const std::string& name);
+
+  /// Adds a completed span with explicit times, e.g. stages measured with FrameTrace
+  ///
+  /// \param[in] name     event name
+  /// \param[in] category event category, used for filtering in the viewer
+  /// \param[in] begin    start of the span
+  /// \param[in] end      end of the span
+  /// \param[in] argName  name of the argument shown with the event, nullptr for none
+  /// \param[in] argValue value of the argument, e.g. the frame number
+  static void addSpan(const char*       name,
+                      const char*       category,
+                      Clock::time_point begin,
+                      Clock::time_point end,
+                      const char*       argName  = nullptr,
+                      std::int64_t      argValue = 0);
+
+  /// Writes the events recorded so far as JSON trace file
+  ///
+  /// May be called while tracing; events added during the call may be missing.
+  ///
+  /// \retval true  the file was written
+  /// \retval false the file could not be written
+  static bool write(const std::string& filename);
+
+  /// Discards all events; no spans may be open
+  static void clear();
+
+  /// Number of events dropped because a thread buffer was full
+  static std::uint64_t getDroppedCount();
+
+private:
+  static std::atomic<bool> s_enabled;
+};
+
+/// Scoped span: records the time from construction to destruction as one event if tracing was enabled at
+/// construction
+class TraceSpan
+{
+public:
+  /// \param[in] name     event name (string literal)
+  /// \param[in] category event category (string literal)
+  /// \param[in] argName  name of the argument (string literal), nullptr for none
+  /// \param[in] argValue value of the argument, e.g. the frame number or a camera index
+  explicit TraceSpan(const char*  name,
+                     const char*  category = "visionary",
+                     const char*  argName  = nullptr,
+                     std::int64_t argValue = 0)
+    : m_name(name)
+    , m_category(category)
+    , m_argName(argName)
+    , m_argValue(argValue)
+    , m_enabled(ChromeTrace::isEnabled())
+    , m_begin(m_enabled ? ChromeTrace::Clock::now() : ChromeTrace::Clock::time_point())
+  {
+  }
+
+  ~TraceSpan()
+  {
+    if (m_enabled)
+    {
+      ChromeTrace::addSpan(m_name, m_category, m_begin, ChromeTrace::Clock::now(), m_argName, m_argValue);
+    }
+  }
+
+  TraceSpan(const TraceSpan&)            = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+  /// Sets the argument, e.g. once the frame number is known
+  void setArg(const char* argName, std::int64_t argValue)
+  {
+    m_argName  = argName;
+    m_argValue = argValue;
+  }
+
+private:
+  const char*                          m_name;
+  const char*                          m_category;
+  const char*                          m_argName;
+  std::int64_t                         m_argValue;
+  const bool                           m_enabled;
+  const ChromeTrace::Clock::time_point m_begin;
+};
+
+} // namespace visionary
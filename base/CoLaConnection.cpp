@@ -0,0 +1,180 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "CoLaConnection.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "VisionaryProbes.h"
+
+namespace visionary {
+
+namespace {
+
+const std::size_t kRecvChunkSize = 4096u;
+const char        kClientId[]    = "VisionarySamples";
+
+} // namespace
+
+CoLaConnection::CoLaConnection()
+  : m_protocol(VisionaryControl::ProtocolType::COLA_B)
+  , m_decoder(VisionaryControl::ProtocolType::COLA_B)
+  , m_sessionId(0u)
+  , m_recvBuffer(kRecvChunkSize)
+  , m_pStatistics(nullptr)
+{
+}
+
+CoLaConnection::~CoLaConnection()
+{
+  close();
+}
+
+bool CoLaConnection::open(VisionaryControl::ProtocolType protocol,
+                          const std::string&             hostname,
+                          std::uint32_t                  timeoutMs,
+                          std::uint16_t                  port)
+{
+  close();
+
+  m_protocol = protocol;
+  m_hostname = hostname;
+  m_decoder  = CoLaFrameDecoder(protocol);
+  if (!m_socket.connect(hostname, (port != 0u) ? port : defaultCoLaPort(protocol), timeoutMs))
+  {
+    return false;
+  }
+  if ((protocol == VisionaryControl::ProtocolType::COLA_2) && !openCoLa2Session(timeoutMs))
+  {
+    close();
+    return false;
+  }
+  return true;
+}
+
+bool CoLaConnection::openCoLa2Session(std::uint32_t timeoutMs)
+{
+  // the session timeout is transported in seconds (1..255)
+  const std::uint32_t timeoutSec = std::min<std::uint32_t>(std::max<std::uint32_t>(timeoutMs / 1000u, 1u), 255u);
+
+  m_sessionId = 0u;
+  if (!send(makeCoLa2OpenSessionPayload(static_cast<std::uint8_t>(timeoutSec), kClientId), 0u))
+  {
+    return false;
+  }
+
+  CoLaFrame response;
+  if (receive(response, timeoutMs) <= 0)
+  {
+    return false;
+  }
+  if ((response.payload.size() < 2u) || (response.payload[0] != 'O') || (response.payload[1] != 'A'))
+  {
+    return false;
+  }
+  m_sessionId = response.sessionId;
+  return true;
+}
+
+void CoLaConnection::close()
+{
+  {
+    // a send in progress on another thread finishes before the handle is closed (and possibly reused)
+    std::lock_guard<std::mutex> lock(m_sendMutex);
+    m_socket.close();
+    m_sessionId = 0u;
+  }
+  m_decoder.reset();
+}
+
+void CoLaConnection::shutdown()
+{
+  m_socket.shutdown();
+}
+
+bool CoLaConnection::isOpen() const
+{
+  return m_socket.isOpen();
+}
+
+VisionaryControl::ProtocolType CoLaConnection::getProtocol() const
+{
+  return m_protocol;
+}
+
+bool CoLaConnection::send(const std::vector<std::uint8_t>& payload, std::uint16_t requestId)
+{
+  std::lock_guard<std::mutex> lock(m_sendMutex);
+  if (!m_socket.isOpen())
+  {
+    return false;
+  }
+
+  CoLaFrame frame;
+  frame.sessionId = m_sessionId;
+  frame.requestId = requestId;
+  frame.payload   = payload;
+  const std::vector<std::uint8_t> buffer = encodeCoLaFrame(m_protocol, frame);
+
+  if (m_pStatistics != nullptr)
+  {
+    m_pStatistics->addSent(buffer.size());
+  }
+  VISIONARY_PROBE3(cola_send, m_hostname.c_str(), requestId, buffer.size());
+  if (!m_socket.send(buffer.data(), buffer.size()))
+  {
+    // let the receiving thread detect the broken connection
+    m_socket.shutdown();
+    return false;
+  }
+  return true;
+}
+
+int CoLaConnection::receive(CoLaFrame& frame, std::uint32_t timeoutMs, const WakeupSignal* pWakeup)
+{
+  using Clock = std::chrono::steady_clock;
+
+  const Clock::time_point tEnd = Clock::now() + std::chrono::milliseconds(timeoutMs);
+
+  while (!m_decoder.pop(frame))
+  {
+    const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(tEnd - Clock::now()).count();
+    if (remaining <= 0)
+    {
+      return 0;
+    }
+    const int received =
+      m_socket.recv(m_recvBuffer.data(), m_recvBuffer.size(), static_cast<std::uint32_t>(remaining), pWakeup);
+    if (received <= 0)
+    {
+      // timeout, wake-up or broken connection
+      return received;
+    }
+    if (m_pStatistics != nullptr)
+    {
+      m_pStatistics->addReceived(static_cast<std::size_t>(received));
+    }
+    m_decoder.push(m_recvBuffer.data(), static_cast<std::size_t>(received));
+  }
+  if (m_pStatistics != nullptr)
+  {
+    m_pStatistics->addTelegramReceived();
+  }
+  VISIONARY_PROBE3(cola_receive, m_hostname.c_str(), frame.requestId, frame.payload.size());
+  return 1;
+}
+
+void CoLaConnection::setStatistics(CommandStatistics* pStatistics)
+{
+  m_pStatistics = pStatistics;
+}
+
+std::uint32_t CoLaConnection::getSessionId() const
+{
+  return m_sessionId;
+}
+
+} // namespace visionary
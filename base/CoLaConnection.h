@@ -0,0 +1,98 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "CoLaFrame.h"
+#include "CommandStatistics.h"
+#include "TcpConnection.h"
+#include "VisionaryControl.h"
+
+namespace visionary {
+
+/// Control channel connection on telegram level
+///
+/// In contrast to VisionaryControl this class does not wait for a response after sending a command. Sending and
+/// receiving are separate calls so a reader thread can receive responses and asynchronous telegrams (events) while
+/// other threads send. send() may be called from several threads, receive() only from one thread at a time.
+class CoLaConnection
+{
+public:
+  CoLaConnection();
+  ~CoLaConnection();
+
+  CoLaConnection(const CoLaConnection&)            = delete;
+  CoLaConnection& operator=(const CoLaConnection&) = delete;
+
+  /// Opens the connection (and for CoLa 2 the session)
+  ///
+  /// \param[in] protocol  protocol type the device understands (CoLa B or CoLa 2)
+  /// \param[in] hostname  host name or IP address of the device
+  /// \param[in] timeoutMs connect and handshake timeout; for CoLa 2 also the session timeout
+  /// \param[in] port      control port; 0 selects the default port of the protocol
+  ///
+  /// \retval true  connection (and session) established
+  /// \retval false connection failed or CoLa 2 session could not be opened
+  bool open(VisionaryControl::ProtocolType protocol,
+            const std::string&             hostname,
+            std::uint32_t                  timeoutMs,
+            std::uint16_t                  port = 0u);
+
+  /// Closes the connection, after a send() in progress on another thread has returned
+  void close();
+
+  /// Wakes up a thread blocked in receive() or send(); the connection has to be closed afterwards
+  void shutdown();
+
+  bool isOpen() const;
+
+  VisionaryControl::ProtocolType getProtocol() const;
+
+  /// Sends a telegram
+  ///
+  /// May be called from several threads and concurrently with close(). A failed send shuts the connection down, so
+  /// a thread blocked in receive() notices the broken connection.
+  ///
+  /// \param[in] payload   telegram, e.g. CoLaCommand::getBuffer()
+  /// \param[in] requestId CoLa 2 request id (ignored for CoLa B)
+  ///
+  /// \return false if the connection is broken
+  bool send(const std::vector<std::uint8_t>& payload, std::uint16_t requestId = 0u);
+
+  /// Receives the next telegram
+  ///
+  /// \param[out] frame     received telegram
+  /// \param[in]  timeoutMs maximum time to wait
+  /// \param[in]  pWakeup   optional signal which ends the wait early
+  ///
+  /// \return 1 if a telegram was received, 0 on timeout or wake-up, -1 if the connection is broken
+  int receive(CoLaFrame& frame, std::uint32_t timeoutMs, const WakeupSignal* pWakeup = nullptr);
+
+  std::uint32_t getSessionId() const;
+
+  /// Counts the telegrams and bytes sent and received (nullptr disables the counting)
+  ///
+  /// \param[in] pStatistics statistics to count into, must outlive the connection
+  void setStatistics(CommandStatistics* pStatistics);
+
+private:
+  bool openCoLa2Session(std::uint32_t timeoutMs);
+
+  VisionaryControl::ProtocolType m_protocol;
+  std::string                    m_hostname;
+  TcpConnection                  m_socket;
+  CoLaFrameDecoder               m_decoder;
+  std::mutex                     m_sendMutex; // serializes send() and close()
+  std::uint32_t                  m_sessionId;
+  std::vector<std::uint8_t>      m_recvBuffer;
+  CommandStatistics*             m_pStatistics;
+};
+
+} // namespace visionary
@@ -0,0 +1,295 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "CoLaEventChannel.h"
+
+#include <chrono>
+#include <cstring>
+
+namespace visionary {
+
+namespace {
+
+// the reader thread checks the stop flag at least this often
+const std::uint32_t kReaderPollMs = 100u;
+
+// variable read as keep alive for CoLa 2 sessions which are idle except for events
+const char kKeepaliveVariable[] = "DeviceIdent";
+
+} // namespace
+
+CoLaEventChannel::CoLaEventChannel()
+  : m_stop(true)
+  , m_connected(false)
+  , m_timeoutMs(5000u)
+  , m_pending(PendingState::NONE)
+  , m_pendingRequestId(0u)
+  , m_nextRequestId(1u)
+{
+}
+
+CoLaEventChannel::~CoLaEventChannel()
+{
+  close();
+}
+
+bool CoLaEventChannel::open(VisionaryControl::ProtocolType protocol,
+                            const std::string&             hostname,
+                            std::uint32_t                  timeoutMs,
+                            std::uint16_t                  port)
+{
+  close();
+
+  if (!m_connection.open(protocol, hostname, timeoutMs, port))
+  {
+    return false;
+  }
+
+  m_timeoutMs        = timeoutMs;
+  m_pending          = PendingState::NONE;
+  m_pendingRequestId = 0u;
+  m_stop             = false;
+  m_connected        = true;
+  m_readerThread     = std::thread(&CoLaEventChannel::readerLoop, this);
+  return true;
+}
+
+void CoLaEventChannel::close()
+{
+  m_stop = true;
+  if (m_readerThread.joinable())
+  {
+    m_connection.shutdown();
+    m_readerThread.join();
+  }
+  m_connection.close();
+  m_connected = false;
+  m_stateCv.notify_all();
+
+  std::lock_guard<std::mutex> lock(m_callbackMutex);
+  m_callbacks.clear();
+}
+
+bool CoLaEventChannel::isConnected() const
+{
+  return m_connected;
+}
+
+bool CoLaEventChannel::subscribe(const std::string& name, EventCallback callback)
+{
+  {
+    // register the callback first, the first notification may arrive before the acknowledge
+    std::lock_guard<std::mutex> lock(m_callbackMutex);
+    m_callbacks[name] = callback;
+  }
+
+  std::vector<std::uint8_t> response;
+  if (transact(makeRegistrationPayload(name, true), response) && (getCoLaCommandCode(response) == "sEA"))
+  {
+    return true;
+  }
+
+  std::lock_guard<std::mutex> lock(m_callbackMutex);
+  m_callbacks.erase(name);
+  return false;
+}
+
+bool CoLaEventChannel::unsubscribe(const std::string& name)
+{
+  std::vector<std::uint8_t> response;
+  const bool success = transact(makeRegistrationPayload(name, false), response)
+                       && (getCoLaCommandCode(response) == "sEA");
+
+  std::lock_guard<std::mutex> lock(m_callbackMutex);
+  m_callbacks.erase(name);
+  return success;
+}
+
+CoLaCommand CoLaEventChannel::sendCommand(CoLaCommand command)
+{
+  std::vector<std::uint8_t> response;
+  if (!transact(command.getBuffer(), response))
+  {
+    return CoLaCommand::networkErrorCommand();
+  }
+  return CoLaCommand(response);
+}
+
+bool CoLaEventChannel::transact(const std::vector<std::uint8_t>& request, std::vector<std::uint8_t>& response)
+{
+  std::lock_guard<std::mutex> transactLock(m_transactMutex);
+
+  const std::chrono::milliseconds timeout(m_timeoutMs);
+  std::uint16_t                   requestId;
+  {
+    std::unique_lock<std::mutex> lock(m_stateMutex);
+    // a keep alive or an answer to a timed out request may still be outstanding
+    if (!m_stateCv.wait_for(lock, timeout, [this]() { return (m_pending == PendingState::NONE) || !m_connected; }))
+    {
+      // the device swallowed the outstanding request, don't wait for it any longer
+      m_pending = PendingState::NONE;
+    }
+    if (!m_connected)
+    {
+      return false;
+    }
+    requestId          = m_nextRequestId++;
+    m_pendingRequestId = requestId;
+    m_pending          = PendingState::WAITING;
+  }
+
+  if (!m_connection.send(request, requestId))
+  {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    m_pending = PendingState::NONE;
+    return false;
+  }
+
+  std::unique_lock<std::mutex> lock(m_stateMutex);
+  if (m_stateCv.wait_for(lock, timeout, [this]() { return (m_pending == PendingState::RECEIVED) || !m_connected; })
+      && (m_pending == PendingState::RECEIVED))
+  {
+    response.swap(m_response);
+    m_pending = PendingState::NONE;
+    return true;
+  }
+
+  // CoLa 2 responses carry the request id, so a late answer can be told apart. CoLa B answers can't, so the
+  // next answer without a waiting request is dropped.
+  m_pending = (m_connection.getProtocol() == VisionaryControl::ProtocolType::COLA_2) ? PendingState::NONE
+                                                                                     : PendingState::STALE;
+  m_stateCv.notify_all();
+  return false;
+}
+
+void CoLaEventChannel::readerLoop()
+{
+  using Clock = std::chrono::steady_clock;
+
+  // CoLa 2 sessions are closed by the device after the session timeout without traffic
+  const bool needsKeepalive = (m_connection.getProtocol() == VisionaryControl::ProtocolType::COLA_2);
+  const std::chrono::milliseconds keepaliveInterval(m_timeoutMs / 2u);
+  Clock::time_point               lastActivity = Clock::now();
+
+  while (!m_stop)
+  {
+    CoLaFrame frame;
+    const int ret = m_connection.receive(frame, kReaderPollMs);
+    if (ret < 0)
+    {
+      break;
+    }
+    if (ret == 0)
+    {
+      if (needsKeepalive && (Clock::now() - lastActivity >= keepaliveInterval))
+      {
+        sendKeepalive();
+        lastActivity = Clock::now();
+      }
+      continue;
+    }
+
+    lastActivity = Clock::now();
+    if (getCoLaCommandCode(frame.payload) == "sSN")
+    {
+      dispatchEvent(frame.payload);
+    }
+    else
+    {
+      handleResponse(frame);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(m_stateMutex);
+  m_connected = false;
+  m_stateCv.notify_all();
+}
+
+void CoLaEventChannel::dispatchEvent(const std::vector<std::uint8_t>& payload)
+{
+  const std::string name = getCoLaCommandName(payload);
+
+  EventCallback callback;
+  {
+    std::lock_guard<std::mutex> lock(m_callbackMutex);
+    const auto                  it = m_callbacks.find(name);
+    if (it == m_callbacks.end())
+    {
+      return;
+    }
+    callback = it->second;
+  }
+
+  // present the event as read response ("sSN name data" -> "sRA name data") so that CoLaParameterReader
+  // decodes the data like the variable itself
+  std::vector<std::uint8_t> buffer(payload);
+  buffer[1] = 'R';
+  buffer[2] = 'A';
+  CoLaCommand eventData(buffer);
+  callback(name, eventData);
+}
+
+void CoLaEventChannel::handleResponse(const CoLaFrame& frame)
+{
+  std::lock_guard<std::mutex> lock(m_stateMutex);
+
+  const bool isCoLa2 = (m_connection.getProtocol() == VisionaryControl::ProtocolType::COLA_2);
+  if (isCoLa2 && (frame.requestId != m_pendingRequestId))
+  {
+    // answer to a request we gave up on
+    return;
+  }
+
+  switch (m_pending)
+  {
+    case PendingState::WAITING:
+      m_response = frame.payload;
+      m_pending  = PendingState::RECEIVED;
+      break;
+    case PendingState::STALE:
+    case PendingState::KEEPALIVE:
+      m_pending = PendingState::NONE;
+      break;
+    case PendingState::NONE:
+    case PendingState::RECEIVED:
+      // unsolicited answer, ignore
+      return;
+  }
+  m_stateCv.notify_all();
+}
+
+void CoLaEventChannel::sendKeepalive()
+{
+  std::uint16_t requestId;
+  {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    if (m_pending != PendingState::NONE)
+    {
+      // there is traffic anyway
+      return;
+    }
+    requestId          = m_nextRequestId++;
+    m_pendingRequestId = requestId;
+    m_pending          = PendingState::KEEPALIVE;
+  }
+
+  std::vector<std::uint8_t> payload(4u + sizeof(kKeepaliveVariable) - 1u);
+  std::memcpy(payload.data(), "sRN ", 4u);
+  std::memcpy(payload.data() + 4u, kKeepaliveVariable, sizeof(kKeepaliveVariable) - 1u);
+  m_connection.send(payload, requestId);
+}
+
+std::vector<std::uint8_t> CoLaEventChannel::makeRegistrationPayload(const std::string& name, bool enable)
+{
+  std::vector<std::uint8_t> payload;
+  payload.reserve(name.size() + 6u);
+  payload.insert(payload.end(), {'s', 'E', 'N', ' '});
+  payload.insert(payload.end(), name.begin(), name.end());
+  payload.push_back(' ');
+  payload.push_back(enable ? 1u : 0u);
+  return payload;
+}
+
+} // namespace visionary
@@ -0,0 +1,129 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CoLaCommand.h"
+#include "CoLaConnection.h"
+#include "VisionaryControl.h"
+
+namespace visionary {
+
+/// Receives CoLa events (sEN/sSN) from a device
+///
+/// The channel uses its own control connection to the device and a background reader thread. Registered callbacks
+/// are called from the reader thread whenever the device sends an event or a notification for a changed variable,
+/// so waiting for a state change costs no polling traffic.
+///
+/// The channel can be used in parallel to a VisionaryControl instance connected to the same device.
+class CoLaEventChannel
+{
+public:
+  /// Event callback
+  ///
+  /// The event data is delivered in the layout of a read variable response, so it can be decoded with
+  /// CoLaParameterReader exactly like the response of a READ_VARIABLE command.
+  ///
+  /// The callback is invoked from the reader thread. It must not block and must not call subscribe(),
+  /// unsubscribe() or sendCommand() of the same channel.
+  typedef std::function<void(const std::string& name, CoLaCommand& eventData)> EventCallback;
+
+  CoLaEventChannel();
+  ~CoLaEventChannel();
+
+  CoLaEventChannel(const CoLaEventChannel&)            = delete;
+  CoLaEventChannel& operator=(const CoLaEventChannel&) = delete;
+
+  /// Opens the event connection to a device
+  ///
+  /// \param[in] protocol  protocol type the device understands (CoLa B or CoLa 2)
+  /// \param[in] hostname  host name or IP address of the device
+  /// \param[in] timeoutMs connect timeout and timeout for the responses of subscribe() and sendCommand()
+  /// \param[in] port      control port; 0 selects the default port of the protocol
+  ///
+  /// \retval true  the connection was established and the reader thread is running
+  /// \retval false the connection failed
+  bool open(VisionaryControl::ProtocolType protocol,
+            const std::string&             hostname,
+            std::uint32_t                  timeoutMs = 5000u,
+            std::uint16_t                  port      = 0u);
+
+  /// Stops the reader thread and closes the connection. All subscriptions are dropped.
+  void close();
+
+  /// True as long as the connection is alive
+  bool isConnected() const;
+
+  /// Registers for an event or for change notifications of a variable
+  ///
+  /// \param[in] name     name of the event or variable
+  /// \param[in] callback called for every notification
+  ///
+  /// \retval true  the device acknowledged the registration
+  /// \retval false the device rejected the registration (e.g. the variable does not support notifications) or
+  ///               did not answer in time
+  bool subscribe(const std::string& name, EventCallback callback);
+
+  /// Cancels a registration
+  bool unsubscribe(const std::string& name);
+
+  /// Sends a command on the event connection and waits for its response
+  ///
+  /// Useful to read the current value of a subscribed variable: since the response and all later notifications
+  /// use the same connection, no change can get lost between the read and the notifications.
+  ///
+  /// \return the response, or CoLaCommand::networkErrorCommand() on connection loss or timeout
+  CoLaCommand sendCommand(CoLaCommand command);
+
+private:
+  enum class PendingState
+  {
+    NONE,
+    WAITING,
+    RECEIVED,
+    STALE,
+    KEEPALIVE
+  };
+
+  bool transact(const std::vector<std::uint8_t>& request, std::vector<std::uint8_t>& response);
+  void readerLoop();
+  void dispatchEvent(const std::vector<std::uint8_t>& payload);
+  void handleResponse(const CoLaFrame& frame);
+  void sendKeepalive();
+
+  static std::vector<std::uint8_t> makeRegistrationPayload(const std::string& name, bool enable);
+
+  CoLaConnection    m_connection;
+  std::thread       m_readerThread;
+  std::atomic<bool> m_stop;
+  std::atomic<bool> m_connected;
+  std::uint32_t     m_timeoutMs;
+
+  // serializes the request/response transactions of the user threads
+  std::mutex m_transactMutex;
+
+  // state of the current transaction, shared with the reader thread
+  std::mutex                m_stateMutex;
+  std::condition_variable   m_stateCv;
+  PendingState              m_pending;
+  std::uint16_t             m_pendingRequestId;
+  std::uint16_t             m_nextRequestId;
+  std::vector<std::uint8_t> m_response;
+
+  std::mutex                           m_callbackMutex;
+  std::map<std::string, EventCallback> m_callbacks;
+};
+
+} // namespace visionary
@@ -0,0 +1,253 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "CoLaFrame.h"
+
+#include <algorithm>
+
+namespace visionary {
+
+namespace {
+
+const std::uint8_t kStx           = 0x02u;
+const std::size_t  kMagicSize     = 4u;
+const std::size_t  kLengthSize    = 4u;
+const std::size_t  kCoLa2HdrSize  = 8u; // HubCntr, NoC, SessionID, ReqID
+const std::size_t  kMaxPayloadLen = 16u * 1024u * 1024u;
+
+// CoLa 2 transports the command mode with two letters ("RN", "AN", ...), the leading 's' of the CoLa B command
+// ("sRN", "sAN", ...) is dropped. Only the session telegrams ("Ox", "OA", "Cx", "CA") have no such prefix.
+const std::uint8_t kCoLaCommandPrefix = 's';
+
+bool isCoLa2SessionTelegram(const std::uint8_t* pPayload, std::size_t size)
+{
+  return (size > 0u) && ((pPayload[0] == 'O') || (pPayload[0] == 'C'));
+}
+
+void appendBigEndian(std::vector<std::uint8_t>& buffer, std::uint32_t value, std::size_t numBytes)
+{
+  for (std::size_t i = numBytes; i > 0u; --i)
+  {
+    buffer.push_back(static_cast<std::uint8_t>(value >> (8u * (i - 1u))));
+  }
+}
+
+std::uint32_t readBigEndian(const std::uint8_t* pData, std::size_t numBytes)
+{
+  std::uint32_t value = 0u;
+  for (std::size_t i = 0u; i < numBytes; ++i)
+  {
+    value = (value << 8u) | pData[i];
+  }
+  return value;
+}
+
+} // namespace
+
+std::uint16_t defaultCoLaPort(VisionaryControl::ProtocolType protocol)
+{
+  return (protocol == VisionaryControl::ProtocolType::COLA_2) ? 2122u : 2112u;
+}
+
+std::vector<std::uint8_t> encodeCoLaFrame(VisionaryControl::ProtocolType protocol, const CoLaFrame& frame)
+{
+  const bool        isCoLa2   = (protocol == VisionaryControl::ProtocolType::COLA_2);
+  const bool        hasPrefix = !frame.payload.empty() && (frame.payload[0] == kCoLaCommandPrefix);
+  const std::size_t skip      = (isCoLa2 && hasPrefix) ? 1u : 0u;
+  const std::size_t length    = frame.payload.size() - skip + (isCoLa2 ? kCoLa2HdrSize : 0u);
+  const std::size_t frameSize = kMagicSize + kLengthSize + length + (isCoLa2 ? 0u : 1u);
+
+  std::vector<std::uint8_t> buffer;
+  buffer.reserve(frameSize);
+  buffer.insert(buffer.end(), kMagicSize, kStx);
+  appendBigEndian(buffer, static_cast<std::uint32_t>(length), kLengthSize);
+  if (isCoLa2)
+  {
+    buffer.push_back(0u); // HubCntr
+    buffer.push_back(0u); // NoC
+    appendBigEndian(buffer, frame.sessionId, 4u);
+    appendBigEndian(buffer, frame.requestId, 2u);
+  }
+  buffer.insert(buffer.end(), frame.payload.begin() + static_cast<std::ptrdiff_t>(skip), frame.payload.end());
+  if (!isCoLa2)
+  {
+    std::uint8_t checksum = 0u;
+    for (std::uint8_t byte : frame.payload)
+    {
+      checksum ^= byte;
+    }
+    buffer.push_back(checksum);
+  }
+  return buffer;
+}
+
+std::vector<std::uint8_t> makeCoLa2OpenSessionPayload(std::uint8_t sessionTimeoutSec, const std::string& clientId)
+{
+  std::vector<std::uint8_t> payload;
+  payload.reserve(5u + clientId.size());
+  payload.push_back('O');
+  payload.push_back('x');
+  payload.push_back(sessionTimeoutSec);
+  appendBigEndian(payload, static_cast<std::uint32_t>(clientId.size()), 2u);
+  payload.insert(payload.end(), clientId.begin(), clientId.end());
+  return payload;
+}
+
+std::string getCoLaCommandCode(const std::vector<std::uint8_t>& payload)
+{
+  if (payload.size() < 3u)
+  {
+    return std::string();
+  }
+  return std::string(payload.begin(), payload.begin() + 3);
+}
+
+std::string getCoLaCommandName(const std::vector<std::uint8_t>& payload)
+{
+  if (payload.size() < 5u)
+  {
+    return std::string();
+  }
+  const auto itBegin = payload.begin() + 4;
+  return std::string(itBegin, std::find(itBegin, payload.end(), static_cast<std::uint8_t>(' ')));
+}
+
+std::size_t getCoLaParameterOffset(const std::vector<std::uint8_t>& payload)
+{
+  if (payload.size() < 5u)
+  {
+    return payload.size();
+  }
+  const auto itSpace = std::find(payload.begin() + 4, payload.end(), static_cast<std::uint8_t>(' '));
+  return (itSpace == payload.end()) ? payload.size() : static_cast<std::size_t>(itSpace - payload.begin()) + 1u;
+}
+
+CoLaFrameDecoder::CoLaFrameDecoder(VisionaryControl::ProtocolType protocol)
+  : m_protocol(protocol), m_readPos(0u), m_discardedBytes(0u)
+{
+}
+
+void CoLaFrameDecoder::push(const std::uint8_t* pData, std::size_t size)
+{
+  // drop consumed bytes from time to time instead of after every telegram
+  if ((m_readPos > 0u) && (m_readPos >= m_buffer.size() / 2u))
+  {
+    m_buffer.erase(m_buffer.begin(), m_buffer.begin() + static_cast<std::ptrdiff_t>(m_readPos));
+    m_readPos = 0u;
+  }
+  m_buffer.insert(m_buffer.end(), pData, pData + size);
+}
+
+bool CoLaFrameDecoder::pop(CoLaFrame& frame)
+{
+  const bool isCoLa2 = (m_protocol == VisionaryControl::ProtocolType::COLA_2);
+  if (!isMagicAt(m_readPos))
+  {
+    skipToMagic(m_readPos + 1u);
+  }
+
+  // a telegram which turns out to be implausible started at a false magic, search the next one
+  std::size_t length    = 0u;
+  std::size_t frameSize = 0u;
+  for (;;)
+  {
+    const std::size_t available = m_buffer.size() - m_readPos;
+    if (available < kMagicSize + kLengthSize)
+    {
+      return false;
+    }
+    length = readBigEndian(m_buffer.data() + m_readPos + kMagicSize, kLengthSize);
+    if ((length > kMaxPayloadLen) || (isCoLa2 && (length < kCoLa2HdrSize)))
+    {
+      skipToMagic(m_readPos + 1u);
+      continue;
+    }
+    frameSize = kMagicSize + kLengthSize + length + (isCoLa2 ? 0u : 1u);
+    if (available < frameSize)
+    {
+      return false;
+    }
+    if (isCoLa2)
+    {
+      break;
+    }
+
+    const std::uint8_t* pBody    = m_buffer.data() + m_readPos + kMagicSize + kLengthSize;
+    std::uint8_t        checksum = 0u;
+    for (std::size_t i = 0u; i < length; ++i)
+    {
+      checksum ^= pBody[i];
+    }
+    if (checksum == pBody[length])
+    {
+      break;
+    }
+    skipToMagic(m_readPos + 1u);
+  }
+
+  const std::uint8_t* pBody = m_buffer.data() + m_readPos + kMagicSize + kLengthSize;
+  if (isCoLa2)
+  {
+    frame.sessionId = readBigEndian(pBody + 2u, 4u);
+    frame.requestId = static_cast<std::uint16_t>(readBigEndian(pBody + 6u, 2u));
+    const std::uint8_t* pPayload    = pBody + kCoLa2HdrSize;
+    const std::size_t   payloadSize = length - kCoLa2HdrSize;
+    frame.payload.clear();
+    frame.payload.reserve(payloadSize + 1u);
+    if (!isCoLa2SessionTelegram(pPayload, payloadSize))
+    {
+      frame.payload.push_back(kCoLaCommandPrefix);
+    }
+    frame.payload.insert(frame.payload.end(), pPayload, pPayload + payloadSize);
+  }
+  else
+  {
+    frame.sessionId = 0u;
+    frame.requestId = 0u;
+    frame.payload.assign(pBody, pBody + length);
+  }
+
+  m_readPos += frameSize;
+  return true;
+}
+
+std::uint64_t CoLaFrameDecoder::getDiscardedBytes() const
+{
+  return m_discardedBytes;
+}
+
+void CoLaFrameDecoder::reset()
+{
+  m_buffer.clear();
+  m_readPos        = 0u;
+  m_discardedBytes = 0u;
+}
+
+bool CoLaFrameDecoder::isMagicAt(std::size_t pos) const
+{
+  // a magic cut off at the end of the buffer counts, the rest of it may still be received
+  const std::size_t end = std::min(pos + kMagicSize, m_buffer.size());
+  for (std::size_t i = pos; i < end; ++i)
+  {
+    if (m_buffer[i] != kStx)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void CoLaFrameDecoder::skipToMagic(std::size_t pos)
+{
+  while ((pos < m_buffer.size()) && !isMagicAt(pos))
+  {
+    ++pos;
+  }
+  pos = std::min(pos, m_buffer.size());
+  m_discardedBytes += pos - m_readPos;
+  m_readPos = pos;
+}
+
+} // namespace visionary
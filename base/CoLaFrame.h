@@ -0,0 +1,85 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "VisionaryControl.h"
+
+namespace visionary {
+
+/// Default control port of a device for the given protocol (2112 for CoLa B, 2122 for CoLa 2)
+std::uint16_t defaultCoLaPort(VisionaryControl::ProtocolType protocol);
+
+/// One CoLa telegram as transported on the control port.
+///
+/// The payload is the command itself, e.g. "sRN " + variable name + binary parameters, which is the same
+/// layout as used by CoLaCommand::getBuffer(). Session and request id are only transported by CoLa 2.
+/// On the CoLa 2 wire the command mode has two letters ("RN " + ...): encodeCoLaFrame() drops the leading 's' and
+/// CoLaFrameDecoder adds it again, like CoLa2ProtocolHandler does. The session telegrams ("Ox", "OA", "Cx", "CA")
+/// are transported unchanged.
+struct CoLaFrame
+{
+  std::uint32_t             sessionId = 0u;
+  std::uint16_t             requestId = 0u;
+  std::vector<std::uint8_t> payload;
+};
+
+/// Adds the transport framing (magic, length, CoLa 2 header or CoLa B checksum) to a telegram
+std::vector<std::uint8_t> encodeCoLaFrame(VisionaryControl::ProtocolType protocol, const CoLaFrame& frame);
+
+/// Payload of the CoLa 2 "open session" request ('O' 'x')
+std::vector<std::uint8_t> makeCoLa2OpenSessionPayload(std::uint8_t sessionTimeoutSec, const std::string& clientId);
+
+/// Returns the three character command code of a telegram (e.g. "sRA", "sSN"), empty if the payload is too short
+std::string getCoLaCommandCode(const std::vector<std::uint8_t>& payload);
+
+/// Returns the variable, method or event name of a telegram (the token after the command code)
+std::string getCoLaCommandName(const std::vector<std::uint8_t>& payload);
+
+/// Returns the offset of the first parameter byte of a named telegram
+std::size_t getCoLaParameterOffset(const std::vector<std::uint8_t>& payload);
+
+/// Incremental decoder which splits a received byte stream into CoLa telegrams
+///
+/// Bytes which can not be the start of a telegram (wrong magic, implausible length, CoLa B checksum mismatch) are
+/// skipped up to the next magic, so garbage on the line costs the affected telegram but not the connection. CoLa 2
+/// has no checksum; a corrupted length there delays the resynchronisation until that many bytes were received.
+class CoLaFrameDecoder
+{
+public:
+  explicit CoLaFrameDecoder(VisionaryControl::ProtocolType protocol);
+
+  /// Appends received bytes
+  void push(const std::uint8_t* pData, std::size_t size);
+
+  /// Extracts the next complete telegram
+  ///
+  /// \param[out] frame the decoded telegram
+  ///
+  /// \retval true  a telegram was extracted
+  /// \retval false more data is needed
+  bool pop(CoLaFrame& frame);
+
+  /// Number of bytes skipped to resynchronise since construction or reset()
+  std::uint64_t getDiscardedBytes() const;
+
+  void reset();
+
+private:
+  bool isMagicAt(std::size_t pos) const;
+  void skipToMagic(std::size_t pos);
+
+  VisionaryControl::ProtocolType m_protocol;
+  std::vector<std::uint8_t>      m_buffer;
+  std::size_t                    m_readPos;
+  std::uint64_t                  m_discardedBytes;
+};
+
+} // namespace visionary
@@ -0,0 +1,123 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "CoLaLogin.h"
+
+#include "CoLaParameterReader.h"
+#include "CoLaParameterWriter.h"
+
+namespace visionary {
+
+namespace {
+
+// GetChallenge answer: USInt status, challenge, salt; SetUserLevel answer: USInt status
+const std::size_t  kChallengeSize = 16u;
+const std::size_t  kSaltSize      = 16u;
+const std::uint8_t kStatusOk      = 0u;
+
+const char* getUserLevelName(IAuthentication::UserLevel level)
+{
+  switch (level)
+  {
+    case IAuthentication::UserLevel::RUN:
+      return "Run";
+    case IAuthentication::UserLevel::OPERATOR:
+      return "Operator";
+    case IAuthentication::UserLevel::MAINTENANCE:
+      return "Maintenance";
+    case IAuthentication::UserLevel::AUTHORIZED_CLIENT:
+      return "AuthorizedClient";
+    case IAuthentication::UserLevel::SERVICE:
+      return "Service";
+  }
+  return "";
+}
+
+/// True if the response is an answer with at least numBytes parameter bytes
+bool hasParameters(CoLaCommand& response, std::size_t numBytes)
+{
+  return (response.getError() == CoLaError::OK)
+         && (response.getBuffer().size() >= response.getParameterOffset() + numBytes);
+}
+
+bool loginLegacy(IAuthentication::UserLevel userLevel,
+                 const std::string&         password,
+                 const CoLaCommandSender&   sendCommand)
+{
+  CoLaCommand response = sendCommand(CoLaParameterWriter(CoLaCommandType::METHOD_INVOCATION, "SetAccessMode")
+                                       .parameterSInt(static_cast<std::int8_t>(userLevel))
+                                       .parameterPasswordMD5(password)
+                                       .build());
+  return hasParameters(response, 1u) && CoLaParameterReader(response).readBool();
+}
+
+bool loginSecure(IAuthentication::UserLevel userLevel,
+                 const std::string&         password,
+                 const CoLaCommandSender&   sendCommand)
+{
+  CoLaCommand challengeResponse = sendCommand(CoLaParameterWriter(CoLaCommandType::METHOD_INVOCATION, "GetChallenge")
+                                                .parameterUSInt(static_cast<std::uint8_t>(userLevel))
+                                                .build());
+  if (!hasParameters(challengeResponse, 1u + kChallengeSize + kSaltSize))
+  {
+    return false;
+  }
+  CoLaParameterReader reader(challengeResponse);
+  if (reader.readUSInt() != kStatusOk)
+  {
+    return false;
+  }
+  std::vector<std::uint8_t> challenge(kChallengeSize);
+  std::vector<std::uint8_t> salt(kSaltSize);
+  for (std::uint8_t& byte : challenge)
+  {
+    byte = reader.readUSInt();
+  }
+  for (std::uint8_t& byte : salt)
+  {
+    byte = reader.readUSInt();
+  }
+
+  const Sha256Digest  digest = computeCoLaChallengeResponse(userLevel, password, salt, challenge);
+  CoLaParameterWriter writer(CoLaCommandType::METHOD_INVOCATION, "SetUserLevel");
+  for (std::uint8_t byte : digest)
+  {
+    writer.parameterUSInt(byte);
+  }
+  writer.parameterUSInt(static_cast<std::uint8_t>(userLevel));
+  CoLaCommand response = sendCommand(writer.build());
+  return hasParameters(response, 1u) && (CoLaParameterReader(response).readUSInt() == kStatusOk);
+}
+
+} // namespace
+
+bool loginCoLa(VisionaryControl::ProtocolType protocol,
+               IAuthentication::UserLevel     userLevel,
+               const std::string&             password,
+               const CoLaCommandSender&       sendCommand)
+{
+  if (protocol == VisionaryControl::ProtocolType::COLA_2)
+  {
+    return loginSecure(userLevel, password, sendCommand);
+  }
+  return loginLegacy(userLevel, password, sendCommand);
+}
+
+Sha256Digest computeCoLaChallengeResponse(IAuthentication::UserLevel       userLevel,
+                                          const std::string&               password,
+                                          const std::vector<std::uint8_t>& salt,
+                                          const std::vector<std::uint8_t>& challenge)
+{
+  const std::string         prefix = std::string(getUserLevelName(userLevel)) + ":SICK Sensor:" + password + ":";
+  std::vector<std::uint8_t> data(prefix.begin(), prefix.end());
+  data.insert(data.end(), salt.begin(), salt.end());
+  const Sha256Digest passwordHash = sha256(data);
+
+  data.assign(passwordHash.begin(), passwordHash.end());
+  data.insert(data.end(), challenge.begin(), challenge.end());
+  return sha256(data);
+}
+
+} // namespace visionary
@@ -0,0 +1,53 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "CoLaCommand.h"
+#include "IAuthentication.h"
+#include "Sha256.h"
+#include "VisionaryControl.h"
+
+namespace visionary {
+
+/// Sends a command and returns the response (CoLaCommand::networkErrorCommand() if there is none)
+typedef std::function<CoLaCommand(CoLaCommand command)> CoLaCommandSender;
+
+/// Logs in with the method of the protocol, like VisionaryControl::login() does
+///
+/// - CoLa B: SetAccessMode with the user level and the MD5 hash of the password
+/// - CoLa 2: GetChallenge for the user level, then SetUserLevel with the challenge response (see
+///   computeCoLaChallengeResponse())
+///
+/// The commands are sent through a callback, so the connections of base/ (SharedControlSession, AsyncControl) can
+/// log in the same way.
+///
+/// \param[in] protocol    protocol of the connection
+/// \param[in] userLevel   user level to log in with
+/// \param[in] password    password of the user level
+/// \param[in] sendCommand sends one command and waits for its response
+///
+/// \retval true  the device accepted the password
+/// \retval false wrong password, unknown user level or no response
+bool loginCoLa(VisionaryControl::ProtocolType protocol,
+               IAuthentication::UserLevel     userLevel,
+               const std::string&             password,
+               const CoLaCommandSender&       sendCommand);
+
+/// Response to a CoLa 2 login challenge (the parameter of SetUserLevel)
+///
+/// SHA-256 over the SHA-256 of "<user level name>:SICK Sensor:<password>:<salt>" followed by the challenge, with
+/// the user level names "Run", "Operator", "Maintenance", "AuthorizedClient" and "Service".
+Sha256Digest computeCoLaChallengeResponse(IAuthentication::UserLevel       userLevel,
+                                          const std::string&               password,
+                                          const std::vector<std::uint8_t>& salt,
+                                          const std::vector<std::uint8_t>& challenge);
+
+} // namespace visionary
@@ -0,0 +1,209 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "CoLaRequestTracker.h"
+
+#include <algorithm>
+
+namespace visionary {
+
+CoLaRequestTracker::CoLaRequestTracker()
+  : m_isCoLa2(false), m_staleTimeoutMs(5000u), m_nextRequestId(1u), m_staleResponses(0u), m_pStatistics(nullptr)
+{
+}
+
+void CoLaRequestTracker::reset(VisionaryControl::ProtocolType protocol, std::uint32_t staleTimeoutMs)
+{
+  m_isCoLa2        = (protocol == VisionaryControl::ProtocolType::COLA_2);
+  m_staleTimeoutMs = staleTimeoutMs;
+  m_staleResponses = 0u;
+  m_inFlight.clear();
+}
+
+std::uint16_t CoLaRequestTracker::nextRequestId()
+{
+  const std::uint16_t requestId = m_nextRequestId++;
+  if (m_nextRequestId == 0u)
+  {
+    m_nextRequestId = 1u;
+  }
+  return requestId;
+}
+
+bool CoLaRequestTracker::canSend(std::size_t maxInFlight) const
+{
+  return m_isCoLa2 ? (m_inFlight.size() < maxInFlight) : (m_inFlight.empty() && (m_staleResponses == 0u));
+}
+
+void CoLaRequestTracker::setStatistics(CommandStatistics* pStatistics)
+{
+  m_pStatistics = pStatistics;
+}
+
+void CoLaRequestTracker::addInFlight(Request request, std::vector<std::uint8_t>* pPayload)
+{
+  if (m_pStatistics != nullptr)
+  {
+    request.pCounters = &m_pStatistics->getCounters(request.payload);
+    request.sendTime  = Clock::now();
+  }
+  if (pPayload != nullptr)
+  {
+    pPayload->swap(request.payload);
+  }
+  request.payload.clear();
+  const std::uint16_t requestId = request.requestId;
+  m_inFlight[requestId]         = std::move(request);
+}
+
+void CoLaRequestTracker::handleResponse(const CoLaFrame& frame, Completions& completions)
+{
+  if (getCoLaCommandCode(frame.payload) == "sSN")
+  {
+    // events are not handled by request/response connections (see CoLaEventChannel)
+    return;
+  }
+
+  std::map<std::uint16_t, Request>::iterator it;
+  if (m_isCoLa2)
+  {
+    it = m_inFlight.find(frame.requestId);
+  }
+  else if (m_staleResponses > 0u)
+  {
+    // late response to a request which timed out
+    --m_staleResponses;
+    return;
+  }
+  else
+  {
+    it = m_inFlight.begin();
+  }
+
+  if (it == m_inFlight.end())
+  {
+    // late response to a request which timed out, or unsolicited
+    return;
+  }
+  if (it->second.pCounters != nullptr)
+  {
+    const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - it->second.sendTime);
+    it->second.pCounters->latency.record(static_cast<std::uint64_t>(latency.count()));
+    if (getCoLaCommandCode(frame.payload) == "sFA")
+    {
+      it->second.pCounters->errors.fetch_add(1u, std::memory_order_relaxed);
+    }
+  }
+  completions.push_back(std::make_pair(std::move(it->second.callback), frame.payload));
+  m_inFlight.erase(it);
+}
+
+void CoLaRequestTracker::expire(Clock::time_point now, Completions& completions)
+{
+  for (auto it = m_inFlight.begin(); it != m_inFlight.end();)
+  {
+    if (it->second.deadline > now)
+    {
+      ++it;
+      continue;
+    }
+    if (!m_isCoLa2)
+    {
+      // the response may still arrive and must not be taken for the response of the next request
+      ++m_staleResponses;
+      m_staleDeadline = now + std::chrono::milliseconds(m_staleTimeoutMs);
+    }
+    if (it->second.pCounters != nullptr)
+    {
+      it->second.pCounters->timeouts.fetch_add(1u, std::memory_order_relaxed);
+    }
+    completions.push_back(std::make_pair(std::move(it->second.callback), std::vector<std::uint8_t>()));
+    it = m_inFlight.erase(it);
+  }
+
+  if ((m_staleResponses > 0u) && (now >= m_staleDeadline))
+  {
+    // the device swallowed the requests, don't wait for their responses any longer
+    m_staleResponses = 0u;
+  }
+}
+
+void CoLaRequestTracker::failAll(Completions& completions)
+{
+  for (auto& entry : m_inFlight)
+  {
+    if (entry.second.pCounters != nullptr)
+    {
+      entry.second.pCounters->aborted.fetch_add(1u, std::memory_order_relaxed);
+    }
+    completions.push_back(std::make_pair(std::move(entry.second.callback), std::vector<std::uint8_t>()));
+  }
+  m_inFlight.clear();
+  m_staleResponses = 0u;
+}
+
+CoLaRequestTracker::Clock::time_point CoLaRequestTracker::nextDeadline(Clock::time_point limit) const
+{
+  for (const auto& entry : m_inFlight)
+  {
+    limit = std::min(limit, entry.second.deadline);
+  }
+  if (m_staleResponses > 0u)
+  {
+    limit = std::min(limit, m_staleDeadline);
+  }
+  return limit;
+}
+
+std::size_t CoLaRequestTracker::getInFlightCount() const
+{
+  return m_inFlight.size();
+}
+
+void CoLaRequestTracker::expireQueue(std::deque<Request>& queue, Clock::time_point now, Completions& completions)
+{
+  for (auto it = queue.begin(); it != queue.end();)
+  {
+    if (it->deadline > now)
+    {
+      ++it;
+      continue;
+    }
+    completions.push_back(std::make_pair(std::move(it->callback), std::vector<std::uint8_t>()));
+    it = queue.erase(it);
+  }
+}
+
+void CoLaRequestTracker::failQueue(std::deque<Request>& queue, Completions& completions)
+{
+  for (auto& request : queue)
+  {
+    completions.push_back(std::make_pair(std::move(request.callback), std::vector<std::uint8_t>()));
+  }
+  queue.clear();
+}
+
+CoLaRequestTracker::Clock::time_point CoLaRequestTracker::nextDeadline(const std::deque<Request>& queue,
+                                                                       Clock::time_point          limit)
+{
+  for (const auto& request : queue)
+  {
+    limit = std::min(limit, request.deadline);
+  }
+  return limit;
+}
+
+void CoLaRequestTracker::complete(Completions& completions)
+{
+  for (auto& completion : completions)
+  {
+    CoLaCommand response =
+      completion.second.empty() ? CoLaCommand::networkErrorCommand() : CoLaCommand(completion.second);
+    completion.first(response);
+  }
+  completions.clear();
+}
+
+} // namespace visionary
@@ -0,0 +1,118 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "CoLaCommand.h"
+#include "CoLaFrame.h"
+#include "CommandStatistics.h"
+#include "VisionaryControl.h"
+
+namespace visionary {
+
+/// Bookkeeping of the requests in flight on one control connection
+///
+/// Matches responses to requests (by request id for CoLa 2, in order for CoLa B) and expires requests after their
+/// deadline without closing the connection. For CoLa B the late response of an expired request would be taken for
+/// the response of the next one, so canSend() holds back further requests until it arrived (or for one more
+/// timeout period).
+///
+/// The class is not thread safe; the owner serializes all calls.
+class CoLaRequestTracker
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  /// Completion callback, receives the response or CoLaCommand::networkErrorCommand() on timeout or connection loss
+  typedef std::function<void(CoLaCommand& response)> ResponseCallback;
+
+  struct Request
+  {
+    std::uint16_t             requestId = 0u;
+    std::vector<std::uint8_t> payload;
+    Clock::time_point         deadline;
+    ResponseCallback          callback;
+
+    // set by addInFlight() if statistics are recorded
+    Clock::time_point            sendTime;
+    CommandStatistics::Counters* pCounters = nullptr;
+  };
+
+  /// Callbacks to invoke outside of any lock, with the response payload (empty for errors), see complete()
+  typedef std::vector<std::pair<ResponseCallback, std::vector<std::uint8_t>>> Completions;
+
+  CoLaRequestTracker();
+
+  /// Drops all state (without completing anything) and prepares for a new connection
+  ///
+  /// \param[in] protocol       protocol of the connection
+  /// \param[in] staleTimeoutMs CoLa B: how long to wait for the late response of an expired request
+  void reset(VisionaryControl::ProtocolType protocol, std::uint32_t staleTimeoutMs);
+
+  /// Request id for the next request (never 0, which is used by the session handshake)
+  std::uint16_t nextRequestId();
+
+  /// True if one more request may be sent
+  ///
+  /// \param[in] maxInFlight CoLa 2: maximum number of requests in flight (CoLa B always allows one)
+  bool canSend(std::size_t maxInFlight) const;
+
+  /// Records the latency, errors and timeouts of the requests in flight (nullptr disables the recording)
+  ///
+  /// \param[in] pStatistics statistics to record into, must outlive the tracker
+  void setStatistics(CommandStatistics* pStatistics);
+
+  /// Registers a request which has been (or is about to be) sent. The payload is not needed any longer.
+  ///
+  /// \param[in]  request  request to track
+  /// \param[out] pPayload optional, receives the payload (e.g. to send it after registering) instead of dropping it
+  void addInFlight(Request request, std::vector<std::uint8_t>* pPayload = nullptr);
+
+  /// Matches a received telegram to its request; events and late responses are ignored
+  void handleResponse(const CoLaFrame& frame, Completions& completions);
+
+  /// Expires all requests in flight whose deadline has passed
+  void expire(Clock::time_point now, Completions& completions);
+
+  /// Completes all requests in flight with an error
+  void failAll(Completions& completions);
+
+  /// The earliest deadline of the requests in flight, but not later than limit
+  Clock::time_point nextDeadline(Clock::time_point limit) const;
+
+  std::size_t getInFlightCount() const;
+
+  /// Expires the requests of a send queue whose deadline has passed
+  static void expireQueue(std::deque<Request>& queue, Clock::time_point now, Completions& completions);
+
+  /// Completes the requests of a send queue with an error and clears it
+  static void failQueue(std::deque<Request>& queue, Completions& completions);
+
+  /// The earliest deadline of a send queue, but not later than limit
+  static Clock::time_point nextDeadline(const std::deque<Request>& queue, Clock::time_point limit);
+
+  /// Invokes the callbacks
+  static void complete(Completions& completions);
+
+private:
+  bool                             m_isCoLa2;
+  std::uint32_t                    m_staleTimeoutMs;
+  std::map<std::uint16_t, Request> m_inFlight;
+  std::uint16_t                    m_nextRequestId;
+  std::size_t                      m_staleResponses; // CoLa B: late responses still to drop
+  Clock::time_point                m_staleDeadline;
+  CommandStatistics*               m_pStatistics;
+};
+
+} // namespace visionary
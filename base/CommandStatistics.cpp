@@ -0,0 +1,139 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "CommandStatistics.h"
+
+#include <cstdio>
+
+#include "CoLaFrame.h"
+
+namespace visionary {
+
+CommandStatistics::Counters::Counters() : errors(0u), timeouts(0u), aborted(0u) {}
+
+CommandStatistics::CommandStatistics()
+  : m_telegramsSent(0u), m_telegramsReceived(0u), m_bytesSent(0u), m_bytesReceived(0u)
+{
+}
+
+CommandStatistics::Counters& CommandStatistics::getCounters(const std::vector<std::uint8_t>& payload)
+{
+  const std::string key = getCoLaCommandCode(payload) + ' ' + getCoLaCommandName(payload);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::unique_ptr<Counters>&  pCounters = m_commands[key];
+  if (!pCounters)
+  {
+    pCounters.reset(new Counters());
+  }
+  return *pCounters;
+}
+
+void CommandStatistics::addSent(std::size_t bytes)
+{
+  m_telegramsSent.fetch_add(1u, std::memory_order_relaxed);
+  m_bytesSent.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void CommandStatistics::addReceived(std::size_t bytes)
+{
+  m_bytesReceived.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void CommandStatistics::addTelegramReceived()
+{
+  m_telegramsReceived.fetch_add(1u, std::memory_order_relaxed);
+}
+
+CommandStatistics::Snapshot CommandStatistics::snapshot() const
+{
+  Snapshot snapshot;
+  snapshot.telegramsSent     = m_telegramsSent.load(std::memory_order_relaxed);
+  snapshot.telegramsReceived = m_telegramsReceived.load(std::memory_order_relaxed);
+  snapshot.bytesSent         = m_bytesSent.load(std::memory_order_relaxed);
+  snapshot.bytesReceived     = m_bytesReceived.load(std::memory_order_relaxed);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  snapshot.commands.reserve(m_commands.size());
+  for (const auto& entry : m_commands)
+  {
+    CommandSnapshot command;
+    command.command  = entry.first;
+    command.latency  = entry.second->latency.snapshot();
+    command.errors   = entry.second->errors.load(std::memory_order_relaxed);
+    command.timeouts = entry.second->timeouts.load(std::memory_order_relaxed);
+    command.aborted  = entry.second->aborted.load(std::memory_order_relaxed);
+    snapshot.commands.push_back(std::move(command));
+  }
+  return snapshot;
+}
+
+void CommandStatistics::reset()
+{
+  m_telegramsSent.store(0u, std::memory_order_relaxed);
+  m_telegramsReceived.store(0u, std::memory_order_relaxed);
+  m_bytesSent.store(0u, std::memory_order_relaxed);
+  m_bytesReceived.store(0u, std::memory_order_relaxed);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto& entry : m_commands)
+  {
+    entry.second->latency.reset();
+    entry.second->errors.store(0u, std::memory_order_relaxed);
+    entry.second->timeouts.store(0u, std::memory_order_relaxed);
+    entry.second->aborted.store(0u, std::memory_order_relaxed);
+  }
+}
+
+std::string CommandStatistics::format(const Snapshot& snapshot)
+{
+  std::string text;
+  char        line[256];
+
+  std::snprintf(line,
+                sizeof(line),
+                "sent %llu telegrams (%llu bytes), received %llu telegrams (%llu bytes)\n",
+                static_cast<unsigned long long>(snapshot.telegramsSent),
+                static_cast<unsigned long long>(snapshot.bytesSent),
+                static_cast<unsigned long long>(snapshot.telegramsReceived),
+                static_cast<unsigned long long>(snapshot.bytesReceived));
+  text += line;
+  std::snprintf(line,
+                sizeof(line),
+                "%-32s %8s %6s %8s %7s %9s %9s %9s %9s %9s\n",
+                "command [us]",
+                "count",
+                "errors",
+                "timeouts",
+                "aborted",
+                "min",
+                "p50",
+                "p90",
+                "p99",
+                "max");
+  text += line;
+
+  for (const CommandSnapshot& command : snapshot.commands)
+  {
+    const LatencyHistogram::Snapshot& latency = command.latency;
+    std::snprintf(line,
+                  sizeof(line),
+                  "%-32s %8llu %6llu %8llu %7llu %9llu %9llu %9llu %9llu %9llu\n",
+                  command.command.c_str(),
+                  static_cast<unsigned long long>(latency.count),
+                  static_cast<unsigned long long>(command.errors),
+                  static_cast<unsigned long long>(command.timeouts),
+                  static_cast<unsigned long long>(command.aborted),
+                  static_cast<unsigned long long>(latency.minUs),
+                  static_cast<unsigned long long>(latency.percentile(50.)),
+                  static_cast<unsigned long long>(latency.percentile(90.)),
+                  static_cast<unsigned long long>(latency.percentile(99.)),
+                  static_cast<unsigned long long>(latency.maxUs));
+    text += line;
+  }
+  return text;
+}
+
+} // namespace visionary
@@ -0,0 +1,93 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "LatencyHistogram.h"
+
+namespace visionary {
+
+/// Statistics of the commands on a control connection
+///
+/// Per command type and name (e.g. "sRN DeviceIdent") the round trip latency is recorded in a LatencyHistogram
+/// together with the number of error responses, timeouts and commands aborted by a connection loss. For the whole
+/// connection the telegrams and bytes on the wire (including the transport framing) are counted.
+///
+/// AsyncControl and SharedControlSession keep statistics for their connection, see getStatistics(). Recording
+/// costs a map lookup per command and a few atomic increments, so it is always enabled.
+class CommandStatistics
+{
+public:
+  /// Counters of one command
+  struct Counters
+  {
+    LatencyHistogram           latency; ///< from sending the command until its response was received
+    std::atomic<std::uint64_t> errors;  ///< responses with a CoLa error (sFA)
+    std::atomic<std::uint64_t> timeouts;
+    std::atomic<std::uint64_t> aborted; ///< connection lost while waiting for the response
+
+    Counters();
+  };
+
+  struct CommandSnapshot
+  {
+    std::string                command; ///< command code and name, e.g. "sRN DeviceIdent"
+    LatencyHistogram::Snapshot latency;
+    std::uint64_t              errors   = 0u;
+    std::uint64_t              timeouts = 0u;
+    std::uint64_t              aborted  = 0u;
+  };
+
+  struct Snapshot
+  {
+    std::vector<CommandSnapshot> commands; ///< sorted by command
+    std::uint64_t                telegramsSent     = 0u;
+    std::uint64_t                telegramsReceived = 0u;
+    std::uint64_t                bytesSent         = 0u;
+    std::uint64_t                bytesReceived     = 0u;
+  };
+
+  CommandStatistics();
+
+  CommandStatistics(const CommandStatistics&)            = delete;
+  CommandStatistics& operator=(const CommandStatistics&) = delete;
+
+  /// Counters of the command of a telegram, created on first use; the reference stays valid until destruction
+  ///
+  /// \param[in] payload telegram, e.g. CoLaCommand::getBuffer()
+  Counters& getCounters(const std::vector<std::uint8_t>& payload);
+
+  void addSent(std::size_t bytes);
+  void addReceived(std::size_t bytes);
+  void addTelegramReceived();
+
+  Snapshot snapshot() const;
+
+  /// Resets all counters (the commands stay known)
+  void reset();
+
+  /// Text table of a snapshot, one line per command, latencies in microseconds
+  static std::string format(const Snapshot& snapshot);
+
+private:
+  mutable std::mutex                               m_mutex;
+  std::map<std::string, std::unique_ptr<Counters>> m_commands;
+
+  std::atomic<std::uint64_t> m_telegramsSent;
+  std::atomic<std::uint64_t> m_telegramsReceived;
+  std::atomic<std::uint64_t> m_bytesSent;
+  std::atomic<std::uint64_t> m_bytesReceived;
+};
+
+} // namespace visionary
@@ -0,0 +1,277 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "ConfigurationProfile.h"
+
+#include <algorithm>
+#include <fstream>
+#include <future>
+#include <sstream>
+
+#include "CoLaParameterWriter.h"
+
+namespace visionary {
+
+namespace {
+
+const char kHexDigits[] = "0123456789abcdef";
+
+int hexValue(char c)
+{
+  if ((c >= '0') && (c <= '9'))
+  {
+    return c - '0';
+  }
+  if ((c >= 'a') && (c <= 'f'))
+  {
+    return c - 'a' + 10;
+  }
+  if ((c >= 'A') && (c <= 'F'))
+  {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+bool parseHex(const std::string& text, std::vector<std::uint8_t>& bytes)
+{
+  if ((text.size() % 2u) != 0u)
+  {
+    return false;
+  }
+  bytes.clear();
+  bytes.reserve(text.size() / 2u);
+  for (std::size_t i = 0u; i < text.size(); i += 2u)
+  {
+    const int high = hexValue(text[i]);
+    const int low  = hexValue(text[i + 1u]);
+    if ((high < 0) || (low < 0))
+    {
+      return false;
+    }
+    bytes.push_back(static_cast<std::uint8_t>((high << 4) | low));
+  }
+  return true;
+}
+
+CoLaCommand makeWriteCommand(const std::string& name, const std::vector<std::uint8_t>& value)
+{
+  std::vector<std::uint8_t> buffer;
+  buffer.reserve(4u + name.size() + 1u + value.size());
+  const std::string header = "sWN " + name + ' ';
+  buffer.insert(buffer.end(), header.begin(), header.end());
+  buffer.insert(buffer.end(), value.begin(), value.end());
+  return CoLaCommand(buffer);
+}
+
+} // namespace
+
+void ConfigurationProfile::set(const std::string& name, const std::vector<std::uint8_t>& value)
+{
+  for (Entry& entry : m_entries)
+  {
+    if (entry.first == name)
+    {
+      entry.second = value;
+      return;
+    }
+  }
+  m_entries.push_back(Entry(name, value));
+}
+
+void ConfigurationProfile::remove(const std::string& name)
+{
+  m_entries.erase(std::remove_if(m_entries.begin(),
+                                 m_entries.end(),
+                                 [&name](const Entry& entry) { return entry.first == name; }),
+                  m_entries.end());
+}
+
+const std::vector<std::uint8_t>* ConfigurationProfile::find(const std::string& name) const
+{
+  for (const Entry& entry : m_entries)
+  {
+    if (entry.first == name)
+    {
+      return &entry.second;
+    }
+  }
+  return nullptr;
+}
+
+std::vector<std::string> ConfigurationProfile::getNames() const
+{
+  std::vector<std::string> names;
+  names.reserve(m_entries.size());
+  for (const Entry& entry : m_entries)
+  {
+    names.push_back(entry.first);
+  }
+  return names;
+}
+
+const std::vector<ConfigurationProfile::Entry>& ConfigurationProfile::getEntries() const
+{
+  return m_entries;
+}
+
+std::size_t ConfigurationProfile::size() const
+{
+  return m_entries.size();
+}
+
+bool ConfigurationProfile::empty() const
+{
+  return m_entries.empty();
+}
+
+ConfigurationProfile ConfigurationProfile::diff(const ConfigurationProfile& actual) const
+{
+  ConfigurationProfile delta;
+  for (const Entry& entry : m_entries)
+  {
+    const std::vector<std::uint8_t>* pActual = actual.find(entry.first);
+    if ((pActual == nullptr) || (*pActual != entry.second))
+    {
+      delta.m_entries.push_back(entry);
+    }
+  }
+  return delta;
+}
+
+bool ConfigurationProfile::read(AsyncControl&                   control,
+                                const std::vector<std::string>& names,
+                                std::vector<std::string>*       pFailed,
+                                std::uint32_t                   timeoutMs)
+{
+  // send all requests first, the responses are collected afterwards
+  std::vector<std::future<CoLaCommand>> responses;
+  responses.reserve(names.size());
+  for (const std::string& name : names)
+  {
+    responses.push_back(
+      control.sendCommandAsync(CoLaParameterWriter(CoLaCommandType::READ_VARIABLE, name.c_str()).build(), timeoutMs));
+  }
+
+  bool success = true;
+  for (std::size_t i = 0u; i < names.size(); ++i)
+  {
+    CoLaCommand response = responses[i].get();
+    if ((response.getError() != CoLaError::OK) || (response.getType() != CoLaCommandType::READ_VARIABLE_RESPONSE))
+    {
+      success = false;
+      if (pFailed != nullptr)
+      {
+        pFailed->push_back(names[i]);
+      }
+      continue;
+    }
+    const std::vector<std::uint8_t>& buffer = response.getBuffer();
+    const std::size_t                offset = std::min(response.getParameterOffset(), buffer.size());
+    set(names[i], std::vector<std::uint8_t>(buffer.begin() + static_cast<std::ptrdiff_t>(offset), buffer.end()));
+  }
+  return success;
+}
+
+bool ConfigurationProfile::write(AsyncControl&             control,
+                                 std::vector<std::string>* pFailed,
+                                 std::uint32_t             timeoutMs) const
+{
+  std::vector<std::future<CoLaCommand>> responses;
+  responses.reserve(m_entries.size());
+  for (const Entry& entry : m_entries)
+  {
+    responses.push_back(control.sendCommandAsync(makeWriteCommand(entry.first, entry.second), timeoutMs));
+  }
+
+  bool success = true;
+  for (std::size_t i = 0u; i < m_entries.size(); ++i)
+  {
+    CoLaCommand response = responses[i].get();
+    if ((response.getError() != CoLaError::OK) || (response.getType() != CoLaCommandType::WRITE_VARIABLE_RESPONSE))
+    {
+      success = false;
+      if (pFailed != nullptr)
+      {
+        pFailed->push_back(m_entries[i].first);
+      }
+    }
+  }
+  return success;
+}
+
+int ConfigurationProfile::apply(AsyncControl& control, std::vector<std::string>* pFailed, std::uint32_t timeoutMs) const
+{
+  ConfigurationProfile actual;
+  if (!actual.read(control, getNames(), pFailed, timeoutMs))
+  {
+    return -1;
+  }
+  const ConfigurationProfile delta = diff(actual);
+  if (!delta.write(control, pFailed, timeoutMs))
+  {
+    return -1;
+  }
+  return static_cast<int>(delta.size());
+}
+
+bool ConfigurationProfile::save(const std::string& filename) const
+{
+  std::ofstream file(filename.c_str());
+  if (!file)
+  {
+    return false;
+  }
+  file << "# SICK Visionary configuration profile: <variable> <CoLa binary value as hex>\n";
+  for (const Entry& entry : m_entries)
+  {
+    file << entry.first << ' ';
+    for (const std::uint8_t byte : entry.second)
+    {
+      file << kHexDigits[byte >> 4u] << kHexDigits[byte & 0x0fu];
+    }
+    file << '\n';
+  }
+  return static_cast<bool>(file);
+}
+
+bool ConfigurationProfile::load(const std::string& filename)
+{
+  std::ifstream file(filename.c_str());
+  if (!file)
+  {
+    return false;
+  }
+
+  ConfigurationProfile profile;
+  std::string          line;
+  while (std::getline(file, line))
+  {
+    std::istringstream stream(line);
+    std::string        name;
+    if (!(stream >> name) || (name[0] == '#'))
+    {
+      continue;
+    }
+    // every value has at least one byte, so a missing value is a syntax error
+    std::string               hex;
+    std::string               trailing;
+    std::vector<std::uint8_t> value;
+    if (!(stream >> hex) || (stream >> trailing) || !parseHex(hex, value))
+    {
+      return false;
+    }
+    profile.set(name, value);
+  }
+  if (file.bad())
+  {
+    return false;
+  }
+
+  m_entries.swap(profile.m_entries);
+  return true;
+}
+
+} // namespace visionary
@@ -0,0 +1,105 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "AsyncControl.h"
+
+namespace visionary {
+
+/// Set of device variables with their values
+///
+/// A profile describes a known device configuration. The values are kept in their CoLa binary encoding (the
+/// parameter bytes of a read variable response), so any variable can be part of a profile without knowing its type,
+/// and comparing two values is a byte comparison.
+///
+/// Bringing a device into the configuration of a profile takes three pipelined batches instead of one blocking
+/// round trip per variable: read() all variables, diff() against the desired values and write() only the
+/// differing ones. apply() does all three.
+///
+/// Variables are written in the order they were added to the profile, so put variables other variables depend on
+/// (e.g. the frontend mode) first.
+class ConfigurationProfile
+{
+public:
+  typedef std::pair<std::string, std::vector<std::uint8_t>> Entry;
+
+  /// Adds a variable or replaces its value (the position of a replaced variable is kept)
+  ///
+  /// \param[in] name  communication name of the variable
+  /// \param[in] value CoLa binary encoded value, e.g. built with CoLaParameterWriter and taken from
+  ///                  getBuffer() starting at getParameterOffset()
+  void set(const std::string& name, const std::vector<std::uint8_t>& value);
+
+  /// Removes a variable
+  void remove(const std::string& name);
+
+  /// The value of a variable, or nullptr if it is not part of the profile
+  const std::vector<std::uint8_t>* find(const std::string& name) const;
+
+  /// Names of the variables in write order
+  std::vector<std::string> getNames() const;
+
+  const std::vector<Entry>& getEntries() const;
+  std::size_t               size() const;
+  bool                      empty() const;
+
+  /// The entries of this (desired) profile whose value differs from actual or which are missing in actual
+  ConfigurationProfile diff(const ConfigurationProfile& actual) const;
+
+  /// Reads the current values of variables from a device, all requests are sent without waiting for responses
+  ///
+  /// \param[in] control   connected control channel
+  /// \param[in] names     communication names of the variables
+  /// \param[in] pFailed   optional, receives the names which could not be read
+  /// \param[in] timeoutMs timeout of each request; 0 selects the timeout of the control channel
+  ///
+  /// \retval true  all variables were read
+  /// \retval false at least one variable could not be read, the others are part of the profile
+  bool read(AsyncControl&                   control,
+            const std::vector<std::string>& names,
+            std::vector<std::string>*       pFailed   = nullptr,
+            std::uint32_t                   timeoutMs = 0u);
+
+  /// Writes all variables of the profile to a device, all requests are sent without waiting for responses
+  ///
+  /// The device only accepts the writes after a login, usually as AUTHORIZED_CLIENT (see AsyncControl::login()).
+  ///
+  /// \param[in] control   connected control channel
+  /// \param[in] pFailed   optional, receives the names which were rejected or not answered
+  /// \param[in] timeoutMs timeout of each request; 0 selects the timeout of the control channel
+  ///
+  /// \retval true  the device accepted all values
+  /// \retval false at least one write failed
+  bool write(AsyncControl& control, std::vector<std::string>* pFailed = nullptr, std::uint32_t timeoutMs = 0u) const;
+
+  /// Reads the variables of the profile from a device and writes the ones with a different value
+  ///
+  /// \param[in] control   connected control channel, logged in (see AsyncControl::login())
+  /// \param[in] pFailed   optional, receives the names which could not be read or written
+  /// \param[in] timeoutMs timeout of each request; 0 selects the timeout of the control channel
+  ///
+  /// \return number of variables written, or -1 if a variable could not be read or written
+  int apply(AsyncControl& control, std::vector<std::string>* pFailed = nullptr, std::uint32_t timeoutMs = 0u) const;
+
+  /// Stores the profile in a text file, one variable per line (name and value as hex bytes)
+  bool save(const std::string& filename) const;
+
+  /// Loads a profile stored with save(); empty lines and lines starting with '#' are ignored
+  ///
+  /// \retval false the file could not be read or has a syntax error, the profile is left unchanged
+  bool load(const std::string& filename);
+
+private:
+  std::vector<Entry> m_entries;
+};
+
+} // namespace visionary
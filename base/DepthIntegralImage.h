@@ -0,0 +1,75 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "MapView.h"
+
+namespace visionary {
+
+/// Summed-area tables of a depth map for measurements in many rectangular regions
+///
+/// build() sums up the valid depths and counts the valid pixels (depth not 0) of every rectangle from the top left
+/// corner of the map once per frame. Afterwards the sum, count and mean of any region take four table lookups,
+/// independent of its size. The tables are reused from frame to frame.
+///
+/// Example:
+/// \code
+/// DepthIntegralImage integral;
+/// integral.build(getDistanceView(data));
+/// for (const MapRoi& roi : measurementRegions)
+/// {
+///   double meanDistance = integral.getMeanDepth(roi);
+/// }
+/// \endcode
+class DepthIntegralImage
+{
+public:
+  DepthIntegralImage();
+
+  /// Builds the tables of a frame
+  ///
+  /// \param[in] depth depth map, e.g. getDistanceView(data); the view is only read during the call
+  void build(const MapView<std::uint16_t>& depth);
+
+  /// Size of the map of the last build()
+  std::size_t getWidth() const;
+  std::size_t getHeight() const;
+
+  // Queries of a rectangle; the rectangle is clipped to the map, outside of it the results are 0
+
+  /// Sum of the valid depths in the unit of the map
+  std::uint64_t getDepthSum(const MapRoi& roi) const;
+
+  /// Number of valid pixels
+  std::uint32_t getValidCount(const MapRoi& roi) const;
+
+  /// Mean of the valid depths, 0 if there is no valid pixel
+  double getMeanDepth(const MapRoi& roi) const;
+
+private:
+  struct Corners
+  {
+    std::size_t topLeft;
+    std::size_t topRight;
+    std::size_t bottomLeft;
+    std::size_t bottomRight;
+  };
+
+  // indices into the tables; false if the clipped rectangle is empty
+  bool getCorners(const MapRoi& roi, Corners& corners) const;
+
+  std::size_t m_width;
+  std::size_t m_height;
+  // (width + 1) * (height + 1) entries; the first row and column are 0, so queries need no special cases
+  std::vector<std::uint64_t> m_depthSums;
+  std::vector<std::uint32_t> m_validCounts;
+};
+
+} // namespace visionary
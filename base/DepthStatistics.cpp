@@ -0,0 +1,139 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "DepthStatistics.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace visionary {
+
+const std::size_t DepthStatistics::kNumStateBits;
+
+namespace {
+
+// pixels accumulated with 32 bit sums and 16 bit state counters (which vectorize with more lanes than 64 bit sums)
+// before they are added to the totals; small enough to stay in the L1 cache between the depth and the state loop
+const std::size_t kBlockSize = 4096u;
+
+struct Totals
+{
+  std::uint64_t validCount;
+  std::uint64_t depthSum;
+  std::uint16_t minDepthMinusOne; // invalid pixels (0) wrap around to the largest value
+  std::uint16_t maxDepth;
+  std::uint64_t stateClearCount;
+  std::uint64_t stateBitCounts[DepthStatistics::kNumStateBits];
+};
+
+// the loops below have no branches, so the compiler vectorizes them (gcc and clang at -O3, the Release default)
+
+void accumulateDepth(const std::uint16_t* pDepth, std::size_t count, Totals& totals)
+{
+  std::uint32_t validCount       = 0u;
+  std::uint32_t depthSum         = 0u;
+  std::uint16_t minDepthMinusOne = std::numeric_limits<std::uint16_t>::max();
+  std::uint16_t maxDepth         = 0u;
+  for (std::size_t i = 0u; i < count; ++i)
+  {
+    const std::uint16_t depth = pDepth[i];
+    // invalid pixels add nothing to the sum and the maximum
+    validCount += (depth != 0u) ? 1u : 0u;
+    depthSum += depth;
+    const std::uint16_t depthMinusOne = static_cast<std::uint16_t>(depth - 1u);
+    minDepthMinusOne                  = (depthMinusOne < minDepthMinusOne) ? depthMinusOne : minDepthMinusOne;
+    maxDepth                          = (depth > maxDepth) ? depth : maxDepth;
+  }
+  totals.validCount += validCount;
+  totals.depthSum += depthSum;
+  totals.minDepthMinusOne = std::min(totals.minDepthMinusOne, minDepthMinusOne);
+  totals.maxDepth         = std::max(totals.maxDepth, maxDepth);
+}
+
+void accumulateState(const std::uint16_t* pState, std::size_t count, Totals& totals)
+{
+  std::uint32_t clearCount                                = 0u;
+  std::uint16_t bitCounts[DepthStatistics::kNumStateBits] = {};
+  for (std::size_t i = 0u; i < count; ++i)
+  {
+    const std::uint16_t state = pState[i];
+    clearCount += (state == 0u) ? 1u : 0u;
+    // one vector lane per bit
+    for (unsigned bit = 0u; bit < DepthStatistics::kNumStateBits; ++bit)
+    {
+      bitCounts[bit] = static_cast<std::uint16_t>(bitCounts[bit] + ((state >> bit) & 1u));
+    }
+  }
+  totals.stateClearCount += clearCount;
+  for (std::size_t bit = 0u; bit < DepthStatistics::kNumStateBits; ++bit)
+  {
+    totals.stateBitCounts[bit] += bitCounts[bit];
+  }
+}
+
+} // namespace
+
+DepthStatistics computeDepthStatistics(const MapView<std::uint16_t>& depth, const MapView<std::uint16_t>& state)
+{
+  if (depth.empty())
+  {
+    return DepthStatistics();
+  }
+  const bool hasState = !state.empty() && (state.width == depth.width) && (state.height == depth.height);
+
+  Totals totals           = Totals();
+  totals.minDepthMinusOne = std::numeric_limits<std::uint16_t>::max();
+  for (std::size_t y = 0u; y < depth.height; ++y)
+  {
+    for (std::size_t x = 0u; x < depth.width; x += kBlockSize)
+    {
+      const std::size_t count = std::min(kBlockSize, depth.width - x);
+      accumulateDepth(depth.row(y) + x, count, totals);
+      if (hasState)
+      {
+        accumulateState(state.row(y) + x, count, totals);
+      }
+    }
+  }
+
+  DepthStatistics statistics = DepthStatistics();
+  statistics.pixelCount      = depth.size();
+  statistics.validCount      = static_cast<std::size_t>(totals.validCount);
+  statistics.validRatio      = static_cast<double>(statistics.validCount) / static_cast<double>(statistics.pixelCount);
+  if (statistics.validCount > 0u)
+  {
+    statistics.minDepth  = static_cast<std::uint16_t>(totals.minDepthMinusOne + 1u);
+    statistics.maxDepth  = totals.maxDepth;
+    statistics.meanDepth = static_cast<double>(totals.depthSum) / static_cast<double>(totals.validCount);
+  }
+  statistics.stateClearCount = static_cast<std::size_t>(totals.stateClearCount);
+  for (std::size_t bit = 0u; bit < DepthStatistics::kNumStateBits; ++bit)
+  {
+    statistics.stateBitCounts[bit] = static_cast<std::size_t>(totals.stateBitCounts[bit]);
+  }
+  return statistics;
+}
+
+DepthStatistics computeDepthStatistics(const VisionaryTMiniData& data)
+{
+  return computeDepthStatistics(getDistanceView(data), getStateView(data));
+}
+
+DepthStatistics computeDepthStatistics(const VisionaryTMiniData& data, const MapRoi& roi)
+{
+  return computeDepthStatistics(getDistanceView(data).crop(roi), getStateView(data).crop(roi));
+}
+
+DepthStatistics computeDepthStatistics(const VisionarySData& data)
+{
+  return computeDepthStatistics(getZView(data), getConfidenceView(data));
+}
+
+DepthStatistics computeDepthStatistics(const VisionarySData& data, const MapRoi& roi)
+{
+  return computeDepthStatistics(getZView(data).crop(roi), getConfidenceView(data).crop(roi));
+}
+
+} // namespace visionary
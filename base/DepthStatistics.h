@@ -0,0 +1,51 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "MapView.h"
+#include "VisionarySData.h"
+#include "VisionaryTMiniData.h"
+
+namespace visionary {
+
+/// Summary of the depth and state maps of a frame (or of a region of it) for health monitoring
+struct DepthStatistics
+{
+  static const std::size_t kNumStateBits = 16u;
+
+  std::size_t   pixelCount;                    ///< pixels evaluated
+  std::size_t   validCount;                    ///< pixels with a depth value; 0 marks an invalid pixel
+  double        validRatio;                    ///< validCount / pixelCount, 0 if no pixel was evaluated
+  std::uint16_t minDepth;                      ///< smallest valid depth, 0 if there is no valid pixel
+  std::uint16_t maxDepth;                      ///< largest valid depth, 0 if there is no valid pixel
+  double        meanDepth;                     ///< mean of the valid depths, 0 if there is no valid pixel
+  std::size_t   stateClearCount;               ///< pixels without any state flag; 0 if there is no state map
+  std::size_t   stateBitCounts[kNumStateBits]; ///< pixels per state flag (bit 0 first); 0 if there is no state map
+};
+
+/// Computes the statistics in one pass over the maps
+///
+/// The depth values are in the unit of the map (0.25 mm for the distance map of the Visionary-T Mini, mm for the
+/// Z map of the Visionary-S). The loops are written for the auto-vectorizer of the compiler, so the statistics
+/// cost about as much as reading the maps once.
+///
+/// \param[in] depth depth map, e.g. getDistanceView(data); may be cropped to a region of interest
+/// \param[in] state state map of the same frame and region; an empty view skips the state counts
+DepthStatistics computeDepthStatistics(const MapView<std::uint16_t>& depth,
+                                       const MapView<std::uint16_t>& state = MapView<std::uint16_t>());
+
+/// Statistics of the distance and state map of a Visionary-T Mini frame
+DepthStatistics computeDepthStatistics(const VisionaryTMiniData& data);
+DepthStatistics computeDepthStatistics(const VisionaryTMiniData& data, const MapRoi& roi);
+
+/// Statistics of the Z and confidence map of a Visionary-S frame
+DepthStatistics computeDepthStatistics(const VisionarySData& data);
+DepthStatistics computeDepthStatistics(const VisionarySData& data, const MapRoi& roi);
+
+} // namespace visionary
@@ -0,0 +1,125 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "FleetBringUp.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <utility>
+
+namespace visionary {
+
+const std::size_t FleetBringUp::kNumPhases;
+
+FleetBringUp::DeviceReport::DeviceReport()
+{
+  phaseTimes.fill(std::chrono::microseconds(0));
+}
+
+FleetBringUp::FleetBringUp(Options options) : m_options(std::move(options))
+{
+}
+
+std::vector<FleetBringUp::DeviceReport> FleetBringUp::run(const std::vector<Device>& devices) const
+{
+  std::vector<DeviceReport> reports(devices.size());
+  const Clock::time_point   startTime = Clock::now();
+
+  // every worker takes the next device until none is left, so a slow device does not hold up the others
+  std::atomic<std::size_t> nextDevice(0u);
+  auto                     worker = [&]() {
+    for (std::size_t i = nextDevice++; i < devices.size(); i = nextDevice++)
+    {
+      bringUp(devices[i], startTime, reports[i]);
+    }
+  };
+
+  const std::size_t        numWorkers = std::min(std::max<std::size_t>(m_options.maxWorkers, 1u), devices.size());
+  std::vector<std::thread> workers;
+  workers.reserve(numWorkers);
+  for (std::size_t i = 0u; i < numWorkers; ++i)
+  {
+    workers.push_back(std::thread(worker));
+  }
+  for (std::thread& thread : workers)
+  {
+    thread.join();
+  }
+  return reports;
+}
+
+const char* FleetBringUp::getPhaseName(Phase phase)
+{
+  switch (phase)
+  {
+    case Phase::OPEN_CONTROL:
+      return "open control";
+    case Phase::STOP:
+      return "stop";
+    case Phase::IDENT:
+      return "ident";
+    case Phase::LOGIN:
+      return "login";
+    case Phase::CONFIGURE:
+      return "configure";
+    case Phase::LOGOUT:
+      return "logout";
+    case Phase::OPEN_STREAM:
+      return "open stream";
+  }
+  return "unknown";
+}
+
+void FleetBringUp::bringUp(const Device& device, Clock::time_point startTime, DeviceReport& report) const
+{
+  report.hostname = device.hostname;
+
+  std::shared_ptr<VisionaryControl> pControl = std::make_shared<VisionaryControl>();
+
+  // runs one phase, records its duration and the failure
+  auto runPhase = [&report](Phase phase, const std::function<bool()>& step) {
+    const Clock::time_point phaseStart = Clock::now();
+    const bool              ok         = step();
+    report.phaseTimes[static_cast<std::size_t>(phase)] =
+      std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - phaseStart);
+    if (!ok)
+    {
+      report.failedPhase = phase;
+    }
+    return ok;
+  };
+
+  const bool withLogin = !m_options.password.empty();
+  const bool success =
+    runPhase(Phase::OPEN_CONTROL,
+             [&]() { return pControl->open(device.protocol, device.hostname, m_options.timeoutMs); })
+    && runPhase(Phase::STOP, [&]() { return pControl->stopAcquisition(); })
+    && runPhase(Phase::IDENT,
+                [&]() {
+                  report.deviceIdent = pControl->getDeviceIdent();
+                  return !report.deviceIdent.empty();
+                })
+    && (!withLogin
+        || runPhase(Phase::LOGIN, [&]() { return pControl->login(m_options.userLevel, m_options.password); }))
+    && (!m_options.configure
+        || runPhase(Phase::CONFIGURE, [&]() { return m_options.configure(*pControl, device.hostname); }))
+    && (!withLogin || runPhase(Phase::LOGOUT, [&]() { return pControl->logout(); }))
+    && (!m_options.openStream
+        || runPhase(Phase::OPEN_STREAM, [&]() { return m_options.openStream(device.hostname); }));
+
+  report.success = success;
+  if (success && m_options.keepControlOpen)
+  {
+    report.pControl = pControl;
+  }
+  else
+  {
+    pControl->close();
+  }
+  report.completionTime = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - startTime);
+}
+
+} // namespace visionary
@@ -0,0 +1,123 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "IAuthentication.h"
+#include "VisionaryControl.h"
+
+namespace visionary {
+
+/// Brings up many devices concurrently
+///
+/// Runs the start-up sequence of the samples (open control connection, stop acquisition, read the device ident,
+/// login, configure, logout, open the data stream) for every device, on a bounded pool of worker threads. With
+/// enough workers the whole fleet is ready after roughly the time of the slowest device instead of the sum of all.
+///
+/// Each device gets its own VisionaryControl, so the workers share no connection. Timings and the failing phase are
+/// reported per device.
+class FleetBringUp
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  /// Phases of the start-up sequence, in execution order
+  enum class Phase
+  {
+    OPEN_CONTROL = 0,
+    STOP         = 1,
+    IDENT        = 2,
+    LOGIN        = 3,
+    CONFIGURE    = 4,
+    LOGOUT       = 5,
+    OPEN_STREAM  = 6
+  };
+
+  static const std::size_t kNumPhases = 7u;
+
+  /// Device specific configuration, called between login and logout
+  ///
+  /// \return false to report the device as failed in phase CONFIGURE
+  typedef std::function<bool(VisionaryControl& control, const std::string& hostname)> ConfigureStep;
+
+  /// Opens the data stream (e.g. VisionaryDataStream::open()); the callback keeps the stream
+  ///
+  /// \return false to report the device as failed in phase OPEN_STREAM
+  typedef std::function<bool(const std::string& hostname)> OpenStreamStep;
+
+  struct Device
+  {
+    std::string                    hostname;
+    VisionaryControl::ProtocolType protocol;
+  };
+
+  struct Options
+  {
+    /// Number of devices brought up at the same time
+    std::size_t maxWorkers = 8u;
+
+    /// Timeout of the control connection
+    std::uint32_t timeoutMs = 5000u;
+
+    /// Login before configure; phases LOGIN and LOGOUT are skipped if the password is empty
+    IAuthentication::UserLevel userLevel = IAuthentication::UserLevel::AUTHORIZED_CLIENT;
+    std::string                password;
+
+    /// Optional, phase is skipped if not set
+    ConfigureStep  configure;
+    OpenStreamStep openStream;
+
+    /// Keep the control connection of successful devices open and hand it out in the report
+    bool keepControlOpen = true;
+  };
+
+  struct DeviceReport
+  {
+    std::string hostname;
+    bool        success = false;
+
+    /// Phase which failed (only valid if success is false)
+    Phase failedPhase = Phase::OPEN_CONTROL;
+
+    std::string deviceIdent;
+
+    /// Duration of each phase, zero for skipped phases and the phases after a failure
+    std::array<std::chrono::microseconds, kNumPhases> phaseTimes;
+
+    /// Time from the start of the bring-up until the device was done (includes waiting for a worker)
+    std::chrono::microseconds completionTime{0};
+
+    /// Open control connection if success and Options::keepControlOpen are set
+    std::shared_ptr<VisionaryControl> pControl;
+
+    DeviceReport();
+  };
+
+  explicit FleetBringUp(Options options);
+
+  /// Brings up all devices, returns when all are done
+  ///
+  /// \return one report per device, in the order of devices
+  std::vector<DeviceReport> run(const std::vector<Device>& devices) const;
+
+  /// Name of a phase, e.g. for reports
+  static const char* getPhaseName(Phase phase);
+
+private:
+  void bringUp(const Device& device, Clock::time_point startTime, DeviceReport& report) const;
+
+  Options m_options;
+};
+
+} // namespace visionary
@@ -0,0 +1,174 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "FrameGrabber.h"
+
+namespace visionary {
+
+/// Recycled data handlers for consumers which keep frames, e.g. to hand them to a worker thread
+///
+/// FrameGrabber::getNextFrame() swaps the caller's handler with the one holding the new frame and parses the
+/// following frame into the handler it got. If the caller passes no handler, or one which is still referenced
+/// elsewhere, the grabber allocates a fresh handler, and with it all its map vectors, for every frame.
+/// getNextFrame() of the pool passes a recycled handler instead. The handlers are owned by shared pointers whose
+/// deleter puts them back on the free list of the pool when the last reference is dropped, so their maps keep
+/// their capacity and sustained streaming runs with a constant set of handlers.
+///
+/// Handlers may be released from any thread. They can outlive the pool; they are deleted then.
+///
+/// \tparam TDataType data handler of the device, e.g. VisionaryTMiniData
+template <class TDataType>
+class FramePool
+{
+public:
+  struct Statistics
+  {
+    std::uint64_t allocations; ///< handlers created
+    std::uint64_t reuses;      ///< handlers taken from the free list
+    std::size_t   inUse;       ///< handlers currently handed out (including the one in the frame grabber)
+    std::size_t   maxInUse;    ///< high-water mark of inUse
+    std::size_t   free;        ///< handlers on the free list
+    std::size_t   maxFree;     ///< high-water mark of free
+  };
+
+  /// \param[in] maxFreeFrames handlers kept on the free list; handlers released beyond that are deleted
+  explicit FramePool(std::size_t maxFreeFrames = 4u) : m_pState(std::make_shared<State>(maxFreeFrames))
+  {
+  }
+
+  FramePool(const FramePool&)            = delete;
+  FramePool& operator=(const FramePool&) = delete;
+
+  /// Takes a handler from the free list or creates one
+  ///
+  /// \return handler which returns to the pool when the last reference is dropped; it contains the data of the
+  ///         frame it was last used for
+  std::shared_ptr<TDataType> acquire()
+  {
+    TDataType* pFrame = m_pState->take();
+    if (pFrame == nullptr)
+    {
+      pFrame = new TDataType();
+    }
+    const std::weak_ptr<State> pState(m_pState);
+    return std::shared_ptr<TDataType>(pFrame, [pState](TDataType* pReleased) {
+      const std::shared_ptr<State> pOwner = pState.lock();
+      if (!pOwner || !pOwner->give(pReleased))
+      {
+        delete pReleased;
+      }
+    });
+  }
+
+  /// Waits for the next frame, parsing the following frame into a pooled handler
+  ///
+  /// pFrame is only replaced by a pooled handler if the caller doesn't hold its only reference; a handler used by
+  /// the caller alone is swapped back into the grabber as before.
+  ///
+  /// \param[in]     frameGrabber frame grabber connected to the data stream of the device
+  /// \param[in,out] pFrame       handler of the previous frame, receives the new frame
+  /// \param[in]     timeoutMs    maximum time to wait
+  ///
+  /// \retval true  a frame was received
+  /// \retval false no new frame within timeoutMs
+  bool getNextFrame(FrameGrabber<TDataType>&    frameGrabber,
+                    std::shared_ptr<TDataType>& pFrame,
+                    std::uint32_t               timeoutMs = 1000u)
+  {
+    if (!pFrame || (pFrame.use_count() > 1))
+    {
+      pFrame = acquire();
+    }
+    return frameGrabber.getNextFrame(pFrame, timeoutMs);
+  }
+
+  Statistics getStatistics() const
+  {
+    return m_pState->getStatistics();
+  }
+
+private:
+  // shared with the deleters, so handlers released after the pool is gone don't touch a destroyed free list
+  class State
+  {
+  public:
+    explicit State(std::size_t maxFreeFrames) : m_maxFreeFrames(maxFreeFrames), m_statistics()
+    {
+      m_freeFrames.reserve(maxFreeFrames);
+    }
+
+    ~State()
+    {
+      for (TDataType* pFrame : m_freeFrames)
+      {
+        delete pFrame;
+      }
+    }
+
+    State(const State&)            = delete;
+    State& operator=(const State&) = delete;
+
+    // counts the handler as in use; nullptr if the free list is empty (the caller creates one)
+    TDataType* take()
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      TDataType*                  pFrame = nullptr;
+      if (m_freeFrames.empty())
+      {
+        ++m_statistics.allocations;
+      }
+      else
+      {
+        pFrame = m_freeFrames.back();
+        m_freeFrames.pop_back();
+        ++m_statistics.reuses;
+      }
+      m_statistics.free = m_freeFrames.size();
+      ++m_statistics.inUse;
+      m_statistics.maxInUse = std::max(m_statistics.maxInUse, m_statistics.inUse);
+      return pFrame;
+    }
+
+    // false if the free list is full (the caller deletes the handler)
+    bool give(TDataType* pFrame)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      --m_statistics.inUse;
+      if (m_freeFrames.size() >= m_maxFreeFrames)
+      {
+        return false;
+      }
+      m_freeFrames.push_back(pFrame);
+      m_statistics.free    = m_freeFrames.size();
+      m_statistics.maxFree = std::max(m_statistics.maxFree, m_statistics.free);
+      return true;
+    }
+
+    Statistics getStatistics() const
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_statistics;
+    }
+
+  private:
+    mutable std::mutex      m_mutex;
+    std::vector<TDataType*> m_freeFrames;
+    const std::size_t       m_maxFreeFrames;
+    Statistics              m_statistics;
+  };
+
+  std::shared_ptr<State> m_pState;
+};
+
+} // namespace visionary
@@ -0,0 +1,219 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "FrameGrabber.h"
+#include "TracedDataStream.h"
+
+namespace visionary {
+
+/// Separates the frames taken before a stop or reconfiguration from the ones taken afterwards
+///
+/// When acquisition is stopped, frames the device took before can still be queued in the frame grabber or be on
+/// their way. Instead of sleeping a fixed time, flush() drops the queued frames and then waits only as long as the
+/// stream is still delivering: it returns as soon as no frame arrived for two frame intervals (measured from the
+/// device timestamps of consecutive frames, so no clock synchronization is needed). Even if nothing is queued,
+/// flush() waits for a frame still in transit: two frame intervals if the stream was followed before, otherwise the
+/// whole maxWaitMs. Only a frame arriving after that, with no frame number to compare against, can slip through.
+///
+/// getNextFrame() additionally skips frames which are not newer than the last one dropped or received. A frame
+/// number more than kMaxLateFrames behind is taken as a restarted frame counter (e.g. after a reboot) instead, so
+/// the stream is not blocked until the counter catches up. With enableTimestampCheck() frames with a timestamp
+/// before the flush are skipped as well; this requires the device clock to be synchronized with the host (NTP/PTP).
+///
+/// The frames are read from a FrameGrabber, a TracedDataStream or any other FrameSource.
+///
+/// \tparam TDataType data handler of the device, e.g. VisionaryTMiniData
+template <class TDataType>
+class FrameStreamSync
+{
+public:
+  /// Waits up to timeoutMs for the next frame of the stream
+  typedef std::function<bool(std::shared_ptr<TDataType>& pFrame, std::uint32_t timeoutMs)> FrameSource;
+
+  /// Frames at most this far behind the last dropped one are late frames, larger steps back a counter restart
+  static const std::uint32_t kMaxLateFrames = 16u;
+
+  /// \param[in] frameSource receives the frames of the device
+  explicit FrameStreamSync(FrameSource frameSource)
+    : m_frameSource(frameSource)
+    , m_flushed(false)
+    , m_hasFrameNum(false)
+    , m_lastFrameNum(0u)
+    , m_lastTimestampMs(0u)
+    , m_frameIntervalMs(0u)
+    , m_flushTimeMs(0u)
+    , m_checkTimestamp(false)
+    , m_maxClockOffsetMs(0u)
+    , m_discardedCount(0u)
+  {
+  }
+
+  /// \param[in] frameGrabber frame grabber connected to the data stream of the device
+  explicit FrameStreamSync(FrameGrabber<TDataType>& frameGrabber)
+    : FrameStreamSync([&frameGrabber](std::shared_ptr<TDataType>& pFrame, std::uint32_t timeoutMs) {
+      return frameGrabber.getNextFrame(pFrame, timeoutMs);
+    })
+  {
+  }
+
+  /// \param[in] dataStream open data stream with a data handler of type TDataType; the frames returned are its data
+  ///                       handler, valid until the next frame is received. A telegram cut by the short waits of
+  ///                       flush() is continued by the next call, see TracedDataStream::getNextFrame().
+  explicit FrameStreamSync(TracedDataStream& dataStream)
+    : FrameStreamSync([&dataStream](std::shared_ptr<TDataType>& pFrame, std::uint32_t timeoutMs) {
+      if (!dataStream.getNextFrame(timeoutMs))
+      {
+        return false;
+      }
+      pFrame = std::static_pointer_cast<TDataType>(dataStream.getDataHandler());
+      return true;
+    })
+  {
+  }
+
+  /// Also skips frames with a timestamp before the flush
+  ///
+  /// \param[in] maxClockOffsetMs tolerated offset between device and host clock
+  void enableTimestampCheck(std::uint32_t maxClockOffsetMs)
+  {
+    m_checkTimestamp   = true;
+    m_maxClockOffsetMs = maxClockOffsetMs;
+  }
+
+  /// Drops all frames taken before the call
+  ///
+  /// Call it after stopAcquisition() or the configuration change returned.
+  ///
+  /// \param[in] maxWaitMs upper limit for the whole flush; waited in full only while the frame interval is unknown
+  ///                      (at most one frame arrives and no frames were received before)
+  ///
+  /// \return number of frames dropped
+  std::size_t flush(std::uint32_t maxWaitMs = 100u)
+  {
+    typedef std::chrono::steady_clock Clock;
+    const Clock::time_point           deadline = Clock::now() + std::chrono::milliseconds(maxWaitMs);
+
+    m_flushTimeMs = static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count());
+
+    // queued frames are always dropped, only the waiting ends at the deadline
+    std::size_t                dropped = 0u;
+    std::shared_ptr<TDataType> pFrame;
+    while (m_frameSource(pFrame, getFlushWaitMs(deadline)))
+    {
+      remember(*pFrame);
+      ++dropped;
+    }
+    m_flushed = true;
+    m_discardedCount += dropped;
+    return dropped;
+  }
+
+  /// Waits for the next frame taken after the last flush()
+  ///
+  /// \param[out] pFrame    received frame
+  /// \param[in]  timeoutMs maximum time to wait
+  ///
+  /// \retval true  a frame was received
+  /// \retval false no new frame within timeoutMs
+  bool getNextFrame(std::shared_ptr<TDataType>& pFrame, std::uint32_t timeoutMs)
+  {
+    typedef std::chrono::steady_clock Clock;
+    const Clock::time_point           deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    for (;;)
+    {
+      const auto remainingMs = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+      if ((remainingMs < 0) || !m_frameSource(pFrame, static_cast<std::uint32_t>(remainingMs)))
+      {
+        return false;
+      }
+      if (!isStale(*pFrame))
+      {
+        remember(*pFrame);
+        return true;
+      }
+      ++m_discardedCount;
+    }
+  }
+
+  /// Number of frames dropped by flush() and getNextFrame()
+  std::size_t getDiscardedCount() const
+  {
+    return m_discardedCount;
+  }
+
+private:
+  /// Time to wait for the next frame while flushing: it is due within one interval, allow for one more before giving
+  /// up; the whole remaining time while the interval is unknown
+  std::uint32_t getFlushWaitMs(std::chrono::steady_clock::time_point deadline) const
+  {
+    const auto remainingMs =
+      std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+    const std::uint32_t waitMs = static_cast<std::uint32_t>(std::max<decltype(remainingMs)>(remainingMs, 0));
+    if (m_frameIntervalMs > 0u)
+    {
+      return static_cast<std::uint32_t>(std::min<std::uint64_t>(2u * m_frameIntervalMs, waitMs));
+    }
+    return waitMs;
+  }
+
+  /// Follows the frame numbers and the frame interval of the stream
+  void remember(const TDataType& frame)
+  {
+    const std::uint64_t timestampMs = frame.getTimestampMS();
+    if (m_hasFrameNum && (frame.getFrameNum() == m_lastFrameNum + 1u) && (timestampMs > m_lastTimestampMs))
+    {
+      m_frameIntervalMs = timestampMs - m_lastTimestampMs;
+    }
+    m_hasFrameNum     = true;
+    m_lastFrameNum    = frame.getFrameNum();
+    m_lastTimestampMs = timestampMs;
+  }
+
+  bool isStale(const TDataType& frame) const
+  {
+    if (!m_flushed)
+    {
+      return false;
+    }
+    if (m_hasFrameNum)
+    {
+      // frame numbers wrap around; a step back by more than kMaxLateFrames is a restarted counter, not a late frame
+      const std::uint32_t age = m_lastFrameNum - frame.getFrameNum();
+      if ((static_cast<std::int32_t>(age) >= 0) && (age <= kMaxLateFrames))
+      {
+        return true;
+      }
+    }
+    return m_checkTimestamp && (frame.getTimestampMS() + m_maxClockOffsetMs < m_flushTimeMs);
+  }
+
+  FrameSource   m_frameSource;
+  bool          m_flushed;
+  bool          m_hasFrameNum;
+  std::uint32_t m_lastFrameNum;
+  std::uint64_t m_lastTimestampMs;
+  std::uint64_t m_frameIntervalMs; // device clock, 0 while unknown
+  std::uint64_t m_flushTimeMs;
+  bool          m_checkTimestamp;
+  std::uint32_t m_maxClockOffsetMs;
+  std::size_t   m_discardedCount;
+};
+
+template <class TDataType>
+const std::uint32_t FrameStreamSync<TDataType>::kMaxLateFrames;
+
+} // namespace visionary
@@ -0,0 +1,200 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "FrameTrace.h"
+
+#include <cstdio>
+
+namespace visionary {
+
+namespace {
+
+std::size_t indexOf(FrameStage stage)
+{
+  return static_cast<std::size_t>(stage);
+}
+
+std::uint64_t toMicroseconds(std::chrono::steady_clock::duration duration)
+{
+  return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+}
+
+void appendLine(std::string& text, const char* name, const LatencyHistogram::Snapshot& latency)
+{
+  char line[256];
+  std::snprintf(line,
+                sizeof(line),
+                "%-24s %8llu %9llu %9llu %9llu %9llu %9llu %9.1f\n",
+                name,
+                static_cast<unsigned long long>(latency.count),
+                static_cast<unsigned long long>(latency.minUs),
+                static_cast<unsigned long long>(latency.percentile(50.)),
+                static_cast<unsigned long long>(latency.percentile(90.)),
+                static_cast<unsigned long long>(latency.percentile(99.)),
+                static_cast<unsigned long long>(latency.maxUs),
+                latency.mean());
+  text += line;
+}
+
+} // namespace
+
+const char* getFrameStageName(FrameStage stage)
+{
+  switch (stage)
+  {
+    case FrameStage::FIRST_BYTE:
+      return "first byte";
+    case FrameStage::BLOB_COMPLETE:
+      return "BLOB complete";
+    case FrameStage::DECODED:
+      return "decoded";
+    case FrameStage::POINT_CLOUD:
+      return "point cloud";
+    case FrameStage::PICKUP:
+      return "pickup";
+  }
+  return "?";
+}
+
+void FrameTrace::mark(FrameStage stage)
+{
+  stageTimes[indexOf(stage)] = Clock::now();
+  if (stage == FrameStage::FIRST_BYTE)
+  {
+    firstByteWallTime = std::chrono::system_clock::now();
+  }
+}
+
+bool FrameTrace::hasReached(FrameStage stage) const
+{
+  return stageTimes[indexOf(stage)] != Clock::time_point();
+}
+
+FrameTrace::Clock::time_point FrameTrace::getTime(FrameStage stage) const
+{
+  return stageTimes[indexOf(stage)];
+}
+
+std::chrono::microseconds FrameTrace::getDuration(FrameStage from, FrameStage to) const
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(getTime(to) - getTime(from));
+}
+
+std::chrono::microseconds FrameTrace::getTransferDelay() const
+{
+  const std::chrono::milliseconds deviceTime(static_cast<std::chrono::milliseconds::rep>(deviceTimestampMs));
+  return std::chrono::duration_cast<std::chrono::microseconds>(firstByteWallTime.time_since_epoch() - deviceTime);
+}
+
+void FrameTrace::clear()
+{
+  frameNumber       = 0u;
+  deviceTimestampMs = 0u;
+  stageTimes.fill(Clock::time_point());
+  firstByteWallTime = std::chrono::system_clock::time_point();
+}
+
+FrameLatencyReport::FrameLatencyReport() : m_clockOffsetCount(0u)
+{
+}
+
+void FrameLatencyReport::record(const FrameTrace& trace)
+{
+  if (!trace.hasReached(FrameStage::FIRST_BYTE))
+  {
+    return;
+  }
+
+  FrameStage previous = FrameStage::FIRST_BYTE;
+  for (std::size_t i = 1u; i < kNumFrameStages; ++i)
+  {
+    const FrameStage stage = static_cast<FrameStage>(i);
+    if (trace.hasReached(stage))
+    {
+      m_stages[i].record(toMicroseconds(trace.getTime(stage) - trace.getTime(previous)));
+      previous = stage;
+    }
+  }
+  if (previous != FrameStage::FIRST_BYTE)
+  {
+    m_total.record(toMicroseconds(trace.getTime(previous) - trace.getTime(FrameStage::FIRST_BYTE)));
+  }
+
+  const std::chrono::microseconds transferDelay = trace.getTransferDelay();
+  if (transferDelay.count() >= 0)
+  {
+    m_transfer.record(static_cast<std::uint64_t>(transferDelay.count()));
+  }
+  else
+  {
+    ++m_clockOffsetCount;
+  }
+}
+
+FrameLatencyReport::Snapshot FrameLatencyReport::snapshot() const
+{
+  Snapshot snapshot;
+  for (std::size_t i = 0u; i < kNumFrameStages; ++i)
+  {
+    snapshot.stages[i] = m_stages[i].snapshot();
+  }
+  snapshot.total            = m_total.snapshot();
+  snapshot.transfer         = m_transfer.snapshot();
+  snapshot.clockOffsetCount = m_clockOffsetCount;
+  return snapshot;
+}
+
+void FrameLatencyReport::reset()
+{
+  for (LatencyHistogram& histogram : m_stages)
+  {
+    histogram.reset();
+  }
+  m_total.reset();
+  m_transfer.reset();
+  m_clockOffsetCount = 0u;
+}
+
+std::string FrameLatencyReport::format(const Snapshot& snapshot)
+{
+  std::string text;
+  char        line[256];
+
+  std::snprintf(line,
+                sizeof(line),
+                "%-24s %8s %9s %9s %9s %9s %9s %9s\n",
+                "step [us]",
+                "count",
+                "min",
+                "p50",
+                "p90",
+                "p99",
+                "max",
+                "mean");
+  text += line;
+
+  appendLine(text, "device -> first byte", snapshot.transfer);
+  for (std::size_t i = 1u; i < kNumFrameStages; ++i)
+  {
+    if (snapshot.stages[i].count > 0u)
+    {
+      const std::string name = std::string("-> ") + getFrameStageName(static_cast<FrameStage>(i));
+      appendLine(text, name.c_str(), snapshot.stages[i]);
+    }
+  }
+  appendLine(text, "first byte -> last", snapshot.total);
+
+  if (snapshot.clockOffsetCount > 0u)
+  {
+    std::snprintf(line,
+                  sizeof(line),
+                  "%llu frames with a device timestamp ahead of the host clock (clocks not synchronized?)\n",
+                  static_cast<unsigned long long>(snapshot.clockOffsetCount));
+    text += line;
+  }
+  return text;
+}
+
+} // namespace visionary
@@ -0,0 +1,114 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "LatencyHistogram.h"
+
+namespace visionary {
+
+/// Stations of a frame in the acquisition pipeline, in the order they are passed
+enum class FrameStage
+{
+  FIRST_BYTE,    ///< first byte of the BLOB telegram read from the socket
+  BLOB_COMPLETE, ///< whole telegram received
+  DECODED,       ///< maps and meta data parsed into the data handler
+  POINT_CLOUD,   ///< point cloud generated (optional)
+  PICKUP         ///< frame taken over by the consumer
+};
+
+const std::size_t kNumFrameStages = 5u;
+
+/// Name of a stage as used in reports, e.g. "decoded"
+const char* getFrameStageName(FrameStage stage);
+
+/// Monotonic timestamps of one frame on its way through the acquisition pipeline
+///
+/// The stages are stamped with the steady clock. Only the first byte additionally gets a wall clock time, so that
+/// it can be related to the device timestamp of the frame (see getTransferDelay()). A trace is a plain value which
+/// can be passed along with the frame to the consumer thread.
+struct FrameTrace
+{
+  typedef std::chrono::steady_clock Clock;
+
+  std::uint32_t frameNumber       = 0u;
+  std::uint64_t deviceTimestampMs = 0u; ///< acquisition time reported by the device (getTimestampMS())
+
+  /// per stage, the default (epoch) value for stages not reached
+  std::array<Clock::time_point, kNumFrameStages> stageTimes;
+
+  /// wall clock time of FIRST_BYTE
+  std::chrono::system_clock::time_point firstByteWallTime;
+
+  /// Stamps a stage with the current time
+  void mark(FrameStage stage);
+
+  bool hasReached(FrameStage stage) const;
+
+  Clock::time_point getTime(FrameStage stage) const;
+
+  /// Time between two reached stages
+  std::chrono::microseconds getDuration(FrameStage from, FrameStage to) const;
+
+  /// Time from the acquisition on the device until the first byte arrived
+  ///
+  /// Covers the processing on the device and the network transfer. Only meaningful if the device clock is
+  /// synchronized with the host (NTP/PTP); with an offset the result can even be negative. The device timestamp
+  /// has millisecond resolution.
+  std::chrono::microseconds getTransferDelay() const;
+
+  /// Clears all stages for the next frame
+  void clear();
+};
+
+/// Aggregated frame traces: a latency histogram per pipeline step
+///
+/// Every stage reached by a trace is measured from the previous reached stage, so a pipeline which doesn't
+/// generate point clouds measures PICKUP from DECODED. Additionally the total time from the first byte to the last
+/// stage and the transfer delay from the device timestamp are recorded (the latter only while it is not negative,
+/// negative values are counted as clock offsets). record() may be called from any thread.
+class FrameLatencyReport
+{
+public:
+  struct Snapshot
+  {
+    /// per stage, the time from the previous reached stage (FIRST_BYTE stays empty)
+    std::array<LatencyHistogram::Snapshot, kNumFrameStages> stages;
+
+    LatencyHistogram::Snapshot total;    ///< first byte to the last reached stage
+    LatencyHistogram::Snapshot transfer; ///< device timestamp to first byte, see FrameTrace::getTransferDelay()
+    std::uint64_t              clockOffsetCount = 0u; ///< traces with a negative transfer delay
+  };
+
+  FrameLatencyReport();
+
+  FrameLatencyReport(const FrameLatencyReport&)            = delete;
+  FrameLatencyReport& operator=(const FrameLatencyReport&) = delete;
+
+  /// Adds a trace; traces without FIRST_BYTE are ignored
+  void record(const FrameTrace& trace);
+
+  Snapshot snapshot() const;
+
+  void reset();
+
+  /// Text table of a snapshot, one line per pipeline step, latencies in microseconds
+  static std::string format(const Snapshot& snapshot);
+
+private:
+  std::array<LatencyHistogram, kNumFrameStages> m_stages;
+  LatencyHistogram                              m_total;
+  LatencyHistogram                              m_transfer;
+  std::atomic<std::uint64_t>                    m_clockOffsetCount;
+};
+
+} // namespace visionary
@@ -0,0 +1,160 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace visionary {
+
+namespace {
+
+// values below 2^kLinearBits are counted exactly
+const unsigned kLinearBits = 6u;
+
+// every further power of two is split into 2^kSubBucketBits buckets
+const unsigned kSubBucketBits = 5u;
+
+const std::size_t kLinearBuckets = std::size_t(1u) << kLinearBits;
+const std::size_t kSubBuckets    = std::size_t(1u) << kSubBucketBits;
+
+unsigned highestBit(std::uint64_t value)
+{
+  unsigned bit = 0u;
+  while ((value >>= 1u) != 0u)
+  {
+    ++bit;
+  }
+  return bit;
+}
+
+} // namespace
+
+const std::size_t LatencyHistogram::kNumBuckets;
+
+std::uint64_t LatencyHistogram::Snapshot::percentile(double p) const
+{
+  if (count == 0u)
+  {
+    return 0u;
+  }
+  const double        clamped = std::min(std::max(p, 0.), 100.);
+  const std::uint64_t rank    = std::max<std::uint64_t>(
+    static_cast<std::uint64_t>(clamped / 100. * static_cast<double>(count) + 0.5), 1u);
+
+  std::uint64_t seen = 0u;
+  for (std::size_t i = 0u; i < counts.size(); ++i)
+  {
+    seen += counts[i];
+    if (seen >= rank)
+    {
+      return std::min(getBucketUpperBound(i), maxUs);
+    }
+  }
+  return maxUs;
+}
+
+double LatencyHistogram::Snapshot::mean() const
+{
+  return (count == 0u) ? 0. : static_cast<double>(sumUs) / static_cast<double>(count);
+}
+
+void LatencyHistogram::Snapshot::merge(const Snapshot& other)
+{
+  if (other.count == 0u)
+  {
+    return;
+  }
+  if (counts.size() < other.counts.size())
+  {
+    counts.resize(other.counts.size(), 0u);
+  }
+  for (std::size_t i = 0u; i < other.counts.size(); ++i)
+  {
+    counts[i] += other.counts[i];
+  }
+  minUs = (count == 0u) ? other.minUs : std::min(minUs, other.minUs);
+  maxUs = std::max(maxUs, other.maxUs);
+  count += other.count;
+  sumUs += other.sumUs;
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+  reset();
+}
+
+void LatencyHistogram::record(std::uint64_t valueUs)
+{
+  m_counts[getBucketIndex(valueUs)].fetch_add(1u, std::memory_order_relaxed);
+  m_count.fetch_add(1u, std::memory_order_relaxed);
+  m_sumUs.fetch_add(valueUs, std::memory_order_relaxed);
+
+  std::uint64_t current = m_minUs.load(std::memory_order_relaxed);
+  while ((valueUs < current) && !m_minUs.compare_exchange_weak(current, valueUs, std::memory_order_relaxed))
+  {
+  }
+  current = m_maxUs.load(std::memory_order_relaxed);
+  while ((valueUs > current) && !m_maxUs.compare_exchange_weak(current, valueUs, std::memory_order_relaxed))
+  {
+  }
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+{
+  // not atomic as a whole: samples recorded meanwhile may be missing in some of the fields
+  Snapshot snapshot;
+  snapshot.counts.resize(kNumBuckets);
+  for (std::size_t i = 0u; i < kNumBuckets; ++i)
+  {
+    snapshot.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+  }
+  snapshot.count = m_count.load(std::memory_order_relaxed);
+  snapshot.sumUs = m_sumUs.load(std::memory_order_relaxed);
+  snapshot.maxUs = m_maxUs.load(std::memory_order_relaxed);
+  snapshot.minUs = (snapshot.count == 0u) ? 0u : m_minUs.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+void LatencyHistogram::reset()
+{
+  for (std::atomic<std::uint64_t>& bucket : m_counts)
+  {
+    bucket.store(0u, std::memory_order_relaxed);
+  }
+  m_count.store(0u, std::memory_order_relaxed);
+  m_sumUs.store(0u, std::memory_order_relaxed);
+  m_minUs.store(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+  m_maxUs.store(0u, std::memory_order_relaxed);
+}
+
+std::size_t LatencyHistogram::getBucketIndex(std::uint64_t valueUs)
+{
+  if (valueUs < kLinearBuckets)
+  {
+    return static_cast<std::size_t>(valueUs);
+  }
+  const unsigned    bit      = highestBit(valueUs);
+  const unsigned    shift    = bit - kSubBucketBits;
+  const std::size_t subIndex = static_cast<std::size_t>(valueUs >> shift) - kSubBuckets;
+  const std::size_t index    = kLinearBuckets + (bit - kLinearBits) * kSubBuckets + subIndex;
+  return std::min(index, kNumBuckets - 1u);
+}
+
+std::uint64_t LatencyHistogram::getBucketUpperBound(std::size_t index)
+{
+  if (index < kLinearBuckets)
+  {
+    return index;
+  }
+  const std::size_t offset   = index - kLinearBuckets;
+  const unsigned    bit      = static_cast<unsigned>(offset / kSubBuckets) + kLinearBits;
+  const unsigned    shift    = bit - kSubBucketBits;
+  const std::size_t subIndex = offset % kSubBuckets;
+  return ((static_cast<std::uint64_t>(kSubBuckets + subIndex + 1u)) << shift) - 1u;
+}
+
+} // namespace visionary
@@ -0,0 +1,68 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace visionary {
+
+/// Histogram of latencies in microseconds
+///
+/// The buckets are log-linear like in HdrHistogram: values below 64 us are counted exactly, above that every power
+/// of two is split into 32 equally wide buckets, which keeps the relative error below about 3 % up to the maximum
+/// of 2^36 us (larger values are counted in the last bucket). The histogram has a fixed size and record() is a
+/// few relaxed atomic operations, so it can stay enabled in production and be fed from any thread.
+class LatencyHistogram
+{
+public:
+  /// Copy of the histogram at one point in time
+  struct Snapshot
+  {
+    std::vector<std::uint64_t> counts; ///< per bucket, see getBucketUpperBound()
+    std::uint64_t              count = 0u;
+    std::uint64_t              sumUs = 0u;
+    std::uint64_t              minUs = 0u;
+    std::uint64_t              maxUs = 0u;
+
+    /// Value below or equal to which p percent of the samples are (bucket upper bound, at most maxUs)
+    ///
+    /// \param[in] p percentile in [0, 100]
+    std::uint64_t percentile(double p) const;
+
+    double mean() const;
+
+    /// Adds the samples of another snapshot
+    void merge(const Snapshot& other);
+  };
+
+  static const std::size_t kNumBuckets = 1024u;
+
+  LatencyHistogram();
+
+  LatencyHistogram(const LatencyHistogram&)            = delete;
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+  void record(std::uint64_t valueUs);
+
+  Snapshot snapshot() const;
+
+  void reset();
+
+  static std::size_t   getBucketIndex(std::uint64_t valueUs);
+  static std::uint64_t getBucketUpperBound(std::size_t index);
+
+private:
+  std::atomic<std::uint64_t> m_counts[kNumBuckets];
+  std::atomic<std::uint64_t> m_count;
+  std::atomic<std::uint64_t> m_sumUs;
+  std::atomic<std::uint64_t> m_minUs;
+  std::atomic<std::uint64_t> m_maxUs;
+};
+
+} // namespace visionary
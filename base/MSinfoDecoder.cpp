@@ -0,0 +1,87 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "MSinfoDecoder.h"
+
+#include <vector>
+
+namespace visionary {
+
+namespace {
+
+// fixed part of ErrStructType: 2 x UDInt, 2 x ErrTimeType (UInt, 2 x UDInt), 2 x UInt, length of extInfo
+const std::size_t kFixedEntrySize = 4u + 4u + 2u * (2u + 4u + 4u) + 2u + 2u + 2u;
+
+// CoLa parameters are big endian
+inline std::uint16_t readU16(const std::uint8_t* p)
+{
+  return static_cast<std::uint16_t>((p[0] << 8u) | p[1]);
+}
+
+inline std::uint32_t readU32(const std::uint8_t* p)
+{
+  return (static_cast<std::uint32_t>(p[0]) << 24u) | (static_cast<std::uint32_t>(p[1]) << 16u)
+         | (static_cast<std::uint32_t>(p[2]) << 8u) | static_cast<std::uint32_t>(p[3]);
+}
+
+inline const std::uint8_t* readTime(const std::uint8_t* p, ErrTimeType& time)
+{
+  time.pwrOnCount = readU16(p);
+  time.opSecs     = readU32(p + 2u);
+  time.timeOccur  = readU32(p + 6u);
+  return p + 10u;
+}
+
+} // namespace
+
+const std::size_t MSinfo::kNumMessages;
+
+bool decodeMSinfo(CoLaCommand& response, MSinfo& msinfo)
+{
+  if (response.getError() != CoLaError::OK)
+  {
+    return false;
+  }
+  const std::vector<std::uint8_t>& buffer = response.getBuffer();
+  const std::size_t                offset = response.getParameterOffset();
+  if (offset > buffer.size())
+  {
+    return false;
+  }
+  return decodeMSinfo(buffer.data() + offset, buffer.size() - offset, msinfo);
+}
+
+bool decodeMSinfo(const std::uint8_t* pData, std::size_t size, MSinfo& msinfo)
+{
+  const std::uint8_t*       p    = pData;
+  const std::uint8_t* const pEnd = pData + size;
+
+  for (ErrStructType& message : msinfo.messages)
+  {
+    if (static_cast<std::size_t>(pEnd - p) < kFixedEntrySize)
+    {
+      return false;
+    }
+    message.errorId    = readU32(p);
+    message.errorState = readU32(p + 4u);
+    p                  = readTime(p + 8u, message.firstTime);
+    p                  = readTime(p, message.lastTime);
+    message.numberOccurrences = readU16(p);
+    message.errReserved       = readU16(p + 2u);
+
+    const std::size_t extInfoSize = readU16(p + 4u);
+    p += 6u;
+    if (static_cast<std::size_t>(pEnd - p) < extInfoSize)
+    {
+      return false;
+    }
+    message.extInfo.pData = reinterpret_cast<const char*>(p);
+    message.extInfo.size  = extInfoSize;
+    p += extInfoSize;
+  }
+  return true;
+}
+
+} // namespace visionary
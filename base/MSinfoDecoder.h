@@ -0,0 +1,81 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "CoLaCommand.h"
+
+namespace visionary {
+
+/// Non-owning reference to characters in a response buffer (std::string_view is not available in C++11)
+struct StringRef
+{
+  const char* pData;
+  std::size_t size;
+
+  bool empty() const
+  {
+    return size == 0u;
+  }
+
+  std::string str() const
+  {
+    return std::string(pData, size);
+  }
+};
+
+/// Occurrence time of a device message (ErrTimeType)
+struct ErrTimeType
+{
+  std::uint16_t pwrOnCount;
+  std::uint32_t opSecs;
+  std::uint32_t timeOccur;
+};
+
+/// One entry of the device message list (ErrStructType)
+struct ErrStructType
+{
+  std::uint32_t errorId; ///< 0 for unused entries
+  std::uint32_t errorState;
+  ErrTimeType   firstTime;
+  ErrTimeType   lastTime;
+  std::uint16_t numberOccurrences;
+  std::uint16_t errReserved;
+  StringRef     extInfo; ///< points into the decoded response
+};
+
+/// Device message list, the content of the variable "MSinfo"
+struct MSinfo
+{
+  static const std::size_t kNumMessages = 25u;
+
+  std::array<ErrStructType, kNumMessages> messages;
+};
+
+/// Decodes the response of READ_VARIABLE "MSinfo" in one pass
+///
+/// No memory is allocated: the numbers are copied into the fixed array and extInfo refers to the response buffer.
+/// The response must therefore outlive msinfo (and not be modified).
+///
+/// \param[in]  response response of the read command
+/// \param[out] msinfo   decoded messages
+///
+/// \retval true  all 25 messages were decoded
+/// \retval false the response is an error or too short
+bool decodeMSinfo(CoLaCommand& response, MSinfo& msinfo);
+
+/// Decodes the parameter data of a "MSinfo" response
+///
+/// \param[in]  pData  first parameter byte
+/// \param[in]  size   number of parameter bytes
+/// \param[out] msinfo decoded messages, extInfo refers to pData
+bool decodeMSinfo(const std::uint8_t* pData, std::size_t size, MSinfo& msinfo);
+
+} // namespace visionary
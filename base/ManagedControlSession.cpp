@@ -0,0 +1,362 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "ManagedControlSession.h"
+
+#include "CoLaParameterReader.h"
+#include "CoLaParameterWriter.h"
+
+namespace visionary {
+
+namespace {
+
+const std::uint32_t kDefaultKeepaliveIntervalMs = 2000u;
+
+// how often the keepalive thread looks at the interval while the keepalive is disabled
+const std::uint32_t kDisabledPollMs = 1000u;
+
+/// True for the errors of commands rejected for the current user level
+bool isAccessDenied(CoLaError::Enum error)
+{
+  return (error == CoLaError::SOPAS_ERROR_METHOD_IN_ACCESS_DENIED)
+         || (error == CoLaError::SOPAS_ERROR_VARIABLE_WRITE_ACCESS_DENIED);
+}
+
+std::int64_t nowUs()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch())
+    .count();
+}
+
+} // namespace
+
+ManagedControlSession::ManagedControlSession()
+  : m_protocol(VisionaryControl::ProtocolType::COLA_2)
+  , m_timeoutMs(5000u)
+  , m_port(0u)
+  , m_open(false)
+  , m_hasCredentials(false)
+  , m_loggedIn(false)
+  , m_userLevel(IAuthentication::UserLevel::RUN)
+  , m_keepaliveVariable("DeviceIdent")
+  , m_loginCount(0u)
+  , m_reconnectCount(0u)
+  , m_lastActivityUs(0)
+  , m_keepaliveIntervalMs(kDefaultKeepaliveIntervalMs)
+  , m_stop(true)
+{
+}
+
+ManagedControlSession::~ManagedControlSession()
+{
+  close();
+}
+
+bool ManagedControlSession::open(VisionaryControl::ProtocolType protocol,
+                                 const std::string&             hostname,
+                                 std::uint32_t                  timeoutMs,
+                                 std::uint16_t                  port)
+{
+  close();
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_protocol  = protocol;
+    m_hostname  = hostname;
+    m_timeoutMs = timeoutMs;
+    m_port      = port;
+
+    std::shared_ptr<SharedControlSession> pSession = std::make_shared<SharedControlSession>();
+    if (!pSession->open(protocol, hostname, timeoutMs, port))
+    {
+      return false;
+    }
+    m_pSession = pSession;
+    m_open     = true;
+  }
+
+  touch();
+  {
+    std::lock_guard<std::mutex> lock(m_stopMutex);
+    m_stop = false;
+  }
+  m_keepaliveThread = std::thread(&ManagedControlSession::keepaliveLoop, this);
+  return true;
+}
+
+void ManagedControlSession::close()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_stopMutex);
+    m_stop = true;
+  }
+  m_stopCv.notify_all();
+  if (m_keepaliveThread.joinable())
+  {
+    m_keepaliveThread.join();
+  }
+
+  std::shared_ptr<SharedControlSession> pSession;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    pSession.swap(m_pSession);
+    m_open           = false;
+    m_hasCredentials = false;
+    m_loggedIn       = false;
+    m_password.clear();
+  }
+  if (pSession)
+  {
+    pSession->close();
+  }
+}
+
+bool ManagedControlSession::isConnected() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_pSession && m_pSession->isConnected();
+}
+
+void ManagedControlSession::setKeepaliveInterval(std::uint32_t intervalMs)
+{
+  m_keepaliveIntervalMs = intervalMs;
+  m_stopCv.notify_all();
+}
+
+void ManagedControlSession::setKeepaliveVariable(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_keepaliveVariable = name;
+}
+
+bool ManagedControlSession::login(IAuthentication::UserLevel userLevel, const std::string& password)
+{
+  std::lock_guard<std::mutex> authLock(m_authMutex);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const bool sameCredentials = m_hasCredentials && (password == m_password)
+                                 && (static_cast<int>(userLevel) <= static_cast<int>(m_userLevel));
+    if (sameCredentials && m_loggedIn && m_pSession && m_pSession->isConnected())
+    {
+      return true;
+    }
+
+    m_hasCredentials = true;
+    m_userLevel      = userLevel;
+    m_password       = password;
+    m_loggedIn       = false;
+  }
+
+  const std::uint64_t                   reconnects = m_reconnectCount;
+  std::shared_ptr<SharedControlSession> pSession   = acquireSessionAuthLocked();
+  if (!pSession)
+  {
+    return false;
+  }
+  if (m_reconnectCount != reconnects)
+  {
+    // reconnecting has logged in already
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_loggedIn;
+  }
+  return authenticateAuthLocked(pSession);
+}
+
+bool ManagedControlSession::logout()
+{
+  std::shared_ptr<SharedControlSession> pSession;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_hasCredentials = false;
+    m_loggedIn       = false;
+    m_password.clear();
+    pSession = m_pSession;
+  }
+  if (!pSession || !pSession->isConnected())
+  {
+    return false;
+  }
+  touch();
+  CoLaCommand response = pSession->sendCommand(CoLaParameterWriter(CoLaCommandType::METHOD_INVOCATION, "Run").build());
+  return (response.getError() == CoLaError::OK) && CoLaParameterReader(response).readBool();
+}
+
+CoLaCommand ManagedControlSession::sendCommand(CoLaCommand command, Lane lane, std::uint32_t timeoutMs)
+{
+  std::shared_ptr<SharedControlSession> pSession = getConnectedSession();
+  if (!pSession)
+  {
+    std::lock_guard<std::mutex> authLock(m_authMutex);
+    pSession = acquireSessionAuthLocked();
+  }
+  if (!pSession)
+  {
+    return CoLaCommand::networkErrorCommand();
+  }
+
+  touch();
+  CoLaCommand response = pSession->sendCommand(command, lane, timeoutMs);
+  if (!isAccessDenied(response.getError()))
+  {
+    return response;
+  }
+
+  // the device ended the login, e.g. after its session timeout
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_hasCredentials || (pSession != m_pSession))
+    {
+      return response;
+    }
+    m_loggedIn = false;
+  }
+  {
+    std::lock_guard<std::mutex> authLock(m_authMutex);
+    if (!authenticateAuthLocked(pSession))
+    {
+      return response;
+    }
+  }
+  return pSession->sendCommand(command, lane, timeoutMs);
+}
+
+std::uint64_t ManagedControlSession::getLoginCount() const
+{
+  return m_loginCount;
+}
+
+std::uint64_t ManagedControlSession::getReconnectCount() const
+{
+  return m_reconnectCount;
+}
+
+std::shared_ptr<SharedControlSession> ManagedControlSession::getConnectedSession() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_open && m_pSession && m_pSession->isConnected())
+  {
+    return m_pSession;
+  }
+  return nullptr;
+}
+
+std::shared_ptr<SharedControlSession> ManagedControlSession::acquireSessionAuthLocked()
+{
+  VisionaryControl::ProtocolType protocol;
+  std::string                    hostname;
+  std::uint32_t                  timeoutMs;
+  std::uint16_t                  port;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_open)
+    {
+      return nullptr;
+    }
+    if (m_pSession && m_pSession->isConnected())
+    {
+      return m_pSession;
+    }
+    protocol  = m_protocol;
+    hostname  = m_hostname;
+    timeoutMs = m_timeoutMs;
+    port      = m_port;
+  }
+
+  std::shared_ptr<SharedControlSession> pSession = std::make_shared<SharedControlSession>();
+  if (!pSession->open(protocol, hostname, timeoutMs, port))
+  {
+    return nullptr;
+  }
+  std::shared_ptr<SharedControlSession> pOldSession;
+  bool                                  hasCredentials = false;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_open)
+    {
+      // closed while connecting
+      pOldSession.swap(pSession);
+    }
+    else
+    {
+      pOldSession.swap(m_pSession);
+      m_pSession     = pSession;
+      m_loggedIn     = false;
+      hasCredentials = m_hasCredentials;
+      ++m_reconnectCount;
+    }
+  }
+  if (pOldSession)
+  {
+    pOldSession->close();
+  }
+
+  if (pSession && hasCredentials)
+  {
+    authenticateAuthLocked(pSession);
+  }
+  return pSession;
+}
+
+bool ManagedControlSession::authenticateAuthLocked(const std::shared_ptr<SharedControlSession>& pSession)
+{
+  IAuthentication::UserLevel userLevel;
+  std::string                password;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    userLevel = m_userLevel;
+    password  = m_password;
+  }
+
+  ++m_loginCount;
+  const bool loggedIn = pSession->login(userLevel, password);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  // keep the state if the session was replaced or the credentials changed meanwhile (logout(), close())
+  if ((pSession == m_pSession) && m_hasCredentials && (userLevel == m_userLevel) && (password == m_password))
+  {
+    m_loggedIn = loggedIn;
+  }
+  return loggedIn;
+}
+
+void ManagedControlSession::keepaliveLoop()
+{
+  std::unique_lock<std::mutex> stopLock(m_stopMutex);
+  while (!m_stop)
+  {
+    const std::uint32_t intervalMs = m_keepaliveIntervalMs;
+    if (intervalMs == 0u)
+    {
+      m_stopCv.wait_for(stopLock, std::chrono::milliseconds(kDisabledPollMs));
+      continue;
+    }
+
+    const std::int64_t idleUs = nowUs() - m_lastActivityUs;
+    const std::int64_t waitUs = static_cast<std::int64_t>(intervalMs) * 1000 - idleUs;
+    if (waitUs > 0)
+    {
+      m_stopCv.wait_for(stopLock, std::chrono::microseconds(waitUs));
+      continue;
+    }
+
+    // idle for a whole interval, send the keepalive (this also reconnects a dropped session)
+    stopLock.unlock();
+    std::string variable;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      variable = m_keepaliveVariable;
+    }
+    sendCommand(CoLaParameterWriter(CoLaCommandType::READ_VARIABLE, variable.c_str()).build(), Lane::BACKGROUND);
+    touch();
+    stopLock.lock();
+  }
+}
+
+void ManagedControlSession::touch()
+{
+  m_lastActivityUs = nowUs();
+}
+
+} // namespace visionary
@@ -0,0 +1,136 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "CoLaCommand.h"
+#include "IAuthentication.h"
+#include "SharedControlSession.h"
+#include "VisionaryControl.h"
+
+namespace visionary {
+
+/// Control session which stays connected and logged in
+///
+/// Logging in before every configuration change and out again afterwards costs several round trips each time.
+/// This session keeps the connection alive with a lightweight read while it is idle and remembers the user level:
+/// login() only authenticates if the session is not logged in with at least this level yet.
+///
+/// If the connection was lost, the next command reconnects and logs in again with the cached credentials first. A
+/// command rejected with "access denied" (the device ended the login) is retried once after logging in again;
+/// commands lost with the connection are not repeated, since they may have been executed.
+///
+/// All methods may be called from any thread. Reconnects and logins are serialized, but the session state is not
+/// locked while they are on the wire: isConnected(), close() and commands on a connected session don't wait for them.
+class ManagedControlSession
+{
+public:
+  typedef SharedControlSession::Lane Lane;
+
+  ManagedControlSession();
+  ~ManagedControlSession();
+
+  ManagedControlSession(const ManagedControlSession&)            = delete;
+  ManagedControlSession& operator=(const ManagedControlSession&) = delete;
+
+  /// Opens the control connection and starts the keepalive thread
+  ///
+  /// \param[in] protocol  protocol type the device understands (CoLa B or CoLa 2)
+  /// \param[in] hostname  host name or IP address of the device
+  /// \param[in] timeoutMs connect timeout and default timeout of the commands
+  /// \param[in] port      control port; 0 selects the default port of the protocol
+  bool open(VisionaryControl::ProtocolType protocol,
+            const std::string&             hostname,
+            std::uint32_t                  timeoutMs = 5000u,
+            std::uint16_t                  port      = 0u);
+
+  /// Stops the keepalive thread and closes the connection; the cached login is dropped
+  void close();
+
+  /// True while the connection is alive
+  bool isConnected() const;
+
+  /// Idle time after which a keepalive is sent (default 2000 ms); 0 disables the keepalive
+  void setKeepaliveInterval(std::uint32_t intervalMs);
+
+  /// Variable read as keepalive (default "DeviceIdent")
+  void setKeepaliveVariable(const std::string& name);
+
+  /// Makes sure the session is logged in with at least userLevel
+  ///
+  /// Authenticates only if the session is not logged in yet, with a lower level or with another password. The
+  /// credentials are kept to log in again after the device dropped the session.
+  ///
+  /// \retval true  the session is logged in
+  /// \retval false wrong password or no response
+  bool login(IAuthentication::UserLevel userLevel, const std::string& password);
+
+  /// Logs out (SOPAS "Run") and forgets the cached credentials
+  bool logout();
+
+  /// Sends a command and waits for the response
+  ///
+  /// Reconnects and logs in again if the session was dropped.
+  ///
+  /// \return the response, or CoLaCommand::networkErrorCommand() if the device can not be reached
+  CoLaCommand sendCommand(CoLaCommand command, Lane lane = Lane::NORMAL, std::uint32_t timeoutMs = 0u);
+
+  /// Number of authentications sent to the device
+  std::uint64_t getLoginCount() const;
+
+  /// Number of times the connection was re-established
+  std::uint64_t getReconnectCount() const;
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  std::shared_ptr<SharedControlSession> getConnectedSession() const;
+  void                                  keepaliveLoop();
+  void                                  touch();
+
+  // called with m_authMutex held; they lock m_mutex only to read and update the state, not across round trips
+  std::shared_ptr<SharedControlSession> acquireSessionAuthLocked();
+  bool                                  authenticateAuthLocked(const std::shared_ptr<SharedControlSession>& pSession);
+
+  // connection parameters, set by open()
+  VisionaryControl::ProtocolType m_protocol;
+  std::string                    m_hostname;
+  std::uint32_t                  m_timeoutMs;
+  std::uint16_t                  m_port;
+
+  // serializes reconnects and logins
+  std::mutex m_authMutex;
+
+  // session and login state
+  mutable std::mutex                    m_mutex;
+  std::shared_ptr<SharedControlSession> m_pSession;
+  bool                                  m_open;
+  bool                                  m_hasCredentials;
+  bool                                  m_loggedIn;
+  IAuthentication::UserLevel            m_userLevel;
+  std::string                           m_password;
+  std::string                           m_keepaliveVariable;
+
+  std::atomic<std::uint64_t> m_loginCount;
+  std::atomic<std::uint64_t> m_reconnectCount;
+  std::atomic<std::int64_t>  m_lastActivityUs; // steady clock, time of the last command
+  std::atomic<std::uint32_t> m_keepaliveIntervalMs;
+
+  std::thread             m_keepaliveThread;
+  std::mutex              m_stopMutex;
+  std::condition_variable m_stopCv;
+  bool                    m_stop;
+};
+
+} // namespace visionary
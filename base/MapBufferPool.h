@@ -0,0 +1,115 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "MapView.h"
+
+namespace visionary {
+
+/// Recycled map buffers for consumers which keep maps beyond the next frame
+///
+/// take() moves a buffer out of the pool, fills it with the map and transfers its ownership to the caller. Handing
+/// the buffer back with recycle() after use lets the next take() reuse its memory, so a steady stream of frames
+/// gets along without heap allocations once the pool has warmed up. Buffers not handed back are simply freed by
+/// their owner. All methods may be called from any thread.
+template <typename T>
+class MapBufferPool
+{
+public:
+  /// \param[in] maxFreeBuffers buffers kept for reuse; buffers recycled beyond that are freed
+  explicit MapBufferPool(std::size_t maxFreeBuffers = 4u) : m_maxFreeBuffers(maxFreeBuffers), m_allocationCount(0u)
+  {
+  }
+
+  MapBufferPool(const MapBufferPool&)            = delete;
+  MapBufferPool& operator=(const MapBufferPool&) = delete;
+
+  /// Copies a map into a recycled buffer and moves the buffer out to the caller
+  ///
+  /// \param[in] view map of the current frame, e.g. getDistanceView(data)
+  ///
+  /// \return the map, row by row without gaps (width * height elements); empty if the view is empty
+  std::vector<T> take(const MapView<T>& view)
+  {
+    std::vector<T> buffer = acquire(view.size());
+    for (std::size_t y = 0u; y < view.height; ++y)
+    {
+      const T* pRow = view.row(y);
+      buffer.insert(buffer.end(), pRow, pRow + view.width);
+    }
+    return buffer;
+  }
+
+  /// Hands a buffer back for reuse; its contents are discarded
+  void recycle(std::vector<T>&& buffer)
+  {
+    if (buffer.capacity() == 0u)
+    {
+      return;
+    }
+    buffer.clear();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_freeBuffers.size() < m_maxFreeBuffers)
+    {
+      m_freeBuffers.push_back(std::move(buffer));
+    }
+  }
+
+  /// Buffers currently available for reuse
+  std::size_t getFreeCount() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_freeBuffers.size();
+  }
+
+  /// Times take() had to allocate because no recycled buffer was large enough
+  std::uint64_t getAllocationCount() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_allocationCount;
+  }
+
+private:
+  /// Empty buffer with at least the capacity; prefers the largest free buffer
+  std::vector<T> acquire(std::size_t capacity)
+  {
+    std::vector<T> buffer;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!m_freeBuffers.empty())
+      {
+        typename std::vector<std::vector<T>>::iterator itLargest =
+          std::max_element(m_freeBuffers.begin(),
+                           m_freeBuffers.end(),
+                           [](const std::vector<T>& lhs, const std::vector<T>& rhs) {
+                             return lhs.capacity() < rhs.capacity();
+                           });
+        buffer = std::move(*itLargest);
+        m_freeBuffers.erase(itLargest);
+      }
+      if (buffer.capacity() < capacity)
+      {
+        ++m_allocationCount;
+      }
+    }
+    buffer.reserve(capacity);
+    return buffer;
+  }
+
+  mutable std::mutex          m_mutex;
+  std::vector<std::vector<T>> m_freeBuffers;
+  const std::size_t           m_maxFreeBuffers;
+  std::uint64_t               m_allocationCount;
+};
+
+} // namespace visionary
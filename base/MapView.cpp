@@ -0,0 +1,52 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "MapView.h"
+
+namespace visionary {
+
+namespace {
+
+// takes the accessor as member function pointer so that an accessor returning a copy doesn't compile (the view
+// would point into a temporary)
+template <typename TData, typename T>
+MapView<T> makeView(const TData& data, const std::vector<T>& (TData::*getMap)() const)
+{
+  return makeMapView(data, (data.*getMap)());
+}
+
+} // namespace
+
+MapView<std::uint16_t> getDistanceView(const VisionaryTMiniData& data)
+{
+  return makeView(data, &VisionaryTMiniData::getDistanceMap);
+}
+
+MapView<std::uint16_t> getIntensityView(const VisionaryTMiniData& data)
+{
+  return makeView(data, &VisionaryTMiniData::getIntensityMap);
+}
+
+MapView<std::uint16_t> getStateView(const VisionaryTMiniData& data)
+{
+  return makeView(data, &VisionaryTMiniData::getStateMap);
+}
+
+MapView<std::uint16_t> getZView(const VisionarySData& data)
+{
+  return makeView(data, &VisionarySData::getZMap);
+}
+
+MapView<std::uint32_t> getRGBAView(const VisionarySData& data)
+{
+  return makeView(data, &VisionarySData::getRGBAMap);
+}
+
+MapView<std::uint16_t> getConfidenceView(const VisionarySData& data)
+{
+  return makeView(data, &VisionarySData::getConfidenceMap);
+}
+
+} // namespace visionary
@@ -0,0 +1,109 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "VisionarySData.h"
+#include "VisionaryTMiniData.h"
+
+namespace visionary {
+
+/// Rectangle of a map in pixels
+struct MapRoi
+{
+  std::size_t x;
+  std::size_t y;
+  std::size_t width;
+  std::size_t height;
+};
+
+/// Read-only view of a map of the current frame, without copying it
+///
+/// A view points into the data handler and is valid until the handler parses the next frame (or is destroyed).
+/// Use MapBufferPool::take() to keep a map beyond that.
+template <typename T>
+struct MapView
+{
+  const T*    pData  = nullptr;
+  std::size_t width  = 0u;
+  std::size_t height = 0u;
+  std::size_t stride = 0u; ///< elements from the start of one row to the start of the next
+
+  bool empty() const
+  {
+    return (pData == nullptr) || (width == 0u) || (height == 0u);
+  }
+
+  std::size_t size() const
+  {
+    return width * height;
+  }
+
+  const T* row(std::size_t y) const
+  {
+    return pData + y * stride;
+  }
+
+  const T& at(std::size_t x, std::size_t y) const
+  {
+    return pData[y * stride + x];
+  }
+
+  /// Whether the rows follow each other without gap, so the map can be processed as one array of size() elements
+  bool isContiguous() const
+  {
+    return stride == width;
+  }
+
+  /// View of a rectangle of the map, clipped to the map; empty if the rectangle lies outside
+  MapView crop(const MapRoi& roi) const
+  {
+    MapView view;
+    if (!empty() && (roi.x < width) && (roi.y < height))
+    {
+      view.pData  = row(roi.y) + roi.x;
+      view.width  = std::min(roi.width, width - roi.x);
+      view.height = std::min(roi.height, height - roi.y);
+      view.stride = stride;
+    }
+    return view;
+  }
+};
+
+/// View of a map vector of a data handler; empty if the vector doesn't match the frame size (e.g. map disabled)
+///
+/// map must be a member of data, not a copy returned by value.
+template <typename T>
+MapView<T> makeMapView(const VisionaryData& data, const std::vector<T>& map)
+{
+  MapView<T>        view;
+  const std::size_t width  = static_cast<std::size_t>(data.getWidth());
+  const std::size_t height = static_cast<std::size_t>(data.getHeight());
+  if ((width > 0u) && (map.size() == width * height))
+  {
+    view.pData  = map.data();
+    view.width  = width;
+    view.height = height;
+    view.stride = width;
+  }
+  return view;
+}
+
+// Views of the maps of the current frame, see MapView
+
+MapView<std::uint16_t> getDistanceView(const VisionaryTMiniData& data);
+MapView<std::uint16_t> getIntensityView(const VisionaryTMiniData& data);
+MapView<std::uint16_t> getStateView(const VisionaryTMiniData& data);
+
+MapView<std::uint16_t> getZView(const VisionarySData& data);
+MapView<std::uint32_t> getRGBAView(const VisionarySData& data);
+MapView<std::uint16_t> getConfidenceView(const VisionarySData& data);
+
+} // namespace visionary
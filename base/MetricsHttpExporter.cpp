@@ -0,0 +1,137 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "MetricsHttpExporter.h"
+
+#include <chrono>
+
+namespace visionary {
+
+namespace {
+
+const std::uint32_t kPollMs            = 100u;
+const std::uint32_t kRequestTimeoutMs  = 2000u; // to receive the request header
+const std::size_t   kMaxRequestSize    = 8192u;
+const char          kContentTypeText[] = "text/plain; version=0.0.4; charset=utf-8";
+
+bool sendText(TcpConnection& connection, const std::string& text)
+{
+  return connection.send(reinterpret_cast<const std::uint8_t*>(text.data()), text.size());
+}
+
+std::string makeResponse(const char* status, const std::string& body)
+{
+  return std::string("HTTP/1.0 ") + status + "\r\nContent-Type: " + kContentTypeText
+         + "\r\nContent-Length: " + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+}
+
+} // namespace
+
+MetricsHttpExporter::MetricsHttpExporter(const MetricsRegistry& registry)
+  : m_registry(registry), m_stop(true), m_requestCount(0u)
+{
+}
+
+MetricsHttpExporter::~MetricsHttpExporter()
+{
+  stop();
+}
+
+bool MetricsHttpExporter::start(std::uint16_t port, const std::string& address)
+{
+  stop();
+  if (!m_listener.listen(address, port))
+  {
+    return false;
+  }
+  m_stop   = false;
+  m_thread = std::thread(&MetricsHttpExporter::serveLoop, this);
+  return true;
+}
+
+void MetricsHttpExporter::stop()
+{
+  m_stop = true;
+  if (m_thread.joinable())
+  {
+    m_thread.join();
+  }
+  m_listener.close();
+}
+
+std::uint16_t MetricsHttpExporter::getPort() const
+{
+  return m_listener.getPort();
+}
+
+std::uint64_t MetricsHttpExporter::getRequestCount() const
+{
+  return m_requestCount;
+}
+
+void MetricsHttpExporter::serveLoop()
+{
+  while (!m_stop)
+  {
+    TcpConnection connection;
+    if (m_listener.accept(connection, kPollMs) > 0)
+    {
+      // scrapes are rare and short, so they are served one after the other on this thread
+      handleConnection(connection);
+      connection.close();
+    }
+  }
+}
+
+void MetricsHttpExporter::handleConnection(TcpConnection& connection)
+{
+  typedef std::chrono::steady_clock Clock;
+  const Clock::time_point           deadline = Clock::now() + std::chrono::milliseconds(kRequestTimeoutMs);
+
+  std::string  request;
+  std::uint8_t buffer[1024];
+  while (request.find("\r\n\r\n") == std::string::npos)
+  {
+    const auto remainingMs = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+    if ((remainingMs <= 0) || (request.size() > kMaxRequestSize))
+    {
+      return;
+    }
+    const int received = connection.recv(buffer, sizeof(buffer), static_cast<std::uint32_t>(remainingMs));
+    if (received < 0)
+    {
+      return;
+    }
+    request.append(buffer, buffer + received);
+  }
+
+  // request line: method, path (query ignored), version
+  const std::size_t methodEnd = request.find(' ');
+  const std::size_t pathEnd   = request.find_first_of(" ?", methodEnd + 1u);
+  const std::string method    = request.substr(0u, methodEnd);
+  const std::string path =
+    (methodEnd != std::string::npos) ? request.substr(methodEnd + 1u, pathEnd - methodEnd - 1u) : std::string();
+
+  if ((method != "GET") && (method != "HEAD"))
+  {
+    sendText(connection, makeResponse("405 Method Not Allowed", "only GET is supported\n"));
+  }
+  else if ((path != "/metrics") && (path != "/"))
+  {
+    sendText(connection, makeResponse("404 Not Found", "metrics are served on /metrics\n"));
+  }
+  else
+  {
+    std::string response = makeResponse("200 OK", m_registry.render());
+    if (method == "HEAD")
+    {
+      response.erase(response.find("\r\n\r\n") + 4u);
+    }
+    sendText(connection, response);
+    ++m_requestCount;
+  }
+}
+
+} // namespace visionary
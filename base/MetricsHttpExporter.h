@@ -0,0 +1,58 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "MetricsRegistry.h"
+#include "TcpConnection.h"
+
+namespace visionary {
+
+/// Minimal HTTP server which serves the metrics of a MetricsRegistry to a Prometheus scraper
+///
+/// A background thread answers "GET /metrics" (and "GET /") with MetricsRegistry::render(), one request per
+/// connection. It binds to the loopback interface by default; the metrics are not meant to be exposed to other
+/// hosts without a proxy in front.
+class MetricsHttpExporter
+{
+public:
+  /// \param[in] registry metrics to serve; must outlive the exporter
+  explicit MetricsHttpExporter(const MetricsRegistry& registry);
+  ~MetricsHttpExporter();
+
+  MetricsHttpExporter(const MetricsHttpExporter&)            = delete;
+  MetricsHttpExporter& operator=(const MetricsHttpExporter&) = delete;
+
+  /// Starts listening
+  ///
+  /// \param[in] port    local port; 0 lets the system choose a free port (see getPort())
+  /// \param[in] address local address
+  bool start(std::uint16_t port, const std::string& address = "127.0.0.1");
+
+  /// Stops the server thread
+  void stop();
+
+  std::uint16_t getPort() const;
+
+  /// Number of requests answered since start
+  std::uint64_t getRequestCount() const;
+
+private:
+  void serveLoop();
+  void handleConnection(TcpConnection& connection);
+
+  const MetricsRegistry&     m_registry;
+  TcpListener                m_listener;
+  std::thread                m_thread;
+  std::atomic<bool>          m_stop;
+  std::atomic<std::uint64_t> m_requestCount;
+};
+
+} // namespace visionary
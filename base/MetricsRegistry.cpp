@@ -0,0 +1,262 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "MetricsRegistry.h"
+
+#include <cstdio>
+
+namespace visionary {
+
+namespace {
+
+std::string formatDouble(double value)
+{
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.9g", value);
+  return text;
+}
+
+std::string sampleLine(const std::string& name, const std::string& labels, const std::string& value)
+{
+  return labels.empty() ? name + ' ' + value + '\n' : name + '{' + labels + "} " + value + '\n';
+}
+
+} // namespace
+
+MetricCounter::MetricCounter() : m_value(0u)
+{
+}
+
+void MetricCounter::add(std::uint64_t value)
+{
+  m_value.fetch_add(value, std::memory_order_relaxed);
+}
+
+std::uint64_t MetricCounter::get() const
+{
+  return m_value.load(std::memory_order_relaxed);
+}
+
+MetricGauge::MetricGauge() : m_value(0)
+{
+}
+
+void MetricGauge::set(std::int64_t value)
+{
+  m_value.store(value, std::memory_order_relaxed);
+}
+
+void MetricGauge::add(std::int64_t delta)
+{
+  m_value.fetch_add(delta, std::memory_order_relaxed);
+}
+
+std::int64_t MetricGauge::get() const
+{
+  return m_value.load(std::memory_order_relaxed);
+}
+
+// 100 us to 10 s in 1-2.5-5 steps
+const std::uint64_t MetricsWriter::kHistogramBoundsUs[] = {100u,
+                                                          250u,
+                                                          500u,
+                                                          1000u,
+                                                          2500u,
+                                                          5000u,
+                                                          10000u,
+                                                          25000u,
+                                                          50000u,
+                                                          100000u,
+                                                          250000u,
+                                                          500000u,
+                                                          1000000u,
+                                                          2500000u,
+                                                          5000000u,
+                                                          10000000u};
+const std::size_t MetricsWriter::kNumHistogramBounds =
+  sizeof(MetricsWriter::kHistogramBoundsUs) / sizeof(MetricsWriter::kHistogramBoundsUs[0]);
+
+void MetricsWriter::counter(const std::string& name,
+                            const std::string& help,
+                            const std::string& labels,
+                            std::uint64_t      value)
+{
+  getFamily(name, "counter", help).samples += sampleLine(name, labels, std::to_string(value));
+}
+
+void MetricsWriter::gauge(const std::string& name, const std::string& help, const std::string& labels, double value)
+{
+  getFamily(name, "gauge", help).samples += sampleLine(name, labels, formatDouble(value));
+}
+
+void MetricsWriter::histogram(const std::string&                name,
+                              const std::string&                help,
+                              const std::string&                labels,
+                              const LatencyHistogram::Snapshot& latency)
+{
+  // the internal buckets are much finer than the exported ones: each is counted in the first exported bucket which
+  // covers its upper bound (the relative error of the internal buckets stays below 3 %)
+  std::vector<std::uint64_t> counts(kNumHistogramBounds, 0u);
+  std::size_t                bound = 0u;
+  for (std::size_t i = 0u; (i < latency.counts.size()) && (bound < kNumHistogramBounds); ++i)
+  {
+    while ((bound < kNumHistogramBounds) && (LatencyHistogram::getBucketUpperBound(i) > kHistogramBoundsUs[bound]))
+    {
+      ++bound;
+    }
+    if (bound < kNumHistogramBounds)
+    {
+      counts[bound] += latency.counts[i];
+    }
+  }
+
+  Family&       family     = getFamily(name, "histogram", help);
+  std::uint64_t cumulative = 0u;
+  for (std::size_t i = 0u; i < kNumHistogramBounds; ++i)
+  {
+    cumulative += counts[i];
+    const std::string le = label("le", formatDouble(static_cast<double>(kHistogramBoundsUs[i]) * 1e-6));
+    family.samples += sampleLine(name + "_bucket", join(labels, le), std::to_string(cumulative));
+  }
+  family.samples += sampleLine(name + "_bucket", join(labels, label("le", "+Inf")), std::to_string(latency.count));
+  family.samples += sampleLine(name + "_sum", labels, formatDouble(static_cast<double>(latency.sumUs) * 1e-6));
+  family.samples += sampleLine(name + "_count", labels, std::to_string(latency.count));
+}
+
+std::string MetricsWriter::str() const
+{
+  std::string text;
+  for (const auto& entry : m_families)
+  {
+    text += "# HELP " + entry.first + ' ' + entry.second.help + '\n';
+    text += "# TYPE " + entry.first + ' ' + entry.second.type + '\n';
+    text += entry.second.samples;
+  }
+  return text;
+}
+
+std::string MetricsWriter::label(const std::string& name, const std::string& value)
+{
+  std::string text = name + "=\"";
+  for (const char c : value)
+  {
+    if (c == '\n')
+    {
+      text += "\\n";
+      continue;
+    }
+    if ((c == '\\') || (c == '"'))
+    {
+      text += '\\';
+    }
+    text += c;
+  }
+  return text + '"';
+}
+
+std::string MetricsWriter::join(const std::string& labels, const std::string& moreLabels)
+{
+  if (labels.empty() || moreLabels.empty())
+  {
+    return labels + moreLabels;
+  }
+  return labels + ',' + moreLabels;
+}
+
+MetricsWriter::Family& MetricsWriter::getFamily(const std::string& name, const char* type, const std::string& help)
+{
+  Family& family = m_families[name];
+  if (family.type.empty())
+  {
+    family.type = type;
+    family.help = help;
+  }
+  return family;
+}
+
+MetricsRegistry::MetricsRegistry() : m_nextCollectorId(0u)
+{
+}
+
+template <class TMetric>
+TMetric& MetricsRegistry::getOrCreate(std::vector<Entry<TMetric>>& entries,
+                                      const std::string&           name,
+                                      const std::string&           help,
+                                      const std::string&           labels)
+{
+  for (Entry<TMetric>& entry : entries)
+  {
+    if ((entry.name == name) && (entry.labels == labels))
+    {
+      return *entry.pMetric;
+    }
+  }
+  Entry<TMetric> entry;
+  entry.name    = name;
+  entry.help    = help;
+  entry.labels  = labels;
+  entry.pMetric = std::unique_ptr<TMetric>(new TMetric());
+  entries.push_back(std::move(entry));
+  return *entries.back().pMetric;
+}
+
+MetricCounter& MetricsRegistry::getCounter(const std::string& name, const std::string& help, const std::string& labels)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return getOrCreate(m_counters, name, help, labels);
+}
+
+MetricGauge& MetricsRegistry::getGauge(const std::string& name, const std::string& help, const std::string& labels)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return getOrCreate(m_gauges, name, help, labels);
+}
+
+LatencyHistogram& MetricsRegistry::getHistogram(const std::string& name,
+                                                const std::string& help,
+                                                const std::string& labels)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return getOrCreate(m_histograms, name, help, labels);
+}
+
+std::size_t MetricsRegistry::addCollector(Collector collector)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const std::size_t           id = m_nextCollectorId++;
+  m_collectors[id]               = std::move(collector);
+  return id;
+}
+
+void MetricsRegistry::removeCollector(std::size_t id)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_collectors.erase(id);
+}
+
+std::string MetricsRegistry::render() const
+{
+  MetricsWriter               writer;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const Entry<MetricCounter>& entry : m_counters)
+  {
+    writer.counter(entry.name, entry.help, entry.labels, entry.pMetric->get());
+  }
+  for (const Entry<MetricGauge>& entry : m_gauges)
+  {
+    writer.gauge(entry.name, entry.help, entry.labels, static_cast<double>(entry.pMetric->get()));
+  }
+  for (const Entry<LatencyHistogram>& entry : m_histograms)
+  {
+    writer.histogram(entry.name, entry.help, entry.labels, entry.pMetric->snapshot());
+  }
+  for (const auto& collector : m_collectors)
+  {
+    collector.second(writer);
+  }
+  return writer.str();
+}
+
+} // namespace visionary
@@ -0,0 +1,162 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "LatencyHistogram.h"
+
+namespace visionary {
+
+/// Monotonically increasing count, e.g. frames received
+class MetricCounter
+{
+public:
+  MetricCounter();
+
+  MetricCounter(const MetricCounter&)            = delete;
+  MetricCounter& operator=(const MetricCounter&) = delete;
+
+  void          add(std::uint64_t value = 1u);
+  std::uint64_t get() const;
+
+private:
+  std::atomic<std::uint64_t> m_value;
+};
+
+/// Value which can go up and down, e.g. a queue depth
+class MetricGauge
+{
+public:
+  MetricGauge();
+
+  MetricGauge(const MetricGauge&)            = delete;
+  MetricGauge& operator=(const MetricGauge&) = delete;
+
+  void         set(std::int64_t value);
+  void         add(std::int64_t delta);
+  std::int64_t get() const;
+
+private:
+  std::atomic<std::int64_t> m_value;
+};
+
+/// Writes metrics in the Prometheus text exposition format
+///
+/// All samples of a metric name are grouped under one HELP and TYPE line, no matter in which order they are
+/// written. Latency histograms are exported in seconds with the buckets of kHistogramBoundsUs.
+class MetricsWriter
+{
+public:
+  /// Upper bounds of the exported histogram buckets in microseconds (+Inf is added)
+  static const std::uint64_t kHistogramBoundsUs[];
+  static const std::size_t   kNumHistogramBounds;
+
+  /// \param[in] name   metric name, e.g. "visionary_frames_received_total"
+  /// \param[in] help   description
+  /// \param[in] labels label set without braces, e.g. label("device", "192.168.1.10"); may be empty
+  /// \param[in] value  current value
+  void counter(const std::string& name, const std::string& help, const std::string& labels, std::uint64_t value);
+  void gauge(const std::string& name, const std::string& help, const std::string& labels, double value);
+  void histogram(const std::string&                name,
+                 const std::string&                help,
+                 const std::string&                labels,
+                 const LatencyHistogram::Snapshot& latency);
+
+  /// The collected metrics as text
+  std::string str() const;
+
+  /// Label pair with the value escaped, e.g. device="192.168.1.10"
+  static std::string label(const std::string& name, const std::string& value);
+
+  /// Joins two label sets
+  static std::string join(const std::string& labels, const std::string& moreLabels);
+
+private:
+  struct Family
+  {
+    std::string type;
+    std::string help;
+    std::string samples;
+  };
+
+  Family& getFamily(const std::string& name, const char* type, const std::string& help);
+
+  std::map<std::string, Family> m_families;
+};
+
+/// Metrics of the acquisition and control helpers of one process
+///
+/// Counters, gauges and histograms are created once and then updated lock-free from any thread; the references
+/// stay valid until the registry is destroyed. Statistics kept elsewhere (e.g. CommandStatistics of a control
+/// session) are exported by collectors, which read them only when the metrics are rendered, see
+/// VisionaryMetrics.h. MetricsHttpExporter serves render() to a scraper.
+class MetricsRegistry
+{
+public:
+  typedef std::function<void(MetricsWriter& writer)> Collector;
+
+  MetricsRegistry();
+
+  MetricsRegistry(const MetricsRegistry&)            = delete;
+  MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+  /// Gets or creates a counter
+  ///
+  /// \param[in] name   metric name
+  /// \param[in] help   description, taken from the first call for a name
+  /// \param[in] labels label set, see MetricsWriter::label()
+  MetricCounter& getCounter(const std::string& name, const std::string& help, const std::string& labels = "");
+
+  /// Gets or creates a gauge
+  MetricGauge& getGauge(const std::string& name, const std::string& help, const std::string& labels = "");
+
+  /// Gets or creates a latency histogram (recorded in microseconds, exported in seconds)
+  LatencyHistogram& getHistogram(const std::string& name, const std::string& help, const std::string& labels = "");
+
+  /// Adds a collector called from render(); the objects it reads must stay alive until removeCollector()
+  ///
+  /// \return id for removeCollector()
+  std::size_t addCollector(Collector collector);
+
+  void removeCollector(std::size_t id);
+
+  /// All metrics in the Prometheus text exposition format
+  std::string render() const;
+
+private:
+  template <class TMetric>
+  struct Entry
+  {
+    std::string              name;
+    std::string              help;
+    std::string              labels;
+    std::unique_ptr<TMetric> pMetric;
+  };
+
+  template <class TMetric>
+  static TMetric& getOrCreate(std::vector<Entry<TMetric>>& entries,
+                              const std::string&           name,
+                              const std::string&           help,
+                              const std::string&           labels);
+
+  mutable std::mutex                   m_mutex;
+  std::vector<Entry<MetricCounter>>    m_counters;
+  std::vector<Entry<MetricGauge>>      m_gauges;
+  std::vector<Entry<LatencyHistogram>> m_histograms;
+  std::map<std::size_t, Collector>     m_collectors;
+  std::size_t                          m_nextCollectorId;
+};
+
+} // namespace visionary
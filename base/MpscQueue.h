@@ -0,0 +1,80 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+namespace visionary {
+
+/// Lock-free multi-producer single-consumer queue
+///
+/// push() may be called from any thread and never blocks (apart from the node allocation). pop() must only be
+/// called from one consumer thread at a time. Elements are taken out in the order the pushes completed.
+///
+/// \tparam T element type, must be default constructible and movable
+template <class T>
+class MpscQueue
+{
+public:
+  MpscQueue() : m_head(new Node), m_pTail(m_head.load())
+  {
+  }
+
+  ~MpscQueue()
+  {
+    T value;
+    while (pop(value))
+    {
+    }
+    delete m_pTail;
+  }
+
+  MpscQueue(const MpscQueue&)            = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  void push(T value)
+  {
+    Node* pNode  = new Node;
+    pNode->value = std::move(value);
+    // publish the node as new head first, then link it to its predecessor; the consumer stops at a missing link
+    Node* pPrev = m_head.exchange(pNode, std::memory_order_acq_rel);
+    pPrev->pNext.store(pNode, std::memory_order_release);
+  }
+
+  /// Takes the oldest element
+  ///
+  /// \retval true  value received an element
+  /// \retval false the queue is empty (or a push is just in progress)
+  bool pop(T& value)
+  {
+    Node* pNext = m_pTail->pNext.load(std::memory_order_acquire);
+    if (pNext == nullptr)
+    {
+      return false;
+    }
+    value = std::move(pNext->value);
+    delete m_pTail;
+    m_pTail = pNext; // the popped node becomes the new stub
+    return true;
+  }
+
+private:
+  struct Node
+  {
+    Node() : pNext(nullptr)
+    {
+    }
+
+    std::atomic<Node*> pNext;
+    T                  value;
+  };
+
+  std::atomic<Node*> m_head;  // last pushed node, shared by the producers
+  Node*              m_pTail; // stub node, owned by the consumer
+};
+
+} // namespace visionary
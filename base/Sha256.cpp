@@ -0,0 +1,120 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "Sha256.h"
+
+namespace visionary {
+
+namespace {
+
+const std::uint32_t kRoundConstants[64] = {
+  0x428a2f98u, 0x71374491u, 0xb5c0fbcfu, 0xe9b5dba5u, 0x3956c25bu, 0x59f111f1u, 0x923f82a4u, 0xab1c5ed5u,
+  0xd807aa98u, 0x12835b01u, 0x243185beu, 0x550c7dc3u, 0x72be5d74u, 0x80deb1feu, 0x9bdc06a7u, 0xc19bf174u,
+  0xe49b69c1u, 0xefbe4786u, 0x0fc19dc6u, 0x240ca1ccu, 0x2de92c6fu, 0x4a7484aau, 0x5cb0a9dcu, 0x76f988dau,
+  0x983e5152u, 0xa831c66du, 0xb00327c8u, 0xbf597fc7u, 0xc6e00bf3u, 0xd5a79147u, 0x06ca6351u, 0x14292967u,
+  0x27b70a85u, 0x2e1b2138u, 0x4d2c6dfcu, 0x53380d13u, 0x650a7354u, 0x766a0abbu, 0x81c2c92eu, 0x92722c85u,
+  0xa2bfe8a1u, 0xa81a664bu, 0xc24b8b70u, 0xc76c51a3u, 0xd192e819u, 0xd6990624u, 0xf40e3585u, 0x106aa070u,
+  0x19a4c116u, 0x1e376c08u, 0x2748774cu, 0x34b0bcb5u, 0x391c0cb3u, 0x4ed8aa4au, 0x5b9cca4fu, 0x682e6ff3u,
+  0x748f82eeu, 0x78a5636fu, 0x84c87814u, 0x8cc70208u, 0x90befffau, 0xa4506cebu, 0xbef9a3f7u, 0xc67178f2u};
+
+std::uint32_t rotr(std::uint32_t value, unsigned bits)
+{
+  return (value >> bits) | (value << (32u - bits));
+}
+
+std::uint32_t readBigEndian32(const std::uint8_t* pData)
+{
+  return (static_cast<std::uint32_t>(pData[0]) << 24u) | (static_cast<std::uint32_t>(pData[1]) << 16u)
+         | (static_cast<std::uint32_t>(pData[2]) << 8u) | static_cast<std::uint32_t>(pData[3]);
+}
+
+void processBlock(const std::uint8_t* pBlock, std::uint32_t state[8])
+{
+  std::uint32_t w[64];
+  for (unsigned i = 0u; i < 16u; ++i)
+  {
+    w[i] = readBigEndian32(pBlock + 4u * i);
+  }
+  for (unsigned i = 16u; i < 64u; ++i)
+  {
+    const std::uint32_t s0 = rotr(w[i - 15u], 7u) ^ rotr(w[i - 15u], 18u) ^ (w[i - 15u] >> 3u);
+    const std::uint32_t s1 = rotr(w[i - 2u], 17u) ^ rotr(w[i - 2u], 19u) ^ (w[i - 2u] >> 10u);
+    w[i]                   = w[i - 16u] + s0 + w[i - 7u] + s1;
+  }
+
+  std::uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+  std::uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+  for (unsigned i = 0u; i < 64u; ++i)
+  {
+    const std::uint32_t s1    = rotr(e, 6u) ^ rotr(e, 11u) ^ rotr(e, 25u);
+    const std::uint32_t ch    = (e & f) ^ (~e & g);
+    const std::uint32_t temp1 = h + s1 + ch + kRoundConstants[i] + w[i];
+    const std::uint32_t s0    = rotr(a, 2u) ^ rotr(a, 13u) ^ rotr(a, 22u);
+    const std::uint32_t maj   = (a & b) ^ (a & c) ^ (b & c);
+    const std::uint32_t temp2 = s0 + maj;
+    h                         = g;
+    g                         = f;
+    f                         = e;
+    e                         = d + temp1;
+    d                         = c;
+    c                         = b;
+    b                         = a;
+    a                         = temp1 + temp2;
+  }
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+  state[5] += f;
+  state[6] += g;
+  state[7] += h;
+}
+
+} // namespace
+
+Sha256Digest sha256(const std::uint8_t* pData, std::size_t size)
+{
+  std::uint32_t state[8] = {
+    0x6a09e667u, 0xbb67ae85u, 0x3c6ef372u, 0xa54ff53au, 0x510e527fu, 0x9b05688cu, 0x1f83d9abu, 0x5be0cd19u};
+
+  std::size_t offset = 0u;
+  for (; offset + 64u <= size; offset += 64u)
+  {
+    processBlock(pData + offset, state);
+  }
+
+  // padding: 0x80, zeros and the message length in bits (big endian) fill one or two last blocks
+  std::uint8_t      tail[128] = {};
+  const std::size_t rest      = size - offset;
+  for (std::size_t i = 0u; i < rest; ++i)
+  {
+    tail[i] = pData[offset + i];
+  }
+  tail[rest]                      = 0x80u;
+  const std::size_t   tailSize    = (rest < 56u) ? 64u : 128u;
+  const std::uint64_t messageBits = static_cast<std::uint64_t>(size) * 8u;
+  for (unsigned i = 0u; i < 8u; ++i)
+  {
+    tail[tailSize - 1u - i] = static_cast<std::uint8_t>(messageBits >> (8u * i));
+  }
+  processBlock(tail, state);
+  if (tailSize == 128u)
+  {
+    processBlock(tail + 64, state);
+  }
+
+  Sha256Digest digest;
+  for (unsigned i = 0u; i < 8u; ++i)
+  {
+    digest[4u * i]      = static_cast<std::uint8_t>(state[i] >> 24u);
+    digest[4u * i + 1u] = static_cast<std::uint8_t>(state[i] >> 16u);
+    digest[4u * i + 2u] = static_cast<std::uint8_t>(state[i] >> 8u);
+    digest[4u * i + 3u] = static_cast<std::uint8_t>(state[i]);
+  }
+  return digest;
+}
+
+} // namespace visionary
@@ -0,0 +1,25 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace visionary {
+
+typedef std::array<std::uint8_t, 32u> Sha256Digest;
+
+/// SHA-256 (FIPS 180-4) of a byte buffer, used by the challenge/response login of CoLa 2 devices
+Sha256Digest sha256(const std::uint8_t* pData, std::size_t size);
+
+inline Sha256Digest sha256(const std::vector<std::uint8_t>& data)
+{
+  return sha256(data.data(), data.size());
+}
+
+} // namespace visionary
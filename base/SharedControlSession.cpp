@@ -0,0 +1,263 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "SharedControlSession.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+#include "CoLaLogin.h"
+
+namespace visionary {
+
+namespace {
+
+// the I/O thread checks the stop flag and the command deadlines at least this often
+const std::uint32_t kIoPollMs = 100u;
+
+const std::size_t kDefaultMaxInFlight = 8u;
+
+} // namespace
+
+const std::size_t SharedControlSession::kNumLanes;
+
+std::shared_ptr<SharedControlSession> SharedControlSession::get(VisionaryControl::ProtocolType protocol,
+                                                                const std::string&             hostname,
+                                                                std::uint32_t                  timeoutMs,
+                                                                std::uint16_t                  port)
+{
+  static std::mutex                                                 registryMutex;
+  static std::map<std::string, std::weak_ptr<SharedControlSession>> registry;
+
+  const std::string key = hostname + ':' + std::to_string(static_cast<unsigned>(port)) + '/'
+                          + std::to_string(static_cast<int>(protocol));
+
+  std::lock_guard<std::mutex>           lock(registryMutex);
+  std::shared_ptr<SharedControlSession> pSession = registry[key].lock();
+  if (pSession && pSession->isConnected())
+  {
+    return pSession;
+  }
+
+  pSession = std::make_shared<SharedControlSession>();
+  if (!pSession->open(protocol, hostname, timeoutMs, port))
+  {
+    registry.erase(key);
+    return nullptr;
+  }
+  registry[key] = pSession;
+  return pSession;
+}
+
+SharedControlSession::SharedControlSession()
+  : m_stop(true), m_connected(false), m_timeoutMs(5000u), m_submitting(0u), m_maxInFlight(kDefaultMaxInFlight)
+{
+  m_connection.setStatistics(&m_statistics);
+  m_tracker.setStatistics(&m_statistics);
+}
+
+SharedControlSession::~SharedControlSession()
+{
+  close();
+  m_wakeup.close();
+}
+
+bool SharedControlSession::open(VisionaryControl::ProtocolType protocol,
+                                const std::string&             hostname,
+                                std::uint32_t                  timeoutMs,
+                                std::uint16_t                  port)
+{
+  close();
+
+  if ((!m_wakeup.isOpen() && !m_wakeup.open()) || !m_connection.open(protocol, hostname, timeoutMs, port))
+  {
+    return false;
+  }
+
+  m_tracker.reset(protocol, timeoutMs);
+  m_timeoutMs = timeoutMs;
+  m_stop      = false;
+  m_connected = true;
+  m_ioThread  = std::thread(&SharedControlSession::ioLoop, this);
+  return true;
+}
+
+void SharedControlSession::close()
+{
+  m_stop      = true;
+  m_connected = false;
+  if (m_ioThread.joinable())
+  {
+    m_wakeup.signal();
+    m_ioThread.join();
+  }
+  // the I/O thread is gone, this thread is the consumer of the lanes now
+  failAll();
+  m_connection.close();
+  // m_wakeup stays open until destruction: a producer racing with close() may still signal it
+}
+
+bool SharedControlSession::isConnected() const
+{
+  return m_connected;
+}
+
+bool SharedControlSession::login(IAuthentication::UserLevel userLevel, const std::string& password)
+{
+  return loginCoLa(
+    m_connection.getProtocol(), userLevel, password, [this](CoLaCommand command) { return sendCommand(command); });
+}
+
+void SharedControlSession::setMaxInFlight(std::size_t maxInFlight)
+{
+  m_maxInFlight = std::max<std::size_t>(maxInFlight, 2u);
+}
+
+void SharedControlSession::sendCommandAsync(CoLaCommand      command,
+                                            Lane             lane,
+                                            ResponseCallback callback,
+                                            std::uint32_t    timeoutMs)
+{
+  ++m_submitting;
+  if (!m_connected)
+  {
+    --m_submitting;
+    CoLaCommand response = CoLaCommand::networkErrorCommand();
+    callback(response);
+    return;
+  }
+
+  // the request id is assigned by the I/O thread when the command is sent
+  CoLaRequestTracker::Request request;
+  request.payload  = command.getBuffer();
+  request.deadline = Clock::now() + std::chrono::milliseconds((timeoutMs != 0u) ? timeoutMs : m_timeoutMs);
+  request.callback = callback;
+  m_lanes[static_cast<std::size_t>(lane)].push(std::move(request));
+  m_wakeup.signal();
+  --m_submitting;
+}
+
+std::future<CoLaCommand> SharedControlSession::sendCommandAsync(CoLaCommand command, Lane lane, std::uint32_t timeoutMs)
+{
+  std::shared_ptr<std::promise<CoLaCommand>> pPromise = std::make_shared<std::promise<CoLaCommand>>();
+  std::future<CoLaCommand>                   future   = pPromise->get_future();
+  sendCommandAsync(
+    command, lane, [pPromise](CoLaCommand& response) { pPromise->set_value(response); }, timeoutMs);
+  return future;
+}
+
+CoLaCommand SharedControlSession::sendCommand(CoLaCommand command, Lane lane, std::uint32_t timeoutMs)
+{
+  return sendCommandAsync(command, lane, timeoutMs).get();
+}
+
+void SharedControlSession::ioLoop()
+{
+  CoLaRequestTracker::Completions completions;
+
+  while (!m_stop)
+  {
+    // reset before looking at the lanes, so a submission after this point wakes up the receive below
+    m_wakeup.reset();
+    collectSubmissions();
+
+    const Clock::time_point now = Clock::now();
+    m_tracker.expire(now, completions);
+    for (auto& pending : m_pending)
+    {
+      CoLaRequestTracker::expireQueue(pending, now, completions);
+    }
+    const bool sendOk = sendPending();
+    CoLaRequestTracker::complete(completions);
+    if (!sendOk)
+    {
+      break;
+    }
+
+    Clock::time_point wakeup = m_tracker.nextDeadline(now + std::chrono::milliseconds(kIoPollMs));
+    for (const auto& pending : m_pending)
+    {
+      wakeup = CoLaRequestTracker::nextDeadline(pending, wakeup);
+    }
+    const auto waitMs = std::chrono::duration_cast<std::chrono::milliseconds>(wakeup - Clock::now()).count();
+
+    CoLaFrame frame;
+    const int ret =
+      m_connection.receive(frame, static_cast<std::uint32_t>(std::max<decltype(waitMs)>(waitMs, 1)), &m_wakeup);
+    if (ret < 0)
+    {
+      break;
+    }
+    if (ret > 0)
+    {
+      m_tracker.handleResponse(frame, completions);
+      CoLaRequestTracker::complete(completions);
+    }
+  }
+
+  m_connected = false;
+  failAll();
+}
+
+void SharedControlSession::collectSubmissions()
+{
+  for (std::size_t lane = 0u; lane < kNumLanes; ++lane)
+  {
+    CoLaRequestTracker::Request request;
+    while (m_lanes[lane].pop(request))
+    {
+      m_pending[lane].push_back(std::move(request));
+    }
+  }
+}
+
+bool SharedControlSession::sendPending()
+{
+  const std::size_t maxInFlight = m_maxInFlight;
+  for (std::size_t lane = 0u; lane < kNumLanes; ++lane)
+  {
+    // The device answers in order, so every command in flight delays a trigger command. NORMAL leaves one slot
+    // free for TRIGGER, BACKGROUND is only sent while nothing else is in flight.
+    const std::size_t laneLimit = (lane == 0u) ? maxInFlight : ((lane == 1u) ? maxInFlight - 1u : 1u);
+    while (!m_pending[lane].empty() && m_tracker.canSend(laneLimit))
+    {
+      CoLaRequestTracker::Request& request = m_pending[lane].front();
+      request.requestId                    = m_tracker.nextRequestId();
+      if (!m_connection.send(request.payload, request.requestId))
+      {
+        return false;
+      }
+      m_tracker.addInFlight(std::move(request));
+      m_pending[lane].pop_front();
+    }
+  }
+  return true;
+}
+
+void SharedControlSession::failAll()
+{
+  // wait for producers which passed the connected check before it was cleared
+  while (m_submitting != 0u)
+  {
+    std::this_thread::yield();
+  }
+
+  CoLaRequestTracker::Completions completions;
+  collectSubmissions();
+  for (auto& pending : m_pending)
+  {
+    CoLaRequestTracker::failQueue(pending, completions);
+  }
+  m_tracker.failAll(completions);
+  CoLaRequestTracker::complete(completions);
+}
+
+CommandStatistics& SharedControlSession::getStatistics()
+{
+  return m_statistics;
+}
+
+} // namespace visionary
@@ -0,0 +1,145 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "CoLaCommand.h"
+#include "CoLaConnection.h"
+#include "CoLaRequestTracker.h"
+#include "CommandStatistics.h"
+#include "IAuthentication.h"
+#include "MpscQueue.h"
+#include "TcpConnection.h"
+#include "VisionaryControl.h"
+
+namespace visionary {
+
+/// Control session shared by many threads
+///
+/// Instead of one VisionaryControl (TCP connection and login) per thread, all threads of an application submit
+/// their commands to one session. Submitting is lock-free: commands are pushed to the queue of their lane and a
+/// single I/O thread does all sending and receiving.
+///
+/// Lanes are served in strict priority order, so a trigger command waits at most for the commands already sent,
+/// never for queued configuration reads. With CoLa 2 one in-flight slot is reserved for the TRIGGER lane and
+/// BACKGROUND commands are only sent while nothing else is in flight. A busy higher lane can starve the lower ones.
+///
+/// Use get() to share one session per device within a process.
+class SharedControlSession
+{
+public:
+  typedef CoLaRequestTracker::ResponseCallback ResponseCallback;
+
+  /// Submission lanes, in order of priority
+  enum class Lane
+  {
+    TRIGGER    = 0, ///< latency critical commands, e.g. software trigger
+    NORMAL     = 1, ///< default
+    BACKGROUND = 2  ///< health monitoring, bulk configuration reads
+  };
+
+  /// Returns the session of a device, opening it if there is none (or the existing one lost its connection)
+  ///
+  /// \return the session, or nullptr if the connection could not be established
+  static std::shared_ptr<SharedControlSession> get(VisionaryControl::ProtocolType protocol,
+                                                   const std::string&             hostname,
+                                                   std::uint32_t                  timeoutMs = 5000u,
+                                                   std::uint16_t                  port      = 0u);
+
+  SharedControlSession();
+  ~SharedControlSession();
+
+  SharedControlSession(const SharedControlSession&)            = delete;
+  SharedControlSession& operator=(const SharedControlSession&) = delete;
+
+  /// Opens the control connection (and for CoLa 2 the session)
+  ///
+  /// \param[in] protocol  protocol type the device understands (CoLa B or CoLa 2)
+  /// \param[in] hostname  host name or IP address of the device
+  /// \param[in] timeoutMs connect timeout and default timeout of the commands
+  /// \param[in] port      control port; 0 selects the default port of the protocol
+  bool open(VisionaryControl::ProtocolType protocol,
+            const std::string&             hostname,
+            std::uint32_t                  timeoutMs = 5000u,
+            std::uint16_t                  port      = 0u);
+
+  /// Closes the connection. Pending commands complete with CoLaCommand::networkErrorCommand().
+  ///
+  /// Commands submitted concurrently with or after close() complete with the same error.
+  void close();
+
+  /// True as long as the connection is alive
+  bool isConnected() const;
+
+  /// Logs the session in, for all threads using it
+  ///
+  /// The login method depends on the protocol, see loginCoLa(): SetAccessMode for CoLa B, the GetChallenge and
+  /// SetUserLevel challenge/response for CoLa 2 devices.
+  ///
+  /// \retval true  the device accepted the password
+  /// \retval false wrong password or no response
+  bool login(IAuthentication::UserLevel userLevel, const std::string& password);
+
+  /// Limits the number of CoLa 2 commands in flight (default 8, at least 2 to keep the reserved TRIGGER slot)
+  void setMaxInFlight(std::size_t maxInFlight);
+
+  /// Submits a command
+  ///
+  /// \param[in] command   command to send
+  /// \param[in] lane      priority lane
+  /// \param[in] callback  called from the I/O thread with the response; must not block
+  /// \param[in] timeoutMs time from submission until the command is given up; 0 selects the open() timeout
+  void sendCommandAsync(CoLaCommand command, Lane lane, ResponseCallback callback, std::uint32_t timeoutMs = 0u);
+
+  /// Submits a command
+  ///
+  /// \return future which receives the response
+  std::future<CoLaCommand> sendCommandAsync(CoLaCommand command, Lane lane, std::uint32_t timeoutMs = 0u);
+
+  /// Submits a command and waits for the response (must not be called from a callback)
+  CoLaCommand sendCommand(CoLaCommand command, Lane lane = Lane::NORMAL, std::uint32_t timeoutMs = 0u);
+
+  /// Latency, error and timeout statistics per command and the traffic of the connection since construction
+  CommandStatistics& getStatistics();
+
+private:
+  typedef CoLaRequestTracker::Clock Clock;
+
+  static const std::size_t kNumLanes = 3u;
+
+  void ioLoop();
+  void collectSubmissions();
+  bool sendPending();
+  void failAll();
+
+  CommandStatistics m_statistics; // declared first, the connection and the tracker record into it
+  CoLaConnection    m_connection;
+  WakeupSignal      m_wakeup;
+  std::thread       m_ioThread;
+  std::atomic<bool> m_stop;
+  std::atomic<bool> m_connected;
+  std::uint32_t     m_timeoutMs;
+
+  // producers currently pushing, failAll() waits for them to not strand a command in a lane
+  std::atomic<unsigned>    m_submitting;
+  std::atomic<std::size_t> m_maxInFlight;
+
+  MpscQueue<CoLaRequestTracker::Request> m_lanes[kNumLanes];
+
+  // owned by the I/O thread
+  std::deque<CoLaRequestTracker::Request> m_pending[kNumLanes];
+  CoLaRequestTracker                      m_tracker;
+};
+
+} // namespace visionary
@@ -0,0 +1,437 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "TcpConnection.h"
+
+#include <cstring>
+#include <mutex>
+
+#ifdef _WIN32
+#  include <ws2tcpip.h>
+#else
+#  include <arpa/inet.h>
+#  include <cerrno>
+#  include <fcntl.h>
+#  include <netdb.h>
+#  include <netinet/in.h>
+#  include <netinet/tcp.h>
+#  include <poll.h>
+#  include <sys/socket.h>
+#  include <unistd.h>
+#endif
+
+namespace visionary {
+
+namespace {
+
+#ifdef _WIN32
+const TcpConnection::NativeHandle kInvalidHandle = INVALID_SOCKET;
+
+void closeHandle(TcpConnection::NativeHandle handle)
+{
+  ::closesocket(handle);
+}
+
+bool setNonBlocking(TcpConnection::NativeHandle handle, bool nonBlocking)
+{
+  u_long mode = nonBlocking ? 1u : 0u;
+  return ::ioctlsocket(handle, FIONBIO, &mode) == 0;
+}
+
+int pollHandle(TcpConnection::NativeHandle handle, short events, std::uint32_t timeoutMs)
+{
+  WSAPOLLFD pfd;
+  pfd.fd      = handle;
+  pfd.events  = events;
+  pfd.revents = 0;
+  return ::WSAPoll(&pfd, 1, static_cast<INT>(timeoutMs));
+}
+
+// returns 1 if handle is readable, 0 on timeout or if only wakeupHandle is readable, -1 on error
+int pollReadable(TcpConnection::NativeHandle handle, TcpConnection::NativeHandle wakeupHandle, std::uint32_t timeoutMs)
+{
+  WSAPOLLFD pfd[2];
+  pfd[0].fd      = handle;
+  pfd[0].events  = POLLIN;
+  pfd[0].revents = 0;
+  pfd[1].fd      = wakeupHandle;
+  pfd[1].events  = POLLIN;
+  pfd[1].revents = 0;
+  const int ret  = ::WSAPoll(pfd, 2, static_cast<INT>(timeoutMs));
+  if (ret <= 0)
+  {
+    return ret;
+  }
+  return (pfd[0].revents != 0) ? 1 : 0;
+}
+#else
+const TcpConnection::NativeHandle kInvalidHandle = -1;
+
+void closeHandle(TcpConnection::NativeHandle handle)
+{
+  ::close(handle);
+}
+
+bool setNonBlocking(TcpConnection::NativeHandle handle, bool nonBlocking)
+{
+  const int flags = ::fcntl(handle, F_GETFL, 0);
+  if (flags < 0)
+  {
+    return false;
+  }
+  return ::fcntl(handle, F_SETFL, nonBlocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK)) == 0;
+}
+
+int pollHandle(TcpConnection::NativeHandle handle, short events, std::uint32_t timeoutMs)
+{
+  struct pollfd pfd;
+  pfd.fd      = handle;
+  pfd.events  = events;
+  pfd.revents = 0;
+  int ret;
+  do
+  {
+    ret = ::poll(&pfd, 1, static_cast<int>(timeoutMs));
+  } while ((ret < 0) && (errno == EINTR));
+  return ret;
+}
+
+// returns 1 if handle is readable, 0 on timeout or if only wakeupHandle is readable, -1 on error
+int pollReadable(TcpConnection::NativeHandle handle, TcpConnection::NativeHandle wakeupHandle, std::uint32_t timeoutMs)
+{
+  struct pollfd pfd[2];
+  pfd[0].fd      = handle;
+  pfd[0].events  = POLLIN;
+  pfd[0].revents = 0;
+  pfd[1].fd      = wakeupHandle;
+  pfd[1].events  = POLLIN;
+  pfd[1].revents = 0;
+  int ret;
+  do
+  {
+    ret = ::poll(pfd, 2, static_cast<int>(timeoutMs));
+  } while ((ret < 0) && (errno == EINTR));
+  if (ret <= 0)
+  {
+    return ret;
+  }
+  return (pfd[0].revents != 0) ? 1 : 0;
+}
+#endif
+
+} // namespace
+
+void TcpConnection::initSocketLibrary()
+{
+#ifdef _WIN32
+  static std::once_flag initFlag;
+  std::call_once(initFlag, []() {
+    WSADATA wsaData;
+    ::WSAStartup(MAKEWORD(2, 2), &wsaData);
+  });
+#endif
+}
+
+TcpConnection::TcpConnection() : m_socket(kInvalidHandle)
+{
+  initSocketLibrary();
+}
+
+TcpConnection::~TcpConnection()
+{
+  close();
+}
+
+bool TcpConnection::connect(const std::string& hostname, std::uint16_t port, std::uint32_t timeoutMs)
+{
+  close();
+
+  struct addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family   = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_protocol = IPPROTO_TCP;
+
+  const std::string service = std::to_string(static_cast<unsigned>(port));
+  struct addrinfo*  pResult = nullptr;
+  if ((::getaddrinfo(hostname.c_str(), service.c_str(), &hints, &pResult) != 0) || (pResult == nullptr))
+  {
+    return false;
+  }
+
+  NativeHandle handle = ::socket(pResult->ai_family, pResult->ai_socktype, pResult->ai_protocol);
+  if (handle == kInvalidHandle)
+  {
+    ::freeaddrinfo(pResult);
+    return false;
+  }
+
+  // connect non-blocking to be able to apply the timeout
+  bool connected = false;
+  if (setNonBlocking(handle, true))
+  {
+    const int ret = ::connect(handle, pResult->ai_addr, static_cast<socklen_t>(pResult->ai_addrlen));
+    if (ret == 0)
+    {
+      connected = true;
+    }
+    else if (pollHandle(handle, POLLOUT, timeoutMs) > 0)
+    {
+      int       soError = 0;
+      socklen_t len     = sizeof(soError);
+      connected = (::getsockopt(handle, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&soError), &len) == 0)
+                  && (soError == 0);
+    }
+  }
+  ::freeaddrinfo(pResult);
+
+  if (!connected || !setNonBlocking(handle, false))
+  {
+    closeHandle(handle);
+    return false;
+  }
+
+  // CoLa telegrams are small, don't let Nagle delay them
+  int noDelay = 1;
+  ::setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
+  m_socket = handle;
+  return true;
+}
+
+void TcpConnection::attach(NativeHandle handle)
+{
+  close();
+  int noDelay = 1;
+  ::setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+  m_socket = handle;
+}
+
+void TcpConnection::close()
+{
+  if (m_socket != kInvalidHandle)
+  {
+    closeHandle(m_socket);
+    m_socket = kInvalidHandle;
+  }
+}
+
+void TcpConnection::shutdown()
+{
+  if (m_socket != kInvalidHandle)
+  {
+#ifdef _WIN32
+    ::shutdown(m_socket, SD_BOTH);
+#else
+    ::shutdown(m_socket, SHUT_RDWR);
+#endif
+  }
+}
+
+bool TcpConnection::isOpen() const
+{
+  return m_socket != kInvalidHandle;
+}
+
+bool TcpConnection::send(const std::uint8_t* pData, std::size_t size)
+{
+  if (m_socket == kInvalidHandle)
+  {
+    return false;
+  }
+  while (size > 0u)
+  {
+#ifdef _WIN32
+    const int sent = ::send(m_socket, reinterpret_cast<const char*>(pData), static_cast<int>(size), 0);
+#else
+    const ssize_t sent = ::send(m_socket, pData, size, MSG_NOSIGNAL);
+    if ((sent < 0) && (errno == EINTR))
+    {
+      continue;
+    }
+#endif
+    if (sent <= 0)
+    {
+      return false;
+    }
+    pData += sent;
+    size -= static_cast<std::size_t>(sent);
+  }
+  return true;
+}
+
+int TcpConnection::recv(std::uint8_t* pData, std::size_t size, std::uint32_t timeoutMs, const WakeupSignal* pWakeup)
+{
+  if (m_socket == kInvalidHandle)
+  {
+    return -1;
+  }
+  const int ready = (pWakeup != nullptr) ? pollReadable(m_socket, pWakeup->nativeHandle(), timeoutMs)
+                                         : pollHandle(m_socket, POLLIN, timeoutMs);
+  if (ready == 0)
+  {
+    return 0;
+  }
+  if (ready < 0)
+  {
+    return -1;
+  }
+#ifdef _WIN32
+  const int received = ::recv(m_socket, reinterpret_cast<char*>(pData), static_cast<int>(size), 0);
+#else
+  ssize_t received;
+  do
+  {
+    received = ::recv(m_socket, pData, size, 0);
+  } while ((received < 0) && (errno == EINTR));
+#endif
+  // an orderly shutdown by the peer (0) is an error for us, 0 is reserved for timeouts
+  return (received > 0) ? static_cast<int>(received) : -1;
+}
+
+TcpConnection::NativeHandle TcpConnection::nativeHandle() const
+{
+  return m_socket;
+}
+
+TcpListener::TcpListener() : m_socket(kInvalidHandle), m_port(0u)
+{
+  TcpConnection::initSocketLibrary();
+}
+
+TcpListener::~TcpListener()
+{
+  close();
+}
+
+bool TcpListener::listen(const std::string& address, std::uint16_t port)
+{
+  close();
+
+  struct sockaddr_in addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port   = htons(port);
+  if (::inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1)
+  {
+    return false;
+  }
+
+  TcpConnection::NativeHandle handle = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (handle == kInvalidHandle)
+  {
+    return false;
+  }
+
+  int reuse = 1;
+  ::setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+  socklen_t addrLen = sizeof(addr);
+  if ((::bind(handle, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) || (::listen(handle, 64) != 0)
+      || (::getsockname(handle, reinterpret_cast<struct sockaddr*>(&addr), &addrLen) != 0))
+  {
+    closeHandle(handle);
+    return false;
+  }
+
+  m_socket = handle;
+  m_port   = ntohs(addr.sin_port);
+  return true;
+}
+
+int TcpListener::accept(TcpConnection& connection, std::uint32_t timeoutMs)
+{
+  if (m_socket == kInvalidHandle)
+  {
+    return -1;
+  }
+  const int ready = pollHandle(m_socket, POLLIN, timeoutMs);
+  if (ready <= 0)
+  {
+    return ready;
+  }
+  const TcpConnection::NativeHandle client = ::accept(m_socket, nullptr, nullptr);
+  if (client == kInvalidHandle)
+  {
+    return -1;
+  }
+  connection.attach(client);
+  return 1;
+}
+
+void TcpListener::close()
+{
+  if (m_socket != kInvalidHandle)
+  {
+    closeHandle(m_socket);
+    m_socket = kInvalidHandle;
+  }
+}
+
+bool TcpListener::isOpen() const
+{
+  return m_socket != kInvalidHandle;
+}
+
+std::uint16_t TcpListener::getPort() const
+{
+  return m_port;
+}
+
+WakeupSignal::WakeupSignal() : m_pending(false)
+{
+}
+
+bool WakeupSignal::open()
+{
+  close();
+
+  TcpListener listener;
+  if (!listener.listen("127.0.0.1", 0u) || !m_sender.connect("127.0.0.1", listener.getPort(), 1000u)
+      || (listener.accept(m_receiver, 1000u) <= 0))
+  {
+    close();
+    return false;
+  }
+  m_pending = false;
+  return true;
+}
+
+void WakeupSignal::close()
+{
+  m_sender.close();
+  m_receiver.close();
+}
+
+bool WakeupSignal::isOpen() const
+{
+  return m_sender.isOpen() && m_receiver.isOpen();
+}
+
+void WakeupSignal::signal()
+{
+  if (!m_pending.exchange(true))
+  {
+    const std::uint8_t byte = 0u;
+    m_sender.send(&byte, 1u);
+  }
+}
+
+void WakeupSignal::reset()
+{
+  // drain before clearing the flag: a signal() in between sends nothing, but its work is seen by the caller
+  std::uint8_t buffer[16];
+  while (m_receiver.recv(buffer, sizeof(buffer), 0u) > 0)
+  {
+  }
+  m_pending = false;
+}
+
+TcpConnection::NativeHandle WakeupSignal::nativeHandle() const
+{
+  return m_receiver.nativeHandle();
+}
+
+} // namespace visionary
@@ -0,0 +1,159 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+#  include <winsock2.h>
+#endif
+
+namespace visionary {
+
+class WakeupSignal;
+
+/// Minimal blocking TCP connection used by the sample helpers
+///
+/// The helpers in this folder need their own sockets (e.g. for a second control connection which receives
+/// asynchronous CoLa telegrams), so this class wraps the few socket calls needed on Windows and POSIX.
+class TcpConnection
+{
+public:
+#ifdef _WIN32
+  typedef SOCKET NativeHandle;
+#else
+  typedef int NativeHandle;
+#endif
+
+  TcpConnection();
+  ~TcpConnection();
+
+  TcpConnection(const TcpConnection&)            = delete;
+  TcpConnection& operator=(const TcpConnection&) = delete;
+
+  /// Connects to a remote host
+  ///
+  /// \param[in] hostname  host name or IP address of the device
+  /// \param[in] port      TCP port
+  /// \param[in] timeoutMs maximum time to wait for the connection to be established
+  ///
+  /// \retval true  the connection was established
+  /// \retval false the host could not be resolved or did not accept the connection in time
+  bool connect(const std::string& hostname, std::uint16_t port, std::uint32_t timeoutMs);
+
+  /// Takes over an already connected socket (e.g. one returned by accept()).
+  void attach(NativeHandle handle);
+
+  /// Closes the connection. Safe to call more than once.
+  void close();
+
+  /// Shuts down both directions without releasing the handle.
+  ///
+  /// This wakes up a thread that is blocked in recv() on this connection.
+  void shutdown();
+
+  bool isOpen() const;
+
+  /// Sends the complete buffer
+  ///
+  /// \return false if the connection is broken
+  bool send(const std::uint8_t* pData, std::size_t size);
+
+  /// Receives up to size bytes
+  ///
+  /// \param[out] pData     destination buffer
+  /// \param[in]  size      size of the destination buffer
+  /// \param[in]  timeoutMs maximum time to wait for data
+  /// \param[in]  pWakeup   optional signal which ends the wait early (see WakeupSignal)
+  ///
+  /// \return number of bytes received, 0 on timeout or wake-up, -1 if the connection was closed or broken
+  int recv(std::uint8_t* pData, std::size_t size, std::uint32_t timeoutMs, const WakeupSignal* pWakeup = nullptr);
+
+  NativeHandle nativeHandle() const;
+
+  /// Performs the one-time socket library initialization (only needed on Windows, no-op on POSIX).
+  static void initSocketLibrary();
+
+private:
+  NativeHandle m_socket;
+};
+
+/// Listening TCP socket, used by the device simulators
+class TcpListener
+{
+public:
+  TcpListener();
+  ~TcpListener();
+
+  TcpListener(const TcpListener&)            = delete;
+  TcpListener& operator=(const TcpListener&) = delete;
+
+  /// Binds to the given address and port and starts listening
+  ///
+  /// \param[in] address local IPv4 address, e.g. "127.0.0.1" or "0.0.0.0"
+  /// \param[in] port    local port; 0 lets the system choose a free port (see getPort())
+  ///
+  /// \retval true  the socket is listening
+  /// \retval false the address is invalid or the port is in use
+  bool listen(const std::string& address, std::uint16_t port);
+
+  /// Waits for an incoming connection
+  ///
+  /// \param[out] connection receives the accepted connection
+  /// \param[in]  timeoutMs  maximum time to wait
+  ///
+  /// \return 1 if a connection was accepted, 0 on timeout, -1 on error
+  int accept(TcpConnection& connection, std::uint32_t timeoutMs);
+
+  void close();
+
+  bool isOpen() const;
+
+  /// The local port the socket is bound to
+  std::uint16_t getPort() const;
+
+private:
+  TcpConnection::NativeHandle m_socket;
+  std::uint16_t               m_port;
+};
+
+/// Wakes up a thread waiting in TcpConnection::recv()
+///
+/// Implemented with a connected pair of loopback sockets, since on Windows a pipe can't be waited for together
+/// with a socket.
+class WakeupSignal
+{
+public:
+  WakeupSignal();
+
+  WakeupSignal(const WakeupSignal&)            = delete;
+  WakeupSignal& operator=(const WakeupSignal&) = delete;
+
+  /// Creates the socket pair
+  bool open();
+
+  void close();
+
+  bool isOpen() const;
+
+  /// Ends the current or the next wait; cheap if a signal is already pending
+  void signal();
+
+  /// Clears a pending signal. Check for work after the reset, not before, to not miss a signal.
+  void reset();
+
+  TcpConnection::NativeHandle nativeHandle() const;
+
+private:
+  TcpConnection     m_sender;
+  TcpConnection     m_receiver;
+  std::atomic<bool> m_pending;
+};
+
+} // namespace visionary
@@ -0,0 +1,267 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "TracedDataStream.h"
+
+#include <algorithm>
+
+#include "AllocationTracker.h"
+#include "ChromeTrace.h"
+#include "VisionaryProbes.h"
+
+namespace visionary {
+
+namespace {
+
+const std::uint32_t kTelegramMagic = 0x02020202u;
+const std::uint8_t  kStx           = 0x02u;
+const std::size_t   kMagicSize     = 4u;
+
+// far above the BLOB of any device (a Visionary-S frame is below 4 MiB), a larger length is a corrupt header
+const std::uint32_t kMaxPackageLength = 16u * 1024u * 1024u;
+
+std::uint32_t getBigEndian32(const std::uint8_t* pSrc)
+{
+  return (static_cast<std::uint32_t>(pSrc[0]) << 24u) | (static_cast<std::uint32_t>(pSrc[1]) << 16u)
+         | (static_cast<std::uint32_t>(pSrc[2]) << 8u) | static_cast<std::uint32_t>(pSrc[3]);
+}
+
+} // namespace
+
+const std::size_t TracedDataStream::kHeaderSize;
+
+TracedDataStream::TracedDataStream(std::shared_ptr<VisionaryData> pDataHandler)
+  : m_pDataHandler(pDataHandler)
+  , m_headerReceived(0u)
+  , m_bufferReceived(0u)
+  , m_hasFrameNumber(false)
+  , m_lastFrameNumber(0u)
+  , m_frameCount(0u)
+  , m_droppedCount(0u)
+  , m_invalidCount(0u)
+{
+}
+
+bool TracedDataStream::open(const std::string& hostname, std::uint16_t port, std::uint32_t timeoutMs)
+{
+  close();
+  m_parser.reset();
+  resetTelegram();
+  m_hasFrameNumber = false;
+  m_hostname       = hostname;
+  return m_connection.connect(hostname, port, timeoutMs);
+}
+
+void TracedDataStream::close()
+{
+  m_connection.close();
+  resetTelegram();
+}
+
+bool TracedDataStream::isConnected() const
+{
+  return m_connection.isOpen();
+}
+
+bool TracedDataStream::getNextFrame(std::uint32_t timeoutMs)
+{
+  const FrameTrace::Clock::time_point deadline = FrameTrace::Clock::now() + std::chrono::milliseconds(timeoutMs);
+
+  ReadResult result = ReadResult::OK;
+  {
+    AllocationScope allocationScope(FrameStage::BLOB_COMPLETE);
+    result = readTelegram(deadline);
+  }
+  if (result == ReadResult::CLOSED)
+  {
+    close();
+  }
+  if (result != ReadResult::OK)
+  {
+    return false;
+  }
+  // the telegram stays in m_buffer for parsing, the next call starts a new one
+  resetTelegram();
+  m_trace.mark(FrameStage::BLOB_COMPLETE);
+  VISIONARY_PROBE2(frame_received, m_hostname.c_str(), m_buffer.size());
+
+  VISIONARY_PROBE2(decode_start, m_hostname.c_str(), m_buffer.size());
+  bool parsed = false;
+  {
+    AllocationScope allocationScope(FrameStage::DECODED);
+    parsed = m_parser.parse(*m_pDataHandler, m_buffer);
+  }
+  if (!parsed)
+  {
+    VISIONARY_PROBE3(decode_end, m_hostname.c_str(), 0u, 0);
+    ++m_invalidCount;
+    return false;
+  }
+  m_trace.frameNumber       = m_pDataHandler->getFrameNum();
+  m_trace.deviceTimestampMs = m_pDataHandler->getTimestampMS();
+  m_trace.mark(FrameStage::DECODED);
+  VISIONARY_PROBE3(decode_end, m_hostname.c_str(), m_trace.frameNumber, 1);
+  countFrame(m_trace.frameNumber);
+
+  if (ChromeTrace::isEnabled())
+  {
+    const std::int64_t frameNumber = m_trace.frameNumber;
+    ChromeTrace::addSpan("receive",
+                         "stream",
+                         m_trace.getTime(FrameStage::FIRST_BYTE),
+                         m_trace.getTime(FrameStage::BLOB_COMPLETE),
+                         "frame",
+                         frameNumber);
+    ChromeTrace::addSpan("parse",
+                         "stream",
+                         m_trace.getTime(FrameStage::BLOB_COMPLETE),
+                         m_trace.getTime(FrameStage::DECODED),
+                         "frame",
+                         frameNumber);
+  }
+  return true;
+}
+
+std::shared_ptr<VisionaryData> TracedDataStream::getDataHandler() const
+{
+  return m_pDataHandler;
+}
+
+void TracedDataStream::generatePointCloud(std::vector<PointXYZ>& pointCloud)
+{
+  TraceSpan       span("point cloud", "stream", "frame", m_trace.frameNumber);
+  AllocationScope allocationScope(FrameStage::POINT_CLOUD);
+  m_pDataHandler->generatePointCloud(pointCloud);
+  m_trace.mark(FrameStage::POINT_CLOUD);
+}
+
+void TracedDataStream::pickUp()
+{
+  m_trace.mark(FrameStage::PICKUP);
+  m_report.record(m_trace);
+}
+
+const FrameTrace& TracedDataStream::getTrace() const
+{
+  return m_trace;
+}
+
+FrameLatencyReport& TracedDataStream::getReport()
+{
+  return m_report;
+}
+
+const FrameLatencyReport& TracedDataStream::getReport() const
+{
+  return m_report;
+}
+
+std::uint64_t TracedDataStream::getFrameCount() const
+{
+  return m_frameCount;
+}
+
+std::uint64_t TracedDataStream::getDroppedCount() const
+{
+  return m_droppedCount;
+}
+
+std::uint64_t TracedDataStream::getInvalidCount() const
+{
+  return m_invalidCount;
+}
+
+TracedDataStream::ReadResult TracedDataStream::readExactly(std::uint8_t*                 pData,
+                                                           std::size_t                   size,
+                                                           std::size_t&                  received,
+                                                           FrameTrace::Clock::time_point deadline)
+{
+  while (received < size)
+  {
+    const auto remainingMs =
+      std::chrono::duration_cast<std::chrono::milliseconds>(deadline - FrameTrace::Clock::now()).count();
+    if (remainingMs < 0)
+    {
+      return ReadResult::TIMEOUT;
+    }
+    const std::uint32_t waitMs = static_cast<std::uint32_t>(std::max<long long>(remainingMs, 1));
+    const int           result = m_connection.recv(pData + received, size - received, waitMs);
+    if (result < 0)
+    {
+      return ReadResult::CLOSED;
+    }
+    received += static_cast<std::size_t>(result);
+  }
+  return ReadResult::OK;
+}
+
+TracedDataStream::ReadResult TracedDataStream::readTelegram(FrameTrace::Clock::time_point deadline)
+{
+  while (m_headerReceived < kHeaderSize)
+  {
+    const ReadResult result = readExactly(m_header, kHeaderSize, m_headerReceived, deadline);
+    if (result != ReadResult::OK)
+    {
+      return result;
+    }
+    if (acceptHeader())
+    {
+      break;
+    }
+
+    // not the start of a telegram (only after garbage on the stream): continue at the next possible magic
+    std::size_t skip = 1u;
+    while ((skip < kHeaderSize)
+           && !std::all_of(m_header + skip,
+                           m_header + std::min(skip + kMagicSize, kHeaderSize),
+                           [](std::uint8_t byte) { return byte == kStx; }))
+    {
+      ++skip;
+    }
+    std::copy(m_header + skip, m_header + kHeaderSize, m_header);
+    m_headerReceived = kHeaderSize - skip;
+  }
+  return readExactly(m_buffer.data(), m_buffer.size(), m_bufferReceived, deadline);
+}
+
+bool TracedDataStream::acceptHeader()
+{
+  if (getBigEndian32(m_header) != kTelegramMagic)
+  {
+    return false;
+  }
+  const std::uint32_t packageLength = getBigEndian32(m_header + kMagicSize);
+  if ((packageLength == 0u) || (packageLength > kMaxPackageLength))
+  {
+    ++m_invalidCount;
+    return false;
+  }
+  m_trace.clear();
+  m_trace.mark(FrameStage::FIRST_BYTE);
+  m_buffer.resize(packageLength);
+  m_bufferReceived = 0u;
+  return true;
+}
+
+void TracedDataStream::resetTelegram()
+{
+  m_headerReceived = 0u;
+  m_bufferReceived = 0u;
+}
+
+void TracedDataStream::countFrame(std::uint32_t frameNumber)
+{
+  ++m_frameCount;
+  // frame numbers wrap around; a step backwards means the device restarted the numbering
+  const std::int32_t step = static_cast<std::int32_t>(frameNumber - m_lastFrameNumber);
+  if (m_hasFrameNumber && (step > 1))
+  {
+    m_droppedCount += static_cast<std::uint64_t>(step - 1);
+  }
+  m_hasFrameNumber  = true;
+  m_lastFrameNumber = frameNumber;
+}
+
+} // namespace visionary
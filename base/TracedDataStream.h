@@ -0,0 +1,135 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BlobParser.h"
+#include "FrameTrace.h"
+#include "PointXYZ.h"
+#include "TcpConnection.h"
+#include "VisionaryData.h"
+
+namespace visionary {
+
+/// Data stream receiver which traces every frame through the acquisition pipeline
+///
+/// Works like VisionaryDataStream: the BLOB telegrams are read from the data stream port and parsed into the data
+/// handler. Additionally the FrameTrace of the current frame is stamped when its first byte is read, when the
+/// telegram is complete and when the data handler has parsed it; generatePointCloud() and pickUp() add the
+/// remaining stages. pickUp() records the trace in the FrameLatencyReport of the stream, which gives the percentiles
+/// of every pipeline step.
+///
+/// Typical single-threaded use:
+///
+///   stream.getNextFrame();
+///   stream.generatePointCloud(pointCloud);
+///   stream.pickUp();
+///
+/// When the frames are handed over to a consumer thread, pass a copy of getTrace() along with the frame and let
+/// the consumer stamp FrameStage::PICKUP and record it in getReport().
+class TracedDataStream
+{
+public:
+  /// \param[in] pDataHandler data handler of the device type, e.g. VisionaryTMiniData
+  explicit TracedDataStream(std::shared_ptr<VisionaryData> pDataHandler);
+
+  TracedDataStream(const TracedDataStream&)            = delete;
+  TracedDataStream& operator=(const TracedDataStream&) = delete;
+
+  /// Connects to the data stream port
+  ///
+  /// \param[in] hostname  host name or IP address of the device
+  /// \param[in] port      data stream port
+  /// \param[in] timeoutMs maximum time to wait for the connection
+  bool open(const std::string& hostname, std::uint16_t port = 2114u, std::uint32_t timeoutMs = 5000u);
+
+  void close();
+
+  bool isConnected() const;
+
+  /// Receives and parses the next frame; starts a new trace
+  ///
+  /// A timeout does not lose data: the part of a telegram received so far is kept and the next call continues with
+  /// it, so short timeouts (e.g. while flushing with FrameStreamSync) never cut a frame in transit.
+  ///
+  /// \param[in] timeoutMs maximum time to wait for the complete frame
+  ///
+  /// \retval true  the data handler holds the new frame
+  /// \retval false timeout, connection lost or the telegram could not be parsed (see isConnected())
+  bool getNextFrame(std::uint32_t timeoutMs = 1000u);
+
+  std::shared_ptr<VisionaryData> getDataHandler() const;
+
+  /// Generates the point cloud of the current frame and stamps FrameStage::POINT_CLOUD
+  void generatePointCloud(std::vector<PointXYZ>& pointCloud);
+
+  /// Stamps FrameStage::PICKUP and records the trace of the current frame in the report
+  void pickUp();
+
+  /// Trace of the current frame
+  const FrameTrace& getTrace() const;
+
+  FrameLatencyReport&       getReport();
+  const FrameLatencyReport& getReport() const;
+
+  /// Number of frames received and parsed since construction
+  std::uint64_t getFrameCount() const;
+
+  /// Number of frames missing in the sequence of frame numbers (dropped by the device, the network or because the
+  /// receiver fell behind)
+  std::uint64_t getDroppedCount() const;
+
+  /// Telegrams skipped because they could not be parsed or had an implausible length
+  std::uint64_t getInvalidCount() const;
+
+private:
+  enum class ReadResult
+  {
+    OK,
+    TIMEOUT,
+    CLOSED
+  };
+
+  static const std::size_t kHeaderSize = 4u + 4u; // magic and package length
+
+  ReadResult readExactly(std::uint8_t*                 pData,
+                         std::size_t                   size,
+                         std::size_t&                  received,
+                         FrameTrace::Clock::time_point deadline);
+  ReadResult readTelegram(FrameTrace::Clock::time_point deadline);
+  bool       acceptHeader();
+  void       resetTelegram();
+  void       countFrame(std::uint32_t frameNumber);
+
+  std::shared_ptr<VisionaryData> m_pDataHandler;
+  std::string                    m_hostname;
+  TcpConnection                  m_connection;
+
+  // telegram being received, kept across timeouts
+  std::uint8_t              m_header[kHeaderSize];
+  std::size_t               m_headerReceived;
+  std::vector<std::uint8_t> m_buffer;
+  std::size_t               m_bufferReceived;
+
+  BlobParser         m_parser;
+  FrameTrace         m_trace;
+  FrameLatencyReport m_report;
+  bool               m_hasFrameNumber;
+  std::uint32_t      m_lastFrameNumber;
+
+  // read by metrics collectors from other threads
+  std::atomic<std::uint64_t> m_frameCount;
+  std::atomic<std::uint64_t> m_droppedCount;
+  std::atomic<std::uint64_t> m_invalidCount;
+};
+
+} // namespace visionary
@@ -0,0 +1,149 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "CoLaError.h"
+#include "CoLaParameterWriter.h"
+#include "FrameGrabber.h"
+#include "FrameStreamSync.h"
+#include "VisionaryControl.h"
+
+namespace visionary {
+
+/// Triggered acquisition of single frames
+///
+/// After arming, frames are only taken on a trigger (a rising edge on IO1 or stepAcquisition()). The frame is
+/// waited for on the data stream only; in contrast to polling the TriggerBusy output via "IOValue" there is no
+/// control channel traffic between trigger and frame, so no round trip is added to the latency and the control
+/// channel stays free for other commands.
+///
+/// \tparam TDataType data handler of the device, e.g. VisionaryTMiniData
+template <class TDataType>
+class TriggeredCapture
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Result
+  {
+    std::shared_ptr<TDataType> pFrame;
+
+    /// time the frame was handed out to the caller
+    Clock::time_point receivedTime;
+
+    /// time from trigger to receivedTime, on the steady clock of the host
+    ///
+    /// For triggerAndWait() this is measured from the stepAcquisition() call, for waitForFrame() from the trigger
+    /// time passed by the caller; zero if the trigger time is not known. The frame timestamp is not used: the device
+    /// clock is neither steady nor necessarily synchronized with the host.
+    std::chrono::microseconds latency;
+
+    /// time from the call to receivedTime; for an external trigger this is mostly the wait for the trigger
+    std::chrono::microseconds waitTime;
+  };
+
+  /// \param[in] control      open control connection of the device
+  /// \param[in] frameGrabber frame grabber connected to the data stream of the same device
+  TriggeredCapture(VisionaryControl& control, FrameGrabber<TDataType>& frameGrabber)
+    : m_control(control), m_streamSync(frameGrabber)
+  {
+  }
+
+  /// Configures the device for IO triggered acquisition
+  ///
+  /// Sets frontendMode to STOP (1), DIO1Fnc to Trigger (7) and DIO2Fnc to TriggerBusy (23). The control
+  /// connection has to be logged in as AUTHORIZED_CLIENT. Frames taken before (e.g. in continuous mode) are
+  /// flushed, so they are not mistaken for triggered frames.
+  ///
+  /// \retval true  all variables were written
+  /// \retval false at least one write failed
+  bool armHardwareTrigger()
+  {
+    bool ok = writeUSInt("frontendMode", 1u);
+    ok      = writeUSInt("DIO1Fnc", 7u) && ok;
+    ok      = writeUSInt("DIO2Fnc", 23u) && ok;
+    m_streamSync.flush();
+    return ok;
+  }
+
+  /// Waits for the next frame taken on a hardware trigger
+  ///
+  /// No commands are sent to the device while waiting.
+  ///
+  /// \param[out] result      received frame, receive time, latency and wait time
+  /// \param[in]  timeoutMs   maximum time to wait for a trigger
+  /// \param[in]  triggerTime time the trigger was sent, e.g. taken right before the application set the output
+  ///                         wired to IO1; the latency is measured from it
+  ///
+  /// \retval true  a frame was received
+  /// \retval false no frame within timeoutMs
+  bool waitForFrame(Result& result, std::uint32_t timeoutMs, Clock::time_point triggerTime)
+  {
+    if (!receive(result, timeoutMs))
+    {
+      return false;
+    }
+    result.latency = std::chrono::duration_cast<std::chrono::microseconds>(result.receivedTime - triggerTime);
+    return true;
+  }
+
+  /// Waits for the next frame taken on a hardware trigger sent by somebody else (e.g. a light barrier)
+  ///
+  /// The trigger time is not known: result.latency is zero, result.waitTime includes the wait for the trigger.
+  bool waitForFrame(Result& result, std::uint32_t timeoutMs)
+  {
+    if (!receive(result, timeoutMs))
+    {
+      return false;
+    }
+    result.latency = std::chrono::microseconds::zero();
+    return true;
+  }
+
+  /// Triggers a single frame by software (stepAcquisition) and waits for it
+  ///
+  /// \param[out] result    received frame, receive time and latency measured from the trigger command
+  /// \param[in]  timeoutMs maximum time to wait for the frame
+  ///
+  /// \retval true  a frame was received
+  /// \retval false the trigger command failed or no frame within timeoutMs
+  bool triggerAndWait(Result& result, std::uint32_t timeoutMs)
+  {
+    const Clock::time_point triggerTime = Clock::now();
+    return m_control.stepAcquisition() && waitForFrame(result, timeoutMs, triggerTime);
+  }
+
+private:
+  /// Fills everything but the latency
+  bool receive(Result& result, std::uint32_t timeoutMs)
+  {
+    const Clock::time_point callTime = Clock::now();
+    if (!m_streamSync.getNextFrame(result.pFrame, timeoutMs))
+    {
+      return false;
+    }
+    result.receivedTime = Clock::now();
+    result.waitTime     = std::chrono::duration_cast<std::chrono::microseconds>(result.receivedTime - callTime);
+    return true;
+  }
+
+  bool writeUSInt(const char* name, std::uint8_t value)
+  {
+    const CoLaCommand command =
+      CoLaParameterWriter(CoLaCommandType::WRITE_VARIABLE, name).parameterUSInt(value).build();
+    CoLaCommand response = m_control.sendCommand(command);
+    return response.getError() == CoLaError::OK;
+  }
+
+  VisionaryControl&          m_control;
+  FrameStreamSync<TDataType> m_streamSync;
+};
+
+} // namespace visionary
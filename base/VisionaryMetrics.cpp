@@ -0,0 +1,116 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "VisionaryMetrics.h"
+
+namespace visionary {
+
+namespace {
+
+void writeControlMetrics(MetricsWriter& writer, const std::string& labels, const CommandStatistics::Snapshot& snapshot)
+{
+  for (const CommandStatistics::CommandSnapshot& command : snapshot.commands)
+  {
+    const std::string commandLabels = MetricsWriter::join(labels, MetricsWriter::label("command", command.command));
+    writer.histogram("visionary_control_command_duration_seconds",
+                     "Round trip time of control commands",
+                     commandLabels,
+                     command.latency);
+    writer.counter("visionary_control_command_errors_total",
+                   "Control commands answered with a CoLa error",
+                   commandLabels,
+                   command.errors);
+    writer.counter("visionary_control_command_timeouts_total",
+                   "Control commands without response in time",
+                   commandLabels,
+                   command.timeouts);
+    writer.counter("visionary_control_command_aborted_total",
+                   "Control commands lost with the connection",
+                   commandLabels,
+                   command.aborted);
+  }
+  writer.counter(
+    "visionary_control_telegrams_sent_total", "Telegrams sent on the control channel", labels, snapshot.telegramsSent);
+  writer.counter("visionary_control_telegrams_received_total",
+                 "Telegrams received on the control channel",
+                 labels,
+                 snapshot.telegramsReceived);
+  writer.counter(
+    "visionary_control_bytes_sent_total", "Bytes sent on the control channel", labels, snapshot.bytesSent);
+  writer.counter(
+    "visionary_control_bytes_received_total", "Bytes received on the control channel", labels, snapshot.bytesReceived);
+}
+
+} // namespace
+
+std::size_t addControlMetrics(MetricsRegistry&         registry,
+                              const std::string&       device,
+                              const CommandStatistics& statistics)
+{
+  const std::string labels = MetricsWriter::label("device", device);
+  return registry.addCollector(
+    [labels, &statistics](MetricsWriter& writer) { writeControlMetrics(writer, labels, statistics.snapshot()); });
+}
+
+std::size_t addControlMetrics(MetricsRegistry& registry, const std::string& device, AsyncControl& control)
+{
+  const std::string labels = MetricsWriter::label("device", device);
+  return registry.addCollector([labels, &control](MetricsWriter& writer) {
+    writeControlMetrics(writer, labels, control.getStatistics().snapshot());
+    writer.gauge("visionary_control_requests_in_flight",
+                 "Control commands sent and waiting for the response",
+                 labels,
+                 static_cast<double>(control.getInFlightCount()));
+  });
+}
+
+std::size_t addSessionMetrics(MetricsRegistry&             registry,
+                              const std::string&           device,
+                              const ManagedControlSession& session)
+{
+  const std::string labels = MetricsWriter::label("device", device);
+  return registry.addCollector([labels, &session](MetricsWriter& writer) {
+    writer.counter(
+      "visionary_control_logins_total", "Authentications sent to the device", labels, session.getLoginCount());
+    writer.counter("visionary_control_reconnects_total",
+                   "Times the control connection was re-established",
+                   labels,
+                   session.getReconnectCount());
+  });
+}
+
+std::size_t addStreamMetrics(MetricsRegistry& registry, const std::string& device, const TracedDataStream& stream)
+{
+  const std::string labels = MetricsWriter::label("device", device);
+  return registry.addCollector([labels, &stream](MetricsWriter& writer) {
+    writer.counter("visionary_frames_received_total", "Frames received and parsed", labels, stream.getFrameCount());
+    writer.counter("visionary_frames_dropped_total",
+                   "Frames missing in the frame number sequence",
+                   labels,
+                   stream.getDroppedCount());
+    writer.counter(
+      "visionary_frames_invalid_total", "Telegrams which could not be parsed", labels, stream.getInvalidCount());
+
+    const FrameLatencyReport::Snapshot report = stream.getReport().snapshot();
+    for (std::size_t i = 1u; i < kNumFrameStages; ++i)
+    {
+      if (report.stages[i].count > 0u)
+      {
+        const std::string stepLabels = MetricsWriter::join(
+          labels, MetricsWriter::label("step", getFrameStageName(static_cast<FrameStage>(i))));
+        writer.histogram("visionary_frame_step_duration_seconds",
+                         "Time of a frame from the previous pipeline step until this one",
+                         stepLabels,
+                         report.stages[i]);
+      }
+    }
+    writer.histogram("visionary_frame_transfer_delay_seconds",
+                     "Time from the device timestamp until the first byte of the frame was received",
+                     labels,
+                     report.transfer);
+  });
+}
+
+} // namespace visionary
@@ -0,0 +1,52 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "AsyncControl.h"
+#include "CommandStatistics.h"
+#include "ManagedControlSession.h"
+#include "MetricsRegistry.h"
+#include "TracedDataStream.h"
+
+namespace visionary {
+
+// Collectors exporting the statistics of the control and acquisition helpers in a MetricsRegistry. Every metric
+// carries a "device" label. The objects are only read while the metrics are rendered, so they must stay alive until
+// the returned collector id is passed to MetricsRegistry::removeCollector().
+
+/// Command latencies, errors, timeouts and traffic of a control connection
+///
+/// The statistics are e.g. the ones of SharedControlSession::getStatistics().
+///
+/// Exports visionary_control_command_duration_seconds, visionary_control_command_errors_total,
+/// visionary_control_command_timeouts_total and visionary_control_command_aborted_total labeled by command, and
+/// visionary_control_telegrams_{sent,received}_total and visionary_control_bytes_{sent,received}_total.
+std::size_t addControlMetrics(MetricsRegistry&         registry,
+                              const std::string&       device,
+                              const CommandStatistics& statistics);
+
+/// Statistics of an AsyncControl connection plus the number of requests waiting for their response
+/// (visionary_control_requests_in_flight)
+std::size_t addControlMetrics(MetricsRegistry& registry, const std::string& device, AsyncControl& control);
+
+/// Logins and reconnects of a ManagedControlSession
+///
+/// Exports visionary_control_logins_total and visionary_control_reconnects_total.
+std::size_t addSessionMetrics(MetricsRegistry&             registry,
+                              const std::string&           device,
+                              const ManagedControlSession& session);
+
+/// Frames of a TracedDataStream
+///
+/// Exports visionary_frames_received_total, visionary_frames_dropped_total (gaps in the frame numbers),
+/// visionary_frames_invalid_total, visionary_frame_step_duration_seconds labeled by the pipeline step (e.g.
+/// step="decoded" is the decode time) and visionary_frame_transfer_delay_seconds (device timestamp to first byte).
+std::size_t addStreamMetrics(MetricsRegistry& registry, const std::string& device, const TracedDataStream& stream);
+
+} // namespace visionary
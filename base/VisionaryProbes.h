@@ -0,0 +1,44 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+// USDT (user-level statically defined tracing) probes for bpftrace, SystemTap or perf
+//
+// The probes are compiled in when VISIONARY_ENABLE_USDT is defined (CMake option VISIONARY_SAMPLES_ENABLE_USDT,
+// needs <sys/sdt.h> from systemtap-sdt-dev). A probe nobody attached to is a single nop instruction; without the
+// option the macros expand to nothing and their arguments are not evaluated.
+//
+// Provider "visionary"; the camera argument is the host name the connection was opened with (a C string):
+//
+//   frame_received(camera, bytes)                 BLOB telegram of a frame completely received (TracedDataStream)
+//   decode_start(camera, bytes)                   data handler starts parsing the telegram
+//   decode_end(camera, frameNumber, ok)           data handler finished; ok is 0 when the telegram was invalid
+//   cola_send(camera, requestId, bytes)           CoLa telegram written to the control socket (CoLaConnection)
+//   cola_receive(camera, requestId, bytes)        CoLa telegram decoded from the control socket; bytes is the payload
+//
+// Example:
+//
+//   bpftrace -e 'usdt:./SampleVisionaryS:visionary:decode_end { printf("%s frame %u\n", str(arg0), arg1); }'
+
+#if defined(VISIONARY_ENABLE_USDT)
+
+#include <sys/sdt.h>
+
+#define VISIONARY_PROBE2(name, arg1, arg2)       DTRACE_PROBE2(visionary, name, arg1, arg2)
+#define VISIONARY_PROBE3(name, arg1, arg2, arg3) DTRACE_PROBE3(visionary, name, arg1, arg2, arg3)
+
+#else
+
+#define VISIONARY_PROBE2(name, arg1, arg2) \
+  do                                       \
+  {                                        \
+  } while (false)
+#define VISIONARY_PROBE3(name, arg1, arg2, arg3) \
+  do                                             \
+  {                                              \
+  } while (false)
+
+#endif
@@ -0,0 +1,336 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "ZoneMonitor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace visionary {
+
+const std::size_t ZoneMonitor::kMaxZones;
+
+namespace {
+
+const double kMaxValue = static_cast<double>(std::numeric_limits<std::uint16_t>::max());
+
+// rays almost parallel to a plane are treated as parallel
+const double kParallelEpsilon = 1e-12;
+
+double cross(double ax, double ay, double bx, double by)
+{
+  return ax * by - ay * bx;
+}
+
+} // namespace
+
+MonitoringZone::MonitoringZone()
+{
+}
+
+MonitoringZone MonitoringZone::box(const PointXYZ& minCorner, const PointXYZ& maxCorner)
+{
+  MonitoringZone zone;
+  zone.addPlane(1., 0., 0., maxCorner.x);
+  zone.addPlane(-1., 0., 0., -minCorner.x);
+  zone.addPlane(0., 1., 0., maxCorner.y);
+  zone.addPlane(0., -1., 0., -minCorner.y);
+  zone.addPlane(0., 0., 1., maxCorner.z);
+  zone.addPlane(0., 0., -1., -minCorner.z);
+  return zone;
+}
+
+MonitoringZone MonitoringZone::prism(const std::vector<PointXYZ>& polygon, float zMin, float zMax)
+{
+  MonitoringZone    zone;
+  const std::size_t numCorners = polygon.size();
+  if (numCorners < 3u)
+  {
+    return zone;
+  }
+
+  // convex if all turns go the same way; their direction tells on which side of the edges the inside is
+  int orientation = 0; // 1: counterclockwise, -1: clockwise
+  for (std::size_t i = 0u; i < numCorners; ++i)
+  {
+    const PointXYZ& a    = polygon[i];
+    const PointXYZ& b    = polygon[(i + 1u) % numCorners];
+    const PointXYZ& c    = polygon[(i + 2u) % numCorners];
+    const double    turn = cross(b.x - a.x, b.y - a.y, c.x - b.x, c.y - b.y);
+    const int       side = (turn > 0.) ? 1 : ((turn < 0.) ? -1 : 0);
+    if ((side * orientation) < 0)
+    {
+      return zone;
+    }
+    if (side != 0)
+    {
+      orientation = side;
+    }
+  }
+  if (orientation == 0)
+  {
+    return zone; // all corners on a line
+  }
+
+  for (std::size_t i = 0u; i < numCorners; ++i)
+  {
+    // outward normal of the edge: the edge direction turned away from the inside
+    const PointXYZ& a  = polygon[i];
+    const PointXYZ& b  = polygon[(i + 1u) % numCorners];
+    const double    nx = (orientation > 0) ? (b.y - a.y) : (a.y - b.y);
+    const double    ny = (orientation > 0) ? (a.x - b.x) : (b.x - a.x);
+    if ((std::fabs(nx) + std::fabs(ny)) > 0.) // skips repeated corners
+    {
+      zone.addPlane(nx, ny, 0., nx * a.x + ny * a.y);
+    }
+  }
+  zone.addPlane(0., 0., 1., zMax);
+  zone.addPlane(0., 0., -1., -zMin);
+  return zone;
+}
+
+bool MonitoringZone::empty() const
+{
+  return m_planes.empty();
+}
+
+const std::vector<MonitoringZone::Plane>& MonitoringZone::getPlanes() const
+{
+  return m_planes;
+}
+
+void MonitoringZone::addPlane(double nx, double ny, double nz, double offset)
+{
+  const Plane plane = {nx, ny, nz, offset};
+  m_planes.push_back(plane);
+}
+
+ZoneMonitor::ZoneMonitor() : m_width(0u), m_height(0u), m_origin()
+{
+}
+
+bool ZoneMonitor::setCamera(const CameraParameters& camera, DepthType depthType, double depthUnit)
+{
+  if ((camera.width <= 0) || (camera.height <= 0) || !(std::fabs(camera.fx) > 0.) || !(std::fabs(camera.fy) > 0.)
+      || !(depthUnit > 0.))
+  {
+    return false;
+  }
+  m_width  = static_cast<std::size_t>(camera.width);
+  m_height = static_cast<std::size_t>(camera.height);
+
+  // camera to world: rotation in the upper left 3x3 block, translation in mm in the last column
+  const double* m = camera.cam2worldMatrix;
+
+  // the rays of generatePointCloud() start at the focal point, for radial distances moved back by the focal to ray
+  // cross distance (mm)
+  const double originZ = (depthType == DepthType::RADIAL) ? -camera.f2rc / 1000. : 0.;
+  m_origin[0]          = m[2] * originZ + m[3] / 1000.;
+  m_origin[1]          = m[6] * originZ + m[7] / 1000.;
+  m_origin[2]          = m[10] * originZ + m[11] / 1000.;
+
+  m_rays.resize(3u * m_width * m_height);
+  float* pRay = m_rays.data();
+  for (std::size_t row = 0u; row < m_height; ++row)
+  {
+    const double yp = (camera.cy - static_cast<double>(row)) / camera.fy;
+    for (std::size_t col = 0u; col < m_width; ++col)
+    {
+      const double xp = (camera.cx - static_cast<double>(col)) / camera.fx;
+
+      // lens distortion
+      const double r2 = xp * xp + yp * yp;
+      const double k  = 1. + camera.k1 * r2 + camera.k2 * r2 * r2;
+      double       x  = xp * k;
+      double       y  = yp * k;
+      double       z  = 1.;
+      if (depthType == DepthType::RADIAL)
+      {
+        const double length = std::sqrt(x * x + y * y + 1.);
+        x /= length;
+        y /= length;
+        z /= length;
+      }
+      x *= depthUnit;
+      y *= depthUnit;
+      z *= depthUnit;
+
+      *pRay++ = static_cast<float>(m[0] * x + m[1] * y + m[2] * z);
+      *pRay++ = static_cast<float>(m[4] * x + m[5] * y + m[6] * z);
+      *pRay++ = static_cast<float>(m[8] * x + m[9] * y + m[10] * z);
+    }
+  }
+
+  for (ZoneRanges& ranges : m_zones)
+  {
+    computeRanges(ranges);
+  }
+  return true;
+}
+
+bool ZoneMonitor::setCamera(const VisionaryTMiniData& data)
+{
+  return setCamera(data.getCameraParameters(), DepthType::RADIAL, 0.25 / 1000.);
+}
+
+bool ZoneMonitor::setCamera(const VisionarySData& data)
+{
+  return setCamera(data.getCameraParameters(), DepthType::PLANAR, 1. / 1000.);
+}
+
+bool ZoneMonitor::addZone(const MonitoringZone& zone)
+{
+  if (zone.empty() || (m_zones.size() >= kMaxZones) || m_rays.empty())
+  {
+    return false;
+  }
+  m_zones.push_back(ZoneRanges());
+  m_zones.back().zone = zone;
+  computeRanges(m_zones.back());
+  return true;
+}
+
+void ZoneMonitor::clearZones()
+{
+  m_zones.clear();
+}
+
+std::size_t ZoneMonitor::getZoneCount() const
+{
+  return m_zones.size();
+}
+
+MapRoi ZoneMonitor::getZoneRoi(std::size_t zone) const
+{
+  return m_zones.at(zone).roi;
+}
+
+void ZoneMonitor::computeRanges(ZoneRanges& ranges) const
+{
+  const std::vector<MonitoringZone::Plane>& planes    = ranges.zone.getPlanes();
+  const std::size_t                         numPixels = m_width * m_height;
+
+  // distances of the ray origin to the planes, positive inside
+  std::vector<double> originDistances;
+  for (const MonitoringZone::Plane& plane : planes)
+  {
+    originDistances.push_back(plane.offset
+                              - (plane.nx * m_origin[0] + plane.ny * m_origin[1] + plane.nz * m_origin[2]));
+  }
+
+  // ranges of all pixels first, then only the bounding rectangle of the pixels with a non-empty range is kept
+  std::vector<std::uint16_t> nearValues(numPixels);
+  std::vector<std::uint16_t> farValues(numPixels);
+  std::size_t                minCol = m_width;
+  std::size_t                maxCol = 0u;
+  std::size_t                minRow = m_height;
+  std::size_t                maxRow = 0u;
+
+  const float* pRay = m_rays.data();
+  for (std::size_t i = 0u; i < numPixels; ++i, pRay += 3)
+  {
+    // a point of the ray is origin + value * ray; every plane limits value from one side. Value 0 marks an invalid
+    // pixel, so the range starts at 1.
+    double nearValue = 1.;
+    double farValue  = kMaxValue;
+    for (std::size_t j = 0u; j < planes.size(); ++j)
+    {
+      const MonitoringZone::Plane& plane    = planes[j];
+      const double                 slope    = plane.nx * pRay[0] + plane.ny * pRay[1] + plane.nz * pRay[2];
+      const double                 distance = originDistances[j];
+      if (std::fabs(slope) < kParallelEpsilon)
+      {
+        if (distance < 0.)
+        {
+          farValue = 0.; // parallel and outside
+        }
+      }
+      else if (slope > 0.)
+      {
+        farValue = std::min(farValue, distance / slope);
+      }
+      else
+      {
+        nearValue = std::max(nearValue, distance / slope);
+      }
+    }
+    nearValue = std::ceil(nearValue);
+    farValue  = std::floor(farValue);
+
+    if (nearValue <= farValue)
+    {
+      nearValues[i] = static_cast<std::uint16_t>(nearValue);
+      farValues[i]  = static_cast<std::uint16_t>(farValue);
+
+      const std::size_t row = i / m_width;
+      const std::size_t col = i % m_width;
+      minCol                = std::min(minCol, col);
+      maxCol                = std::max(maxCol, col);
+      minRow                = std::min(minRow, row);
+      maxRow                = std::max(maxRow, row);
+    }
+    else
+    {
+      // no value fulfills near <= value <= far
+      nearValues[i] = std::numeric_limits<std::uint16_t>::max();
+      farValues[i]  = 0u;
+    }
+  }
+
+  ranges.nearValues.clear();
+  ranges.farValues.clear();
+  if (minCol > maxCol)
+  {
+    ranges.roi = MapRoi();
+    return;
+  }
+  ranges.roi.x      = minCol;
+  ranges.roi.y      = minRow;
+  ranges.roi.width  = maxCol - minCol + 1u;
+  ranges.roi.height = maxRow - minRow + 1u;
+  ranges.nearValues.reserve(ranges.roi.width * ranges.roi.height);
+  ranges.farValues.reserve(ranges.roi.width * ranges.roi.height);
+  for (std::size_t row = minRow; row <= maxRow; ++row)
+  {
+    const std::ptrdiff_t begin = static_cast<std::ptrdiff_t>(row * m_width + minCol);
+    const std::ptrdiff_t end   = begin + static_cast<std::ptrdiff_t>(ranges.roi.width);
+    ranges.nearValues.insert(ranges.nearValues.end(), nearValues.begin() + begin, nearValues.begin() + end);
+    ranges.farValues.insert(ranges.farValues.end(), farValues.begin() + begin, farValues.begin() + end);
+  }
+}
+
+bool ZoneMonitor::evaluate(const MapView<std::uint16_t>& depth, std::vector<std::uint32_t>& occupiedCounts) const
+{
+  if ((depth.width != m_width) || (depth.height != m_height) || depth.empty())
+  {
+    return false;
+  }
+
+  occupiedCounts.assign(m_zones.size(), 0u);
+  for (std::size_t zone = 0u; zone < m_zones.size(); ++zone)
+  {
+    const ZoneRanges& ranges = m_zones[zone];
+    std::uint32_t     count  = 0u;
+    for (std::size_t y = 0u; y < ranges.roi.height; ++y)
+    {
+      const std::uint16_t* pDepth = depth.row(ranges.roi.y + y) + ranges.roi.x;
+      const std::uint16_t* pNear  = &ranges.nearValues[y * ranges.roi.width];
+      const std::uint16_t* pFar   = &ranges.farValues[y * ranges.roi.width];
+      // no branches, so the compiler vectorizes the comparisons
+      std::uint32_t rowCount = 0u;
+      for (std::size_t x = 0u; x < ranges.roi.width; ++x)
+      {
+        const std::uint16_t value = pDepth[x];
+        rowCount += static_cast<std::uint32_t>(value >= pNear[x]) & static_cast<std::uint32_t>(value <= pFar[x]);
+      }
+      count += rowCount;
+    }
+    occupiedCounts[zone] = count;
+  }
+  return true;
+}
+
+} // namespace visionary
@@ -0,0 +1,145 @@
+//
+// Copyright (c) 2023 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "MapView.h"
+#include "PointXYZ.h"
+#include "VisionaryData.h"
+#include "VisionarySData.h"
+#include "VisionaryTMiniData.h"
+
+namespace visionary {
+
+/// Convex 3D region in world coordinates (m, the coordinates of transformPointCloud())
+///
+/// Non-convex regions can be monitored as several zones.
+class MonitoringZone
+{
+public:
+  /// Half-space n * p <= offset
+  struct Plane
+  {
+    double nx;
+    double ny;
+    double nz;
+    double offset;
+  };
+
+  /// Empty zone, rejected by ZoneMonitor::addZone()
+  MonitoringZone();
+
+  /// Axis-aligned box
+  static MonitoringZone box(const PointXYZ& minCorner, const PointXYZ& maxCorner);
+
+  /// Prism over a convex polygon in the x-y plane, e.g. an area on the floor up to a height
+  ///
+  /// \param[in] polygon corners in either order; z is ignored
+  /// \param[in] zMin    lower bound
+  /// \param[in] zMax    upper bound
+  ///
+  /// \return the zone; empty if the polygon has less than three corners or is not convex
+  static MonitoringZone prism(const std::vector<PointXYZ>& polygon, float zMin, float zMax);
+
+  bool empty() const;
+
+  const std::vector<Plane>& getPlanes() const;
+
+private:
+  void addPlane(double nx, double ny, double nz, double offset);
+
+  std::vector<Plane> m_planes;
+};
+
+/// Counts the pixels of a frame inside each of up to 64 zones, without generating a point cloud
+///
+/// setCamera() computes the ray of every pixel from the calibration of the device, addZone() the range of map
+/// values for which the ray runs inside the zone. Both only have to be repeated when the calibration or the zones
+/// change. Evaluating a frame then only compares the depth map with these ranges: a pixel is occupied if its
+/// value lies within the range of the zone. The ranges are kept for the pixels whose rays pass the zone only
+/// (its bounding rectangle in the image), so small zones cost little memory and time.
+///
+/// Example:
+/// \code
+/// ZoneMonitor monitor;
+/// monitor.setCamera(*pDataHandler); // after the first frame was received
+/// monitor.addZone(MonitoringZone::box({-0.5f, -0.5f, 0.f}, {0.5f, 0.5f, 1.5f}));
+/// std::vector<std::uint32_t> occupiedCounts;
+/// monitor.evaluate(getDistanceView(*pDataHandler), occupiedCounts);
+/// \endcode
+class ZoneMonitor
+{
+public:
+  static const std::size_t kMaxZones = 64u;
+
+  /// What the values of the depth map measure
+  enum class DepthType
+  {
+    RADIAL, ///< distance along the ray from the camera (Visionary-T Mini distance map)
+    PLANAR  ///< distance along the optical axis (Visionary-S Z map)
+  };
+
+  ZoneMonitor();
+
+  /// Sets the calibration, with the same camera model as generatePointCloud() and transformPointCloud()
+  ///
+  /// The ranges of zones already added are recomputed.
+  ///
+  /// \param[in] camera    calibration of the device, e.g. from VisionaryData::getCameraParameters()
+  /// \param[in] depthType meaning of the depth map values
+  /// \param[in] depthUnit length of one depth map unit in m
+  ///
+  /// \retval false the calibration has no valid image size or focal length
+  bool setCamera(const CameraParameters& camera, DepthType depthType, double depthUnit);
+
+  /// Calibration of the distance map (0.25 mm units) of a Visionary-T Mini frame
+  bool setCamera(const VisionaryTMiniData& data);
+
+  /// Calibration of the Z map (mm) of a Visionary-S frame
+  bool setCamera(const VisionarySData& data);
+
+  /// Adds a zone; its index is the number of zones before the call
+  ///
+  /// \retval false the zone is empty, kMaxZones zones were already added or no camera was set
+  bool addZone(const MonitoringZone& zone);
+
+  void clearZones();
+
+  std::size_t getZoneCount() const;
+
+  /// Pixels whose rays pass the zone; empty if the zone is not visible
+  MapRoi getZoneRoi(std::size_t zone) const;
+
+  /// Counts the occupied pixels of every zone
+  ///
+  /// \param[in]  depth          depth map of the frame, e.g. getDistanceView(data)
+  /// \param[out] occupiedCounts occupied pixels, one entry per zone
+  ///
+  /// \retval false the map doesn't have the image size of the calibration
+  bool evaluate(const MapView<std::uint16_t>& depth, std::vector<std::uint32_t>& occupiedCounts) const;
+
+private:
+  struct ZoneRanges
+  {
+    MonitoringZone             zone;
+    MapRoi                     roi;
+    std::vector<std::uint16_t> nearValues; // per pixel of roi: first map value inside the zone
+    std::vector<std::uint16_t> farValues;  // per pixel of roi: last map value inside the zone
+  };
+
+  void computeRanges(ZoneRanges& ranges) const;
+
+  std::size_t             m_width;
+  std::size_t             m_height;
+  double                  m_origin[3]; // start of all rays in world coordinates
+  std::vector<float>      m_rays;      // per pixel: x, y, z in world coordinates of one depth map unit along the ray
+  std::vector<ZoneRanges> m_zones;
+};
+
+} // namespace visionary